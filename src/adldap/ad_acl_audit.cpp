@@ -0,0 +1,351 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ad_acl_audit.h"
+
+#include "adldap.h"
+
+#include "samba/dom_sid.h"
+#include "samba/ndr_security.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+// Amount of objects parsed by one worker task
+#define AUDIT_BATCH_SIZE 200
+
+// Max amount of batches waiting for workers for each
+// worker thread. When workers fall behind, reading of
+// search results pauses, so that memory use stays
+// bounded.
+#define AUDIT_BATCHES_PER_THREAD 2
+
+// Max time in msecs that search waits for results
+// before checking whether audit was stopped
+#define STOP_POLL_INTERVAL 100
+
+class AdAclAuditPrivate {
+public:
+    AdAclAuditPrivate(AdInterface &ad_arg);
+
+    AdInterface &ad;
+    QString base;
+    QByteArray trustee;
+    uint32_t access_mask;
+    QByteArray object_type;
+    AdConfig *adconfig;
+
+    QAtomicInt stop_flag;
+    QAtomicInt checked_count;
+
+    // NOTE: workers put results here and run() passes
+    // them to callback from its own thread
+    QMutex result_mutex;
+    QList<AdAclAuditResult> result_list;
+
+    bool process_results(const std::function<bool(const AdAclAuditResult &result)> &callback);
+};
+
+class AdAclAuditTask final : public QRunnable {
+public:
+    AdAclAuditTask(AdAclAuditPrivate *d_arg, const QList<AdObject> &object_list_arg, const QList<QByteArray> &sid_list_arg, QSemaphore *semaphore_arg);
+
+    void run() override;
+
+private:
+    AdAclAuditPrivate *d;
+    QList<AdObject> object_list;
+    QList<QByteArray> sid_list;
+    QSemaphore *semaphore;
+};
+
+AdAclAudit::AdAclAudit(AdInterface &ad, const QString &base, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type) {
+    d = new AdAclAuditPrivate(ad);
+
+    d->base = base;
+    d->trustee = trustee;
+    d->access_mask = access_mask;
+    d->object_type = object_type;
+    d->adconfig = ad.adconfig();
+}
+
+AdAclAudit::~AdAclAudit() {
+    delete d;
+}
+
+QList<QByteArray> AdAclAudit::get_trustee_sid_list(AdInterface &ad, const QByteArray &trustee) {
+    // NOTE: convert SID's to the same format as SID's in
+    // security descriptors, SID's from attributes are
+    // shorter
+    auto normalize_sid = [](const QByteArray &sid) {
+        return sid_string_to_bytes(object_sid_display_value(sid));
+    };
+
+    QList<QByteArray> out;
+    out.append(normalize_sid(trustee));
+
+    // NOTE: tokenGroups is constructed by the server and
+    // contains all groups that object is a member of,
+    // including nested groups and primary group. It can
+    // only be read by a search with object scope.
+    const QString trustee_dn = AdSidResolver::get_dn(ad, trustee);
+    if (!trustee_dn.isEmpty()) {
+        const AdObject trustee_object = ad.search_object(trustee_dn, {ATTRIBUTE_TOKEN_GROUPS});
+        const QList<QByteArray> group_list = trustee_object.get_values(ATTRIBUTE_TOKEN_GROUPS);
+
+        for (const QByteArray &group_sid : group_list) {
+            out.append(normalize_sid(group_sid));
+        }
+    }
+
+    const QList<QString> everyone_sid_list = {
+        SID_WORLD,
+        SID_NT_AUTHENTICATED_USERS,
+    };
+
+    for (const QString &well_known_sid : everyone_sid_list) {
+        const QByteArray sid = sid_string_to_bytes(well_known_sid);
+
+        if (!out.contains(sid)) {
+            out.append(sid);
+        }
+    }
+
+    return out;
+}
+
+bool AdAclAudit::run(const std::function<bool(const AdAclAuditResult &result)> &callback) {
+    const QList<QByteArray> sid_list = get_trustee_sid_list(d->ad, d->trustee);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+
+    QSemaphore semaphore(pool.maxThreadCount() * AUDIT_BATCHES_PER_THREAD);
+
+    // NOTE: objectClass is needed to check ACE's scoped
+    // to a class
+    const QList<QString> attributes = {ATTRIBUTE_SECURITY_DESCRIPTOR, ATTRIBUTE_OBJECT_CLASS};
+    AdSearch search(d->ad, d->base, SearchScope_All, QString(), attributes);
+
+    bool search_success = true;
+    QList<AdObject> batch;
+
+    auto start_batch = [&]() {
+        if (batch.isEmpty()) {
+            return;
+        }
+
+        // NOTE: wait for a free slot, passing results to
+        // callback while waiting
+        while (!semaphore.tryAcquire(1, STOP_POLL_INTERVAL)) {
+            d->process_results(callback);
+        }
+
+        pool.start(new AdAclAuditTask(d, batch, sid_list, &semaphore));
+
+        batch.clear();
+    };
+
+    while (!d->stop_flag.loadAcquire()) {
+        AdObject object;
+        const AdSearchStatus status = search.next(&object, STOP_POLL_INTERVAL);
+
+        if (status == AdSearchStatus_Entry) {
+            batch.append(object);
+
+            if (batch.size() >= AUDIT_BATCH_SIZE) {
+                start_batch();
+            }
+        } else if (status == AdSearchStatus_PageDone) {
+            start_batch();
+        } else if (status == AdSearchStatus_Timeout) {
+            // Nothing to do, check stop flag
+        } else {
+            start_batch();
+
+            search_success = (status == AdSearchStatus_Finished);
+
+            break;
+        }
+
+        const bool callback_stopped = !d->process_results(callback);
+        if (callback_stopped) {
+            stop();
+        }
+    }
+
+    pool.waitForDone();
+
+    if (!d->stop_flag.loadAcquire()) {
+        d->process_results(callback);
+    }
+
+    return search_success;
+}
+
+void AdAclAudit::stop() {
+    d->stop_flag.storeRelease(1);
+}
+
+int AdAclAudit::checked_count() const {
+    return d->checked_count.loadAcquire();
+}
+
+AdAclAuditPrivate::AdAclAuditPrivate(AdInterface &ad_arg)
+: ad(ad_arg) {
+    access_mask = 0;
+    stop_flag = 0;
+    checked_count = 0;
+}
+
+// Passes available results to callback. Returns false if
+// callback asked to stop.
+bool AdAclAuditPrivate::process_results(const std::function<bool(const AdAclAuditResult &result)> &callback) {
+    const QList<AdAclAuditResult> ready_list = [&]() {
+        QMutexLocker locker(&result_mutex);
+
+        const QList<AdAclAuditResult> out = result_list;
+        result_list.clear();
+
+        return out;
+    }();
+
+    for (const AdAclAuditResult &result : ready_list) {
+        const bool should_continue = callback(result);
+
+        if (!should_continue) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+AdAclAuditTask::AdAclAuditTask(AdAclAuditPrivate *d_arg, const QList<AdObject> &object_list_arg, const QList<QByteArray> &sid_list_arg, QSemaphore *semaphore_arg) {
+    d = d_arg;
+    object_list = object_list_arg;
+    sid_list = sid_list_arg;
+    semaphore = semaphore_arg;
+}
+
+void AdAclAuditTask::run() {
+    QList<AdAclAuditResult> found_list;
+
+    for (const AdObject &object : object_list) {
+        if (d->stop_flag.loadAcquire()) {
+            break;
+        }
+
+        d->checked_count.fetchAndAddRelaxed(1);
+
+        // NOTE: descriptor is missing if user isn't
+        // allowed to read it
+        if (!object.contains(ATTRIBUTE_SECURITY_DESCRIPTOR)) {
+            continue;
+        }
+
+        TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+
+        security_descriptor *sd = object.get_security_descriptor(tmp_ctx);
+        if (sd == nullptr || sd->dacl == nullptr) {
+            talloc_free(tmp_ctx);
+
+            continue;
+        }
+
+        const QList<QByteArray> class_guid_list = [&]() {
+            QList<QByteArray> out;
+
+            if (d->adconfig == nullptr) {
+                return out;
+            }
+
+            const QList<QString> object_class_list = object.get_strings(ATTRIBUTE_OBJECT_CLASS);
+            for (const QString &object_class : object_class_list) {
+                out.append(d->adconfig->class_to_guid(object_class));
+            }
+
+            return out;
+        }();
+
+        const SecurityRightMatrix matrix = SecurityRightMatrix(sd, class_guid_list);
+
+        talloc_free(tmp_ctx);
+
+        bool allow_object = false;
+        bool allow_inherited = false;
+        bool deny_object = false;
+        bool deny_inherited = false;
+        QList<QByteArray> allowed_trustee_list;
+
+        for (const QByteArray &sid : sid_list) {
+            const SecurityRightState state = matrix.get(sid, d->access_mask, d->object_type);
+
+            const bool sid_allow_object = state.get(SecurityRightStateInherited_No, SecurityRightStateType_Allow);
+            const bool sid_allow_inherited = state.get(SecurityRightStateInherited_Yes, SecurityRightStateType_Allow);
+
+            allow_object = (allow_object || sid_allow_object);
+            allow_inherited = (allow_inherited || sid_allow_inherited);
+            deny_object = (deny_object || state.get(SecurityRightStateInherited_No, SecurityRightStateType_Deny));
+            deny_inherited = (deny_inherited || state.get(SecurityRightStateInherited_Yes, SecurityRightStateType_Deny));
+
+            if (sid_allow_object || sid_allow_inherited) {
+                allowed_trustee_list.append(sid);
+            }
+        }
+
+        // NOTE: in canonical order, object ACE's come
+        // before inherited ones and deny ACE's come before
+        // allow ACE's, so first matching ACE in that
+        // order decides
+        const bool allowed = [&]() {
+            if (deny_object) {
+                return false;
+            } else if (allow_object) {
+                return true;
+            } else if (deny_inherited) {
+                return false;
+            } else {
+                return allow_inherited;
+            }
+        }();
+
+        if (allowed) {
+            AdAclAuditResult result;
+            result.dn = object.get_dn();
+            result.inherited = !allow_object;
+            result.trustee_list = allowed_trustee_list;
+
+            found_list.append(result);
+        }
+    }
+
+    if (!found_list.isEmpty()) {
+        QMutexLocker locker(&d->result_mutex);
+        d->result_list.append(found_list);
+    }
+
+    semaphore->release();
+}
@@ -0,0 +1,92 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AD_ACL_AUDIT_H
+#define AD_ACL_AUDIT_H
+
+/**
+ * Finds all objects in a subtree where a trustee has a
+ * right. Rights given to groups that trustee is a member
+ * of, directly or through other groups, are included, as
+ * well as rights given to "Everyone" and "Authenticated
+ * Users".
+ *
+ * Security descriptors are received with a paged search
+ * and parsed by worker threads while next entries are
+ * still arriving, so memory use doesn't depend on the
+ * size of the subtree.
+ *
+ * Same as AdSearch, must not outlive the AdInterface it
+ * was created with.
+ */
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+#include <functional>
+
+class AdInterface;
+class AdAclAuditPrivate;
+
+class AdAclAuditResult {
+public:
+    QString dn;
+
+    // True if right is given only by inherited ACE's
+    bool inherited;
+
+    // SID's of the trustee or its groups which are
+    // allowed this right by the object's DACL
+    QList<QByteArray> trustee_list;
+};
+
+class AdAclAudit {
+
+public:
+    AdAclAudit(AdInterface &ad, const QString &base, const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type);
+    ~AdAclAudit();
+
+    // Returns SID's of trustee and all groups it's a
+    // member of, including nested groups. If groups can't
+    // be loaded, returns only the trustee.
+    static QList<QByteArray> get_trustee_sid_list(AdInterface &ad, const QByteArray &trustee);
+
+    // Runs the audit, calling given function for each
+    // object where right is allowed. Objects where right
+    // is also denied are skipped. Function is called from
+    // the thread that called run(), return false from it
+    // to stop the audit early. Returns false if search
+    // failed.
+    bool run(const std::function<bool(const AdAclAuditResult &result)> &callback);
+
+    // Stops audit that is running. Can be called from any
+    // thread.
+    void stop();
+
+    // Amount of objects checked so far. Can be called
+    // from any thread to display progress.
+    int checked_count() const;
+
+private:
+    AdAclAuditPrivate *d;
+};
+
+#endif /* AD_ACL_AUDIT_H */
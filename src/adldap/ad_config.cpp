@@ -24,6 +24,7 @@
 #include "ad_filter.h"
 #include "ad_interface.h"
 #include "ad_object.h"
+#include "ad_object_p.h"
 #include "ad_security.h"
 #include "ad_utils.h"
 #include "ad_display.h"
@@ -31,8 +32,16 @@
 #include "samba/ndr_security.h"
 
 #include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
 #include <QLocale>
+#include <QSaveFile>
+#include <QSet>
 #include <algorithm>
 
 #define ATTRIBUTE_ATTRIBUTE_DISPLAY_NAMES "attributeDisplayNames"
@@ -56,6 +65,8 @@
 #define ATTRIBUTE_LINK_ID "linkID"
 #define ATTRIBUTE_SYSTEM_AUXILIARY_CLASS "systemAuxiliaryClass"
 #define ATTRIBUTE_SUB_CLASS_OF "subClassOf"
+#define ATTRIBUTE_LDAP_ADMIN_LIMITS "lDAPAdminLimits"
+#define ATTRIBUTE_MODIFY_TIMESTAMP "modifyTimeStamp"
 
 #define CLASS_ATTRIBUTE_SCHEMA "attributeSchema"
 #define CLASS_CLASS_SCHEMA "classSchema"
@@ -63,7 +74,37 @@
 
 #define FLAG_ATTR_IS_CONSTRUCTED 0x00000004
 
+// NOTE: this is the value that AD uses if query policy
+// doesn't define MaxPageSize
+#define DEFAULT_MAX_PAGE_SIZE 1000
+
+// NOTE: increment format version when contents of the
+// cache change
+#define CACHE_MAGIC 0x41444d43
+#define CACHE_FORMAT_VERSION 1
+#define CACHE_MAX_AGE_DAYS 7
+
+QString AdConfigPrivate::s_cache_dir = QString();
+
+bool search_list(AdInterface &ad, const QString &base, const QString &filter, const QList<QString> &attributes, QList<AdObject> *out);
+QDataStream &operator<<(QDataStream &stream, const AdObject &object);
+QDataStream &operator>>(QDataStream &stream, AdObject &object);
+AttributeType get_attribute_type_from_schema(const AdObject &schema);
+LargeIntegerSubtype get_large_integer_subtype_from_name(const QString &attribute);
+
+AdAttributeDescriptor::AdAttributeDescriptor() {
+    is_valid = false;
+    type = AttributeType_StringCase;
+    large_integer_subtype = LargeIntegerSubtype_Integer;
+    is_single_valued = false;
+    is_system_only = false;
+    range_upper = 0;
+    is_backlink = false;
+    is_constructed = false;
+}
+
 AdConfigPrivate::AdConfigPrivate() {
+    max_page_size = DEFAULT_MAX_PAGE_SIZE;
 }
 
 AdConfig::AdConfig() {
@@ -74,18 +115,13 @@ AdConfig::~AdConfig() {
     delete d;
 }
 
+void AdConfig::set_cache_dir(const QString &dir) {
+    AdConfigPrivate::s_cache_dir = dir;
+}
+
 void AdConfig::load(AdInterface &ad, const QLocale &locale) {
     d->domain = ad.get_domain();
 
-    d->filter_containers.clear();
-    d->columns.clear();
-    d->column_display_names.clear();
-    d->class_display_names.clear();
-    d->find_attributes.clear();
-    d->attribute_display_names.clear();
-    d->attribute_schemas.clear();
-    d->class_schemas.clear();
-
     const AdObject rootDSE_object = ad.search_object(ROOT_DSE);
     d->domain_dn = rootDSE_object.get_string(ATTRIBUTE_ROOT_DOMAIN_NAMING_CONTEXT);
     d->schema_dn = rootDSE_object.get_string(ATTRIBUTE_SCHEMA_NAMING_CONTEXT);
@@ -95,143 +131,442 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
     const AdObject domain_object = ad.search_object(domain_dn());
     d->domain_sid = object_sid_display_value(domain_object.get_value(ATTRIBUTE_OBJECT_SID));
 
-    const QString locale_dir = [this, locale]() {
-        const QString locale_code = [locale]() {
-            if (locale.language() == QLocale::Russian) {
-                return "419";
-            } else {
-                // English
-                return "409";
+    // NOTE: lDAPAdminLimits values are in the form of
+    // "$limit_name=$value"
+    d->max_page_size = [&]() {
+        const QString query_policy_dn = QString("CN=Default Query Policy,CN=Query-Policies,CN=Directory Service,CN=Windows NT,CN=Services,%1").arg(configuration_dn());
+        const AdObject query_policy_object = ad.search_object(query_policy_dn, {ATTRIBUTE_LDAP_ADMIN_LIMITS});
+        const QList<QString> limit_list = query_policy_object.get_strings(ATTRIBUTE_LDAP_ADMIN_LIMITS);
+
+        for (const QString &limit : limit_list) {
+            const QList<QString> split = limit.split('=');
+
+            if (split.size() != 2 || split[0].compare("MaxPageSize", Qt::CaseInsensitive) != 0) {
+                continue;
             }
-        }();
 
-        return QString("CN=%1,CN=DisplaySpecifiers,%2").arg(locale_code, configuration_dn());
+            bool ok;
+            const int value = split[1].toInt(&ok);
+
+            if (ok && value > 0) {
+                return value;
+            }
+        }
+
+        return DEFAULT_MAX_PAGE_SIZE;
     }();
 
-    // Attribute schemas
-    {
-        const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_ATTRIBUTE_SCHEMA);
-
-        const QList<QString> attributes = {
-            ATTRIBUTE_LDAP_DISPLAY_NAME,
-            ATTRIBUTE_ATTRIBUTE_SYNTAX,
-            ATTRIBUTE_OM_SYNTAX,
-            ATTRIBUTE_IS_SINGLE_VALUED,
-            ATTRIBUTE_SYSTEM_ONLY,
-            ATTRIBUTE_RANGE_UPPER,
-            ATTRIBUTE_LINK_ID,
-            ATTRIBUTE_SYSTEM_FLAGS,
-            ATTRIBUTE_SCHEMA_ID_GUID,
-        };
+    const QString locale_code = [locale]() {
+        if (locale.language() == QLocale::Russian) {
+            return "419";
+        } else {
+            // English
+            return "409";
+        }
+    }();
+
+    const QString locale_dir = QString("CN=%1,CN=DisplaySpecifiers,%2").arg(locale_code, configuration_dn());
 
-        const QHash<QString, AdObject> results = ad.search(schema_dn(), SearchScope_Children, filter, attributes);
+    // NOTE: cached data is valid while schema stays the
+    // same. Schema's objectVersion changes on schema
+    // upgrades and modifyTimeStamp changes when schema is
+    // extended.
+    const QString cache_path = [&]() {
+        if (AdConfigPrivate::s_cache_dir.isEmpty()) {
+            return QString();
+        }
+
+        const QString filename = QString("%1_%2.cache").arg(d->domain.toLower(), locale_code);
+
+        return QDir(AdConfigPrivate::s_cache_dir).filePath(filename);
+    }();
 
-        for (const AdObject &object : results.values()) {
-            const QString attribute = object.get_string(ATTRIBUTE_LDAP_DISPLAY_NAME);
-            d->attribute_schemas[attribute] = object;
+    const QString cache_key = [&]() {
+        const AdObject schema_object = ad.search_object(schema_dn(), {ATTRIBUTE_OBJECT_VERSION, ATTRIBUTE_MODIFY_TIMESTAMP});
 
-            const QByteArray guid = object.get_value(ATTRIBUTE_SCHEMA_ID_GUID);
-            d->guid_to_attribute_map[guid] = attribute;
+        if (schema_object.is_empty()) {
+            return QString();
+        }
+
+        const QString object_version = schema_object.get_string(ATTRIBUTE_OBJECT_VERSION);
+        const QString modify_timestamp = schema_object.get_string(ATTRIBUTE_MODIFY_TIMESTAMP);
+
+        return QString("%1;%2;%3;%4").arg(d->domain.toLower(), locale_dir, object_version, modify_timestamp);
+    }();
+
+    const bool can_use_cache = (!cache_path.isEmpty() && !cache_key.isEmpty());
+
+    AdConfigData data;
+
+    d->load_timing_list.clear();
+
+    auto add_timing = [&](const QString &phase, const qint64 elapsed) {
+        AdConfigLoadTiming timing;
+        timing.phase = phase;
+        timing.elapsed = elapsed;
+
+        d->load_timing_list.append(timing);
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool loaded_cache = (can_use_cache && d->load_cache(cache_path, cache_key, &data));
+
+    if (loaded_cache) {
+        add_timing("cache", timer.elapsed());
+    } else {
+        const bool fetch_success = d->fetch(ad, locale_dir, &data, &d->load_timing_list);
+
+        add_timing("fetch", timer.elapsed());
+
+        if (can_use_cache && fetch_success) {
+            d->save_cache(cache_path, cache_key, data);
         }
     }
 
-    // Class schemas
-    {
-        const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_CLASS_SCHEMA);
-
-        const QList<QString> attributes = {
-            ATTRIBUTE_LDAP_DISPLAY_NAME,
-            ATTRIBUTE_POSSIBLE_SUPERIORS,
-            ATTRIBUTE_SYSTEM_POSSIBLE_SUPERIORS,
-            ATTRIBUTE_MAY_CONTAIN,
-            ATTRIBUTE_SYSTEM_MAY_CONTAIN,
-            ATTRIBUTE_MUST_CONTAIN,
-            ATTRIBUTE_SYSTEM_MUST_CONTAIN,
-            ATTRIBUTE_AUXILIARY_CLASS,
-            ATTRIBUTE_SYSTEM_AUXILIARY_CLASS,
-            ATTRIBUTE_SCHEMA_ID_GUID,
-            ATTRIBUTE_SUB_CLASS_OF,
-        };
+    timer.restart();
+
+    d->process(data);
 
-        const QHash<QString, AdObject> results = ad.search(schema_dn(), SearchScope_Children, filter, attributes);
+    add_timing("process", timer.elapsed());
+}
+
+QList<AdConfigLoadTiming> AdConfig::get_load_timing_list() const {
+    return d->load_timing_list;
+}
 
-        for (const AdObject &object : results.values()) {
-            const QString object_class = object.get_string(ATTRIBUTE_LDAP_DISPLAY_NAME);
-            d->class_schemas[object_class] = object;
+// NOTE: phases are independent, so they are fetched at
+// the same time, each on it's own connection. First
+// phase uses caller's connection. Total time is then
+// bounded by the slowest phase instead of the sum of
+// all phases.
+bool AdConfigPrivate::fetch(AdInterface &ad, const QString &locale_dir, AdConfigData *data, QList<AdConfigLoadTiming> *timing_list) const {
+    const QList<AdConfigFetchPhase> phase_list = get_fetch_phase_list(locale_dir, data);
 
-            const QByteArray guid = object.get_value(ATTRIBUTE_SCHEMA_ID_GUID);
-            d->guid_to_class_map[guid] = object_class;
+    QList<AdConfigFetchThread *> thread_list;
+    for (int i = 1; i < phase_list.size(); i++) {
+        AdConfigFetchThread *thread = new AdConfigFetchThread(phase_list[i].function);
+        thread->start();
 
-            const QString sub_class_of = object.get_string(ATTRIBUTE_SUB_CLASS_OF);
-            d->sub_class_of_map[object_class] = sub_class_of;
+        thread_list.append(thread);
+    }
+
+    bool total_success = true;
+
+    auto add_timing = [&](const AdConfigFetchPhase &phase, const qint64 elapsed) {
+        AdConfigLoadTiming timing;
+        timing.phase = phase.name;
+        timing.elapsed = elapsed;
+
+        timing_list->append(timing);
+    };
+
+    auto run_on_caller_connection = [&](const AdConfigFetchPhase &phase) {
+        QElapsedTimer timer;
+        timer.start();
+
+        const bool success = phase.function(ad);
+
+        add_timing(phase, timer.elapsed());
+
+        return success;
+    };
+
+    if (!phase_list.isEmpty()) {
+        const bool success = run_on_caller_connection(phase_list[0]);
+
+        if (!success) {
+            total_success = false;
         }
     }
 
-    // Class display specifiers
-    // NOTE: can't just store objects for these because the values require a decent amount of preprocessing which is best done once here, not everytime value is requested
-    {
-        const QString filter = QString();
+    for (int i = 0; i < thread_list.size(); i++) {
+        AdConfigFetchThread *thread = thread_list[i];
+        const AdConfigFetchPhase &phase = phase_list[i + 1];
 
-        const QList<QString> search_attributes = {
-            ATTRIBUTE_CLASS_DISPLAY_NAME,
-            ATTRIBUTE_ATTRIBUTE_DISPLAY_NAMES,
-        };
+        thread->wait();
+
+        // NOTE: if thread failed to open it's own
+        // connection, fall back to caller's connection
+        const bool success = [&]() {
+            if (thread->connected) {
+                add_timing(phase, thread->elapsed);
 
-        const QHash<QString, AdObject> results = ad.search(locale_dir, SearchScope_Children, filter, search_attributes);
+                return thread->success;
+            } else {
+                return run_on_caller_connection(phase);
+            }
+        }();
 
-        for (const AdObject &object : results) {
-            const QString dn = object.get_dn();
+        if (!success) {
+            total_success = false;
+        }
+    }
 
-            // Display specifier DN is "CN=object-class-Display,CN=..."
-            // Get "object-class" from that
-            const QString object_class = [dn]() {
-                const QString rdn = dn.split(",")[0];
-                QString out = rdn;
-                out.remove("CN=", Qt::CaseInsensitive);
-                out.remove("-Display");
+    qDeleteAll(thread_list);
 
-                return out;
-            }();
+    return total_success;
+}
+
+QList<AdConfigFetchPhase> AdConfigPrivate::get_fetch_phase_list(const QString &locale_dir, AdConfigData *data) const {
+    const QString schema_dn_copy = schema_dn;
+    const QString extended_rights_dn = QString("CN=Extended-Rights,%1").arg(configuration_dn);
+
+    const AdConfigFetchPhase attribute_schemas_phase = {
+        "attribute schemas",
+        [=](AdInterface &ad) {
+            const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_ATTRIBUTE_SCHEMA);
+
+            const QList<QString> attributes = {
+                ATTRIBUTE_LDAP_DISPLAY_NAME,
+                ATTRIBUTE_ATTRIBUTE_SYNTAX,
+                ATTRIBUTE_OM_SYNTAX,
+                ATTRIBUTE_IS_SINGLE_VALUED,
+                ATTRIBUTE_SYSTEM_ONLY,
+                ATTRIBUTE_RANGE_UPPER,
+                ATTRIBUTE_LINK_ID,
+                ATTRIBUTE_SYSTEM_FLAGS,
+                ATTRIBUTE_SCHEMA_ID_GUID,
+            };
+
+            return search_list(ad, schema_dn_copy, filter, attributes, &data->attribute_schema_list);
+        },
+    };
+
+    const AdConfigFetchPhase class_schemas_phase = {
+        "class schemas",
+        [=](AdInterface &ad) {
+            const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_CLASS_SCHEMA);
+
+            const QList<QString> attributes = {
+                ATTRIBUTE_LDAP_DISPLAY_NAME,
+                ATTRIBUTE_POSSIBLE_SUPERIORS,
+                ATTRIBUTE_SYSTEM_POSSIBLE_SUPERIORS,
+                ATTRIBUTE_MAY_CONTAIN,
+                ATTRIBUTE_SYSTEM_MAY_CONTAIN,
+                ATTRIBUTE_MUST_CONTAIN,
+                ATTRIBUTE_SYSTEM_MUST_CONTAIN,
+                ATTRIBUTE_AUXILIARY_CLASS,
+                ATTRIBUTE_SYSTEM_AUXILIARY_CLASS,
+                ATTRIBUTE_SCHEMA_ID_GUID,
+                ATTRIBUTE_SUB_CLASS_OF,
+            };
+
+            return search_list(ad, schema_dn_copy, filter, attributes, &data->class_schema_list);
+        },
+    };
+
+    const AdConfigFetchPhase display_specifiers_phase = {
+        "display specifiers",
+        [=](AdInterface &ad) {
+            const QString filter = QString();
+
+            const QList<QString> attributes = {
+                ATTRIBUTE_CLASS_DISPLAY_NAME,
+                ATTRIBUTE_ATTRIBUTE_DISPLAY_NAMES,
+            };
+
+            return search_list(ad, locale_dir, filter, attributes, &data->display_specifier_list);
+        },
+    };
+
+    const AdConfigFetchPhase columns_phase = {
+        "columns",
+        [=](AdInterface &ad) {
+            const QString dn = QString("CN=default-Display,%1").arg(locale_dir);
+            data->default_display_object = ad.search_object(dn, {ATTRIBUTE_EXTRA_COLUMNS});
 
-            if (object.contains(ATTRIBUTE_CLASS_DISPLAY_NAME)) {
-                d->class_display_names[object_class] = object.get_string(ATTRIBUTE_CLASS_DISPLAY_NAME);
+            return !data->default_display_object.is_empty();
+        },
+    };
+
+    const AdConfigFetchPhase filter_containers_phase = {
+        "filter containers",
+        [=](AdInterface &ad) {
+            const QString dn = QString("CN=DS-UI-Default-Settings,%1").arg(locale_dir);
+            data->ui_settings_object = ad.search_object(dn, {ATTRIBUTE_FILTER_CONTAINERS});
+
+            return !data->ui_settings_object.is_empty();
+        },
+    };
+
+    const AdConfigFetchPhase extended_rights_phase = {
+        "extended rights",
+        [=](AdInterface &ad) {
+            const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_CONTROL_ACCESS_RIGHT);
+
+            const QList<QString> attributes = {
+                ATTRIBUTE_CN,
+                ATTRIBUTE_DISPLAY_NAME,
+                ATTRIBUTE_RIGHTS_GUID,
+                ATTRIBUTE_APPLIES_TO,
+                ATTRIBUTE_VALID_ACCESSES,
+            };
+
+            return search_list(ad, extended_rights_dn, filter, attributes, &data->extended_right_list);
+        },
+    };
+
+    // NOTE: each phase writes only to it's own part of
+    // data, so they can run at the same time. Largest
+    // phase goes first, so it runs on caller's connection
+    // which is already open.
+    const QList<AdConfigFetchPhase> out = {
+        attribute_schemas_phase,
+        class_schemas_phase,
+        display_specifiers_phase,
+        columns_phase,
+        filter_containers_phase,
+        extended_rights_phase,
+    };
+
+    return out;
+}
+
+AdConfigFetchThread::AdConfigFetchThread(const std::function<bool(AdInterface &ad)> &function_arg) {
+    function = function_arg;
+    connected = false;
+    success = false;
+    elapsed = 0;
+}
+
+void AdConfigFetchThread::run() {
+    QElapsedTimer timer;
+    timer.start();
+
+    AdInterface ad;
+    connected = ad.is_connected();
+
+    if (connected) {
+        success = function(ad);
+    }
+
+    elapsed = timer.elapsed();
+}
+
+void AdConfigPrivate::process(const AdConfigData &data) {
+    filter_containers.clear();
+    columns.clear();
+    column_display_names.clear();
+    class_display_names.clear();
+    find_attributes.clear();
+    attribute_display_names.clear();
+    attribute_schemas.clear();
+    attribute_descriptor_list.clear();
+    class_schemas.clear();
+    guid_to_attribute_map.clear();
+    guid_to_class_map.clear();
+    sub_class_of_map.clear();
+    right_to_guid_map.clear();
+    right_guid_to_cn_map.clear();
+    rights_guid_to_name_map.clear();
+    rights_name_to_guid_map.clear();
+    rights_applies_to_map.clear();
+    extended_rights_list.clear();
+    rights_valid_accesses_map.clear();
+
+    // Attribute schemas
+    for (const AdObject &object : data.attribute_schema_list) {
+        const QString attribute = object.get_string(ATTRIBUTE_LDAP_DISPLAY_NAME);
+        attribute_schemas[attribute] = object;
+
+        const QByteArray guid = object.get_value(ATTRIBUTE_SCHEMA_ID_GUID);
+        guid_to_attribute_map[guid] = attribute;
+
+        AdAttributeDescriptor descriptor;
+        descriptor.is_valid = true;
+        descriptor.type = get_attribute_type_from_schema(object);
+        descriptor.large_integer_subtype = get_large_integer_subtype_from_name(attribute);
+        descriptor.is_single_valued = object.get_bool(ATTRIBUTE_IS_SINGLE_VALUED);
+        descriptor.is_system_only = object.get_bool(ATTRIBUTE_SYSTEM_ONLY);
+        descriptor.range_upper = object.get_int(ATTRIBUTE_RANGE_UPPER);
+        descriptor.is_backlink = [&]() {
+            if (object.contains(ATTRIBUTE_LINK_ID)) {
+                const int link_id = object.get_int(ATTRIBUTE_LINK_ID);
+                const bool link_id_is_odd = (link_id % 2 != 0);
+
+                return link_id_is_odd;
+            } else {
+                return false;
             }
+        }();
+        descriptor.is_constructed = [&]() {
+            const int system_flags = object.get_int(ATTRIBUTE_SYSTEM_FLAGS);
 
-            if (object.contains(ATTRIBUTE_ATTRIBUTE_DISPLAY_NAMES)) {
-                const QList<QString> display_names = object.get_strings(ATTRIBUTE_ATTRIBUTE_DISPLAY_NAMES);
+            return bitmask_is_set(system_flags, FLAG_ATTR_IS_CONSTRUCTED);
+        }();
 
-                for (const auto &display_name_pair : display_names) {
-                    const QList<QString> split = display_name_pair.split(",");
-                    const QString attribute_name = split[0];
-                    const QString display_name = split[1];
+        const int attribute_id = ad_attribute_id(attribute);
+        if (attribute_id >= attribute_descriptor_list.size()) {
+            attribute_descriptor_list.resize(attribute_id + 1);
+        }
+        attribute_descriptor_list[attribute_id] = descriptor;
+    }
 
-                    d->attribute_display_names[object_class][attribute_name] = display_name;
-                }
+    // Class schemas
+    for (const AdObject &object : data.class_schema_list) {
+        const QString object_class = object.get_string(ATTRIBUTE_LDAP_DISPLAY_NAME);
+        class_schemas[object_class] = object;
 
-                d->find_attributes[object_class] = [object_class, display_names]() {
-                    QList<QString> out;
+        const QByteArray guid = object.get_value(ATTRIBUTE_SCHEMA_ID_GUID);
+        guid_to_class_map[guid] = object_class;
 
-                    for (const auto &display_name_pair : display_names) {
-                        const QList<QString> split = display_name_pair.split(",");
-                        const QString attribute = split[0];
+        const QString sub_class_of = object.get_string(ATTRIBUTE_SUB_CLASS_OF);
+        sub_class_of_map[object_class] = sub_class_of;
+    }
+
+    // Class display specifiers
+    // NOTE: can't just store objects for these because the values require a decent amount of preprocessing which is best done once here, not everytime value is requested
+    for (const AdObject &object : data.display_specifier_list) {
+        const QString dn = object.get_dn();
+
+        // Display specifier DN is "CN=object-class-Display,CN=..."
+        // Get "object-class" from that
+        const QString object_class = [dn]() {
+            const QString rdn = dn.split(",")[0];
+            QString out = rdn;
+            out.remove("CN=", Qt::CaseInsensitive);
+            out.remove("-Display");
+
+            return out;
+        }();
 
-                        out.append(attribute);
-                    }
+        if (object.contains(ATTRIBUTE_CLASS_DISPLAY_NAME)) {
+            class_display_names[object_class] = object.get_string(ATTRIBUTE_CLASS_DISPLAY_NAME);
+        }
+
+        if (object.contains(ATTRIBUTE_ATTRIBUTE_DISPLAY_NAMES)) {
+            const QList<QString> display_names = object.get_strings(ATTRIBUTE_ATTRIBUTE_DISPLAY_NAMES);
+
+            for (const auto &display_name_pair : display_names) {
+                const QList<QString> split = display_name_pair.split(",");
+                const QString attribute_name = split[0];
+                const QString display_name = split[1];
 
-                    return out;
-                }();
+                attribute_display_names[object_class][attribute_name] = display_name;
             }
+
+            find_attributes[object_class] = [object_class, display_names]() {
+                QList<QString> out;
+
+                for (const auto &display_name_pair : display_names) {
+                    const QList<QString> split = display_name_pair.split(",");
+                    const QString attribute = split[0];
+
+                    out.append(attribute);
+                }
+
+                return out;
+            }();
         }
     }
 
     // Columns
     {
+        // NOTE: order as stored in attribute is reversed. Order is not sorted alphabetically so can't just sort.
         const QList<QString> columns_values = [&] {
-            const QString dn = QString("CN=default-Display,%1").arg(locale_dir);
-            const AdObject object = ad.search_object(dn, {ATTRIBUTE_EXTRA_COLUMNS});
-
-            // NOTE: order as stored in attribute is reversed. Order is not sorted alphabetically so can't just sort.
-            QList<QString> extra_columns = object.get_strings(ATTRIBUTE_EXTRA_COLUMNS);
+            QList<QString> extra_columns = data.default_display_object.get_strings(ATTRIBUTE_EXTRA_COLUMNS);
             std::reverse(extra_columns.begin(), extra_columns.end());
 
             return extra_columns;
@@ -250,14 +585,14 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
             const QString attribute = column_split[0];
             const QString attribute_display_name = column_split[1];
 
-            d->columns.append(attribute);
-            d->column_display_names[attribute] = attribute_display_name;
+            columns.append(attribute);
+            column_display_names[attribute] = attribute_display_name;
         }
 
         // Insert some columns manually
         auto add_custom = [=](const Attribute &attribute, const QString &display_name) {
-            d->columns.prepend(attribute);
-            d->column_display_names[attribute] = display_name;
+            columns.prepend(attribute);
+            column_display_names[attribute] = display_name;
         };
 
         add_custom(ATTRIBUTE_DN, QCoreApplication::translate("AdConfig", "Distinguished name"));
@@ -266,17 +601,14 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
         add_custom(ATTRIBUTE_NAME, QCoreApplication::translate("AdConfig", "Name"));
     }
 
-    d->filter_containers = [&] {
+    filter_containers = [&] {
         QList<QString> out;
 
-        const QString ui_settings_dn = QString("CN=DS-UI-Default-Settings,%1").arg(locale_dir);
-        const AdObject object = ad.search_object(ui_settings_dn, {ATTRIBUTE_FILTER_CONTAINERS});
-
         // NOTE: dns-Zone category is mispelled in
         // ATTRIBUTE_FILTER_CONTAINERS, no idea why, might
         // just be on this domain version
-        const QList<QString> categories = [object]() {
-            QList<QString> categories_out = object.get_strings(ATTRIBUTE_FILTER_CONTAINERS);
+        const QList<QString> categories = [&]() {
+            QList<QString> categories_out = data.ui_settings_object.get_strings(ATTRIBUTE_FILTER_CONTAINERS);
             categories_out.replaceInStrings("dns-Zone", "Dns-Zone");
 
             return categories_out;
@@ -284,11 +616,24 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
 
         // NOTE: ATTRIBUTE_FILTER_CONTAINERS contains object
         // *categories* not classes, so need to get object
-        // class from category object
+        // class from category object. Category objects are
+        // class schemas, so they are already loaded.
+        const QHash<QString, QString> category_dn_to_class_map = [&]() {
+            QHash<QString, QString> map_out;
+
+            for (const AdObject &object : data.class_schema_list) {
+                const QString category_dn = object.get_dn().toLower();
+                const QString object_class = object.get_string(ATTRIBUTE_LDAP_DISPLAY_NAME);
+
+                map_out[category_dn] = object_class;
+            }
+
+            return map_out;
+        }();
+
         for (const auto &object_category : categories) {
-            const QString category_dn = QString("CN=%1,%2").arg(object_category, schema_dn());
-            const AdObject category_object = ad.search_object(category_dn, {ATTRIBUTE_LDAP_DISPLAY_NAME});
-            const QString object_class = category_object.get_string(ATTRIBUTE_LDAP_DISPLAY_NAME);
+            const QString category_dn = QString("CN=%1,%2").arg(object_category, schema_dn);
+            const QString object_class = category_dn_to_class_map.value(category_dn.toLower());
 
             out.append(object_class);
         }
@@ -303,49 +648,225 @@ void AdConfig::load(AdInterface &ad, const QLocale &locale) {
     }();
 
     // Extended rights
-    {
-        const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_CONTROL_ACCESS_RIGHT);
-
-        const QList<QString> attributes = {
-            ATTRIBUTE_CN,
-            ATTRIBUTE_DISPLAY_NAME,
-            ATTRIBUTE_RIGHTS_GUID,
-            ATTRIBUTE_APPLIES_TO,
-            ATTRIBUTE_VALID_ACCESSES,
-        };
+    for (const AdObject &object : data.extended_right_list) {
+        const QString cn = object.get_string(ATTRIBUTE_CN);
+        const QString guid_string = object.get_string(ATTRIBUTE_RIGHTS_GUID);
+        const QByteArray guid = guid_string_to_bytes(guid_string);
+        const QByteArray display_name = object.get_value(ATTRIBUTE_DISPLAY_NAME);
+        const QList<QString> applies_to = [this, object]() {
+            QList<QString> out;
+
+            const QList<QString> class_guid_string_list = object.get_strings(ATTRIBUTE_APPLIES_TO);
+            for (const QString &class_guid_string : class_guid_string_list) {
+                const QByteArray class_guid = guid_string_to_bytes(class_guid_string);
+                const QString object_class = guid_to_class_map.value(class_guid, "<unknown class>");
+
+                out.append(object_class);
+            }
 
-        const QString search_base = extended_rights_dn();
+            return out;
+        }();
+        const int valid_accesses = object.get_int(ATTRIBUTE_VALID_ACCESSES);
+
+        right_to_guid_map[cn] = guid;
+        right_guid_to_cn_map[guid] = cn;
+        rights_guid_to_name_map[guid] = display_name;
+        rights_name_to_guid_map[cn] = guid;
+        rights_applies_to_map[guid] = applies_to;
+        extended_rights_list.append(cn);
+        rights_valid_accesses_map[cn] = valid_accesses;
+    }
+}
 
-        const QHash<QString, AdObject> search_results = ad.search(search_base, SearchScope_Children, filter, attributes);
+bool AdConfigPrivate::load_cache(const QString &path, const QString &cache_key, AdConfigData *data) const {
+    QFile file(path);
+    const bool open_success = file.open(QIODevice::ReadOnly);
+    if (!open_success) {
+        return false;
+    }
 
-        for (const AdObject &object : search_results.values()) {
-            const QString cn = object.get_string(ATTRIBUTE_CN);
-            const QString guid_string = object.get_string(ATTRIBUTE_RIGHTS_GUID);
-            const QByteArray guid = guid_string_to_bytes(guid_string);
-            const QByteArray display_name = object.get_value(ATTRIBUTE_DISPLAY_NAME);
-            const QList<QString> applies_to = [this, object]() {
-                QList<QString> out;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
 
-                const QList<QString> class_guid_string_list = object.get_strings(ATTRIBUTE_APPLIES_TO);
-                for (const QString &class_guid_string : class_guid_string_list) {
-                    const QByteArray class_guid = guid_string_to_bytes(class_guid_string);
-                    const QString object_class = guid_to_class(class_guid);
+    quint32 magic;
+    qint32 format_version;
+    QString file_cache_key;
+    QDateTime save_time;
+    stream >> magic >> format_version;
 
-                    out.append(object_class);
-                }
+    if (magic != CACHE_MAGIC || format_version != CACHE_FORMAT_VERSION) {
+        return false;
+    }
 
-                return out;
-            }();
-            const int valid_accesses = object.get_int(ATTRIBUTE_VALID_ACCESSES);
-
-            d->right_to_guid_map[cn] = guid;
-            d->right_guid_to_cn_map[guid] = cn;
-            d->rights_guid_to_name_map[guid] = display_name;
-            d->rights_name_to_guid_map[cn] = guid;
-            d->rights_applies_to_map[guid] = applies_to;
-            d->extended_rights_list.append(cn);
-            d->rights_valid_accesses_map[cn] = valid_accesses;
-        }
+    stream >> file_cache_key >> save_time;
+
+    // NOTE: display specifiers and extended rights are
+    // stored outside of the schema, so changes to them
+    // don't change the key. Refresh the cache once in a
+    // while to eventually pick up such changes.
+    const bool cache_expired = (!save_time.isValid() || save_time.addDays(CACHE_MAX_AGE_DAYS) < QDateTime::currentDateTimeUtc());
+
+    if (file_cache_key != cache_key || cache_expired) {
+        return false;
+    }
+
+    AdConfigData file_data;
+    stream >> file_data.attribute_schema_list;
+    stream >> file_data.class_schema_list;
+    stream >> file_data.display_specifier_list;
+    stream >> file_data.default_display_object;
+    stream >> file_data.ui_settings_object;
+    stream >> file_data.extended_right_list;
+
+    if (stream.status() != QDataStream::Ok) {
+        qDebug() << "Failed to read adconfig cache" << path;
+
+        return false;
+    }
+
+    *data = file_data;
+
+    return true;
+}
+
+void AdConfigPrivate::save_cache(const QString &path, const QString &cache_key, const AdConfigData &data) const {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // NOTE: write to temporary file and rename it at the
+    // end, so that other instances of the app never see
+    // a partially written cache
+    QSaveFile file(path);
+    const bool open_success = file.open(QIODevice::WriteOnly);
+    if (!open_success) {
+        qDebug() << "Failed to open adconfig cache for writing" << path;
+
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream << (quint32) CACHE_MAGIC << (qint32) CACHE_FORMAT_VERSION;
+    stream << cache_key << QDateTime::currentDateTimeUtc();
+    stream << data.attribute_schema_list;
+    stream << data.class_schema_list;
+    stream << data.display_specifier_list;
+    stream << data.default_display_object;
+    stream << data.ui_settings_object;
+    stream << data.extended_right_list;
+
+    const bool commit_success = file.commit();
+    if (!commit_success) {
+        qDebug() << "Failed to save adconfig cache" << path;
+    }
+}
+
+bool search_list(AdInterface &ad, const QString &base, const QString &filter, const QList<QString> &attributes, QList<AdObject> *out) {
+    out->clear();
+
+    const bool success = ad.search_iterate(base, SearchScope_Children, filter, attributes,
+        [&](const AdObject &object) {
+            out->append(object);
+
+            return true;
+        });
+
+    // NOTE: all of the containers searched for config
+    // have children, so empty result means that search
+    // failed silently, for example because of missing
+    // permissions. Treat it as failure so that incomplete
+    // config is not cached.
+    if (out->isEmpty()) {
+        return false;
+    }
+
+    return success;
+}
+
+QDataStream &operator<<(QDataStream &stream, const AdObject &object) {
+    stream << object.get_dn() << object.get_attributes_data();
+
+    return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, AdObject &object) {
+    QString dn;
+    QHash<QString, QList<QByteArray>> attributes_data;
+    stream >> dn >> attributes_data;
+
+    object.load(dn, attributes_data);
+
+    return stream;
+}
+
+AttributeType get_attribute_type_from_schema(const AdObject &schema) {
+    // NOTE: replica of: https://docs.microsoft.com/en-us/openspecs/windows_protocols/ms-adts/7cda533e-d7a4-4aec-a517-91d02ff4a1aa
+    // syntax -> om syntax list -> type
+    static QHash<QString, QHash<QString, AttributeType>> type_map = {
+        {"2.5.5.8", {{"1", AttributeType_Boolean}}},
+        {"2.5.5.9",
+            {
+                {"10", AttributeType_Enumeration},
+                {"2", AttributeType_Integer},
+            }},
+        {"2.5.5.16", {{"65", AttributeType_LargeInteger}}},
+        {"2.5.5.3", {{"27", AttributeType_StringCase}}},
+        {"2.5.5.5", {{"22", AttributeType_IA5}}},
+        {"2.5.5.15", {{"66", AttributeType_NTSecDesc}}},
+        {"2.5.5.6", {{"18", AttributeType_Numeric}}},
+        {"2.5.5.2", {{"6", AttributeType_ObjectIdentifier}}},
+        {"2.5.5.10",
+            {
+                {"4", AttributeType_Octet},
+                {"127", AttributeType_ReplicaLink},
+            }},
+        {"2.5.5.5", {{"19", AttributeType_Printable}}},
+        {"2.5.5.17", {{"4", AttributeType_Sid}}},
+        {"2.5.5.4", {{"20", AttributeType_Teletex}}},
+        {"2.5.5.12", {{"64", AttributeType_Unicode}}},
+        {"2.5.5.11",
+            {
+                {"23", AttributeType_UTCTime},
+                {"24", AttributeType_GeneralizedTime},
+            }},
+        {"2.5.5.14", {{"127", AttributeType_DNString}}},
+        {"2.5.5.7", {{"127", AttributeType_DNBinary}}},
+        {"2.5.5.1", {{"127", AttributeType_DSDN}}},
+    };
+
+    const QString attribute_syntax = schema.get_string(ATTRIBUTE_ATTRIBUTE_SYNTAX);
+    const QString om_syntax = schema.get_string(ATTRIBUTE_OM_SYNTAX);
+
+    const QHash<QString, AttributeType> om_syntax_map = type_map.value(attribute_syntax);
+
+    return om_syntax_map.value(om_syntax, AttributeType_StringCase);
+}
+
+LargeIntegerSubtype get_large_integer_subtype_from_name(const QString &attribute) {
+    // Manually remap large integer types to subtypes
+    static const QSet<QString> datetimes = {
+        ATTRIBUTE_ACCOUNT_EXPIRES,
+        ATTRIBUTE_LAST_LOGON,
+        ATTRIBUTE_LAST_LOGON_TIMESTAMP,
+        ATTRIBUTE_PWD_LAST_SET,
+        ATTRIBUTE_LOCKOUT_TIME,
+        ATTRIBUTE_BAD_PWD_TIME,
+        ATTRIBUTE_CREATION_TIME,
+    };
+    static const QSet<QString> timespans = {
+        ATTRIBUTE_MAX_PWD_AGE,
+        ATTRIBUTE_MIN_PWD_AGE,
+        ATTRIBUTE_LOCKOUT_DURATION,
+        ATTRIBUTE_LOCKOUT_OBSERVATION_WINDOW,
+        ATTRIBUTE_FORCE_LOGOFF,
+    };
+
+    if (datetimes.contains(attribute)) {
+        return LargeIntegerSubtype_Datetime;
+    } else if (timespans.contains(attribute)) {
+        return LargeIntegerSubtype_Timespan;
+    } else {
+        return LargeIntegerSubtype_Integer;
     }
 }
 
@@ -388,6 +909,10 @@ QString AdConfig::domain_sid() const
     return d->domain_sid;
 }
 
+int AdConfig::max_page_size() const {
+    return d->max_page_size;
+}
+
 QString AdConfig::get_attribute_display_name(const Attribute &attribute, const ObjectClass &objectClass) const {
     if (d->attribute_display_names.contains(objectClass) && d->attribute_display_names[objectClass].contains(attribute)) {
         const QString display_name = d->attribute_display_names[objectClass][attribute];
@@ -520,118 +1045,63 @@ QList<QString> AdConfig::get_find_attributes(const QString &object_class) const
 }
 
 AttributeType AdConfig::get_attribute_type(const QString &attribute) const {
-    // NOTE: replica of: https://docs.microsoft.com/en-us/openspecs/windows_protocols/ms-adts/7cda533e-d7a4-4aec-a517-91d02ff4a1aa
-    // syntax -> om syntax list -> type
-    static QHash<QString, QHash<QString, AttributeType>> type_map = {
-        {"2.5.5.8", {{"1", AttributeType_Boolean}}},
-        {"2.5.5.9",
-            {
-                {"10", AttributeType_Enumeration},
-                {"2", AttributeType_Integer},
-            }},
-        {"2.5.5.16", {{"65", AttributeType_LargeInteger}}},
-        {"2.5.5.3", {{"27", AttributeType_StringCase}}},
-        {"2.5.5.5", {{"22", AttributeType_IA5}}},
-        {"2.5.5.15", {{"66", AttributeType_NTSecDesc}}},
-        {"2.5.5.6", {{"18", AttributeType_Numeric}}},
-        {"2.5.5.2", {{"6", AttributeType_ObjectIdentifier}}},
-        {"2.5.5.10",
-            {
-                {"4", AttributeType_Octet},
-                {"127", AttributeType_ReplicaLink},
-            }},
-        {"2.5.5.5", {{"19", AttributeType_Printable}}},
-        {"2.5.5.17", {{"4", AttributeType_Sid}}},
-        {"2.5.5.4", {{"20", AttributeType_Teletex}}},
-        {"2.5.5.12", {{"64", AttributeType_Unicode}}},
-        {"2.5.5.11",
-            {
-                {"23", AttributeType_UTCTime},
-                {"24", AttributeType_GeneralizedTime},
-            }},
-        {"2.5.5.14", {{"127", AttributeType_DNString}}},
-        {"2.5.5.7", {{"127", AttributeType_DNBinary}}},
-        {"2.5.5.1", {{"127", AttributeType_DSDN}}},
-    };
-
-    const AdObject schema = d->attribute_schemas[attribute];
-
-    const QString attribute_syntax = schema.get_string(ATTRIBUTE_ATTRIBUTE_SYNTAX);
-    const QString om_syntax = schema.get_string(ATTRIBUTE_OM_SYNTAX);
-
-    if (type_map.contains(attribute_syntax) && type_map[attribute_syntax].contains(om_syntax)) {
-        return type_map[attribute_syntax][om_syntax];
-    } else {
-        return AttributeType_StringCase;
-    }
+    return d->get_attribute_descriptor(attribute).type;
 }
 
 LargeIntegerSubtype AdConfig::get_attribute_large_integer_subtype(const QString &attribute) const {
-    // Manually remap large integer types to subtypes
-    static const QList<QString> datetimes = {
-        ATTRIBUTE_ACCOUNT_EXPIRES,
-        ATTRIBUTE_LAST_LOGON,
-        ATTRIBUTE_LAST_LOGON_TIMESTAMP,
-        ATTRIBUTE_PWD_LAST_SET,
-        ATTRIBUTE_LOCKOUT_TIME,
-        ATTRIBUTE_BAD_PWD_TIME,
-        ATTRIBUTE_CREATION_TIME,
-    };
-    static const QList<QString> timespans = {
-        ATTRIBUTE_MAX_PWD_AGE,
-        ATTRIBUTE_MIN_PWD_AGE,
-        ATTRIBUTE_LOCKOUT_DURATION,
-        ATTRIBUTE_LOCKOUT_OBSERVATION_WINDOW,
-        ATTRIBUTE_FORCE_LOGOFF,
-    };
+    const AdAttributeDescriptor &descriptor = d->get_attribute_descriptor(attribute);
 
-    if (datetimes.contains(attribute)) {
-        return LargeIntegerSubtype_Datetime;
-    } else if (timespans.contains(attribute)) {
-        return LargeIntegerSubtype_Timespan;
+    if (descriptor.is_valid) {
+        return descriptor.large_integer_subtype;
     } else {
-        return LargeIntegerSubtype_Integer;
+        return get_large_integer_subtype_from_name(attribute);
     }
 }
 
 bool AdConfig::get_attribute_is_number(const QString &attribute) const {
-    static const QList<AttributeType> number_types = {
-        AttributeType_Integer,
-        AttributeType_LargeInteger,
-        AttributeType_Enumeration,
-        AttributeType_Numeric,
-    };
     const AttributeType type = get_attribute_type(attribute);
 
-    return number_types.contains(type);
+    switch (type) {
+        case AttributeType_Integer: return true;
+        case AttributeType_LargeInteger: return true;
+        case AttributeType_Enumeration: return true;
+        case AttributeType_Numeric: return true;
+        default: return false;
+    }
 }
 
 bool AdConfig::get_attribute_is_single_valued(const QString &attribute) const {
-    return d->attribute_schemas[attribute].get_bool(ATTRIBUTE_IS_SINGLE_VALUED);
+    return d->get_attribute_descriptor(attribute).is_single_valued;
 }
 
 bool AdConfig::get_attribute_is_system_only(const QString &attribute) const {
-    return d->attribute_schemas[attribute].get_bool(ATTRIBUTE_SYSTEM_ONLY);
+    return d->get_attribute_descriptor(attribute).is_system_only;
 }
 
 int AdConfig::get_attribute_range_upper(const QString &attribute) const {
-    return d->attribute_schemas[attribute].get_int(ATTRIBUTE_RANGE_UPPER);
+    return d->get_attribute_descriptor(attribute).range_upper;
 }
 
 bool AdConfig::get_attribute_is_backlink(const QString &attribute) const {
-    if (d->attribute_schemas[attribute].contains(ATTRIBUTE_LINK_ID)) {
-        const int link_id = d->attribute_schemas[attribute].get_int(ATTRIBUTE_LINK_ID);
-        const bool link_id_is_odd = (link_id % 2 != 0);
-
-        return link_id_is_odd;
-    } else {
-        return false;
-    }
+    return d->get_attribute_descriptor(attribute).is_backlink;
 }
 
 bool AdConfig::get_attribute_is_constructed(const QString &attribute) const {
-    const int system_flags = d->attribute_schemas[attribute].get_int(ATTRIBUTE_SYSTEM_FLAGS);
-    return bitmask_is_set(system_flags, FLAG_ATTR_IS_CONSTRUCTED);
+    return d->get_attribute_descriptor(attribute).is_constructed;
+}
+
+// NOTE: attributes that are not in schema get an invalid
+// descriptor with default values
+const AdAttributeDescriptor &AdConfigPrivate::get_attribute_descriptor(const Attribute &attribute) const {
+    static const AdAttributeDescriptor invalid_descriptor;
+
+    const int attribute_id = ad_attribute_find_id(attribute);
+
+    if (attribute_id >= 0 && attribute_id < attribute_descriptor_list.size()) {
+        return attribute_descriptor_list[attribute_id];
+    } else {
+        return invalid_descriptor;
+    }
 }
 
 QByteArray AdConfig::get_right_guid(const QString &right_cn) const {
@@ -778,6 +1248,12 @@ QString AdConfig::guid_to_class(const QByteArray &guid) const {
     return out;
 }
 
+QByteArray AdConfig::class_to_guid(const QString &object_class) const {
+    const AdObject schema = d->class_schemas.value(object_class);
+    const QByteArray out = schema.get_value(ATTRIBUTE_SCHEMA_ID_GUID);
+    return out;
+}
+
 // (noncontainer classes) = (all classes) - (container classes)
 QList<QString> AdConfig::get_noncontainer_classes() {
     QList<QString> out = filter_classes;
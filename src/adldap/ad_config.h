@@ -44,14 +44,33 @@ class QList;
 typedef QString ObjectClass;
 typedef QString Attribute;
 
+// Time that one phase of AdConfig::load() took
+class AdConfigLoadTiming {
+public:
+    QString phase;
+    qint64 elapsed;
+};
+
 class AdConfig {
 
 public:
     AdConfig();
     ~AdConfig();
 
+    // Data is loaded from a cache in given directory if
+    // schema didn't change since cache was saved.
+    // Otherwise it's fetched from the server and saved to
+    // the cache. Cache is disabled if dir is empty, which
+    // is the default.
+    static void set_cache_dir(const QString &dir);
+
     void load(AdInterface &ad, const QLocale &locale);
 
+    // Returns time in msecs that each phase of last load()
+    // took. Fetch phases run at the same time, so their
+    // sum is bigger than total fetch time.
+    QList<AdConfigLoadTiming> get_load_timing_list() const;
+
     QString domain() const;
     QString domain_dn() const;
     QString configuration_dn() const;
@@ -62,6 +81,9 @@ public:
     bool control_is_supported(const QString &control_oid) const;
     QString domain_sid() const;
 
+    // MaxPageSize limit from the default query policy
+    int max_page_size() const;
+
     QString get_attribute_display_name(const Attribute &attribute, const ObjectClass &objectClass) const;
 
     QString get_class_display_name(const ObjectClass &objectClass) const;
@@ -107,6 +129,10 @@ public:
 
     QString guid_to_class(const QByteArray &guid) const;
 
+    // Returns schemaIDGUID of class or empty bytes if
+    // class is unknown
+    QByteArray class_to_guid(const QString &object_class) const;
+
     QList<QString> get_noncontainer_classes();
 
     bool rights_applies_to_class(const QString &rights_cn, const QList<QString> &class_list) const;
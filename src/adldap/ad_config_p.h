@@ -21,27 +21,99 @@
 #ifndef AD_CONFIG_P_H
 #define AD_CONFIG_P_H
 
+#include "ad_defines.h"
 #include "ad_object.h"
 
 #include <QByteArray>
 #include <QHash>
 #include <QList>
 #include <QString>
+#include <QThread>
+#include <QVector>
+#include <functional>
 
 // NOTE: name strings to reduce confusion
 typedef QString ObjectClass;
 typedef QString Attribute;
 
+class AdInterface;
+
+// Data fetched from the server, before processing. This is
+// what's stored in the cache.
+class AdConfigData {
+
+public:
+    QList<AdObject> attribute_schema_list;
+    QList<AdObject> class_schema_list;
+    QList<AdObject> display_specifier_list;
+    AdObject default_display_object;
+    AdObject ui_settings_object;
+    QList<AdObject> extended_right_list;
+};
+
+// Schema data of an attribute that is needed to display
+// it's values. Compiled once when config is loaded, so
+// that getting it doesn't require parsing schema objects.
+class AdAttributeDescriptor {
+
+public:
+    AdAttributeDescriptor();
+
+    bool is_valid;
+    AttributeType type;
+    LargeIntegerSubtype large_integer_subtype;
+    bool is_single_valued;
+    bool is_system_only;
+    int range_upper;
+    bool is_backlink;
+    bool is_constructed;
+};
+
+class AdConfigFetchPhase {
+
+public:
+    QString name;
+    std::function<bool(AdInterface &ad)> function;
+};
+
+// Runs a fetch phase on it's own connection
+class AdConfigFetchThread final : public QThread {
+
+public:
+    AdConfigFetchThread(const std::function<bool(AdInterface &ad)> &function_arg);
+
+    bool connected;
+    bool success;
+    qint64 elapsed;
+
+protected:
+    void run() override;
+
+private:
+    std::function<bool(AdInterface &ad)> function;
+};
+
 class AdConfigPrivate {
 
 public:
     AdConfigPrivate();
 
+    static QString s_cache_dir;
+
+    bool fetch(AdInterface &ad, const QString &locale_dir, AdConfigData *data, QList<AdConfigLoadTiming> *timing_list) const;
+    QList<AdConfigFetchPhase> get_fetch_phase_list(const QString &locale_dir, AdConfigData *data) const;
+    void process(const AdConfigData &data);
+    bool load_cache(const QString &path, const QString &cache_key, AdConfigData *data) const;
+    void save_cache(const QString &path, const QString &cache_key, const AdConfigData &data) const;
+
     QString domain;
     QString domain_dn;
     QString configuration_dn;
     QString schema_dn;
     QString domain_sid;
+    int max_page_size;
+
+    QList<AdConfigLoadTiming> load_timing_list;
 
     QList<ObjectClass> filter_containers;
 
@@ -53,6 +125,12 @@ public:
     QHash<ObjectClass, QHash<Attribute, QString>> attribute_display_names;
 
     QHash<Attribute, AdObject> attribute_schemas;
+
+    // NOTE: indexed by attribute id's from
+    // ad_attribute_id(), which makes getting a descriptor
+    // one lookup in the attribute table
+    QVector<AdAttributeDescriptor> attribute_descriptor_list;
+    const AdAttributeDescriptor &get_attribute_descriptor(const Attribute &attribute) const;
     QHash<ObjectClass, AdObject> class_schemas;
 
     QList<ObjectClass> add_auxiliary_classes(const QList<QString> &object_classes) const;
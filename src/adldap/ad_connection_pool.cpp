@@ -0,0 +1,248 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ad_connection_pool.h"
+
+#include <ldap.h>
+#include <poll.h>
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+
+// NOTE: AD drops connections that are idle for longer
+// than MaxConnIdleTime, which is 15 minutes by default,
+// so keep well below that
+#define DEFAULT_IDLE_TIMEOUT (5 * 60 * 1000)
+#define DEFAULT_MAX_IDLE_COUNT 8
+
+class AdIdleConnection {
+public:
+    QString key;
+    LDAP *ld;
+    QString client_user;
+    QList<int> pending_msgid_list;
+    QElapsedTimer idle_timer;
+};
+
+static QMutex pool_mutex;
+static QList<AdIdleConnection> pool_idle_list;
+static int pool_idle_timeout = DEFAULT_IDLE_TIMEOUT;
+static int pool_max_idle_count = DEFAULT_MAX_IDLE_COUNT;
+
+bool connection_is_healthy(LDAP *ld);
+void connection_unbind(LDAP *ld);
+QList<LDAP *> take_expired_connections();
+
+LDAP *AdConnectionPool::acquire(const QString &key, QString *client_user, QList<int> *pending_msgid_list) {
+    QList<LDAP *> unusable_list;
+    LDAP *out = NULL;
+
+    {
+        QMutexLocker locker(&pool_mutex);
+
+        unusable_list = take_expired_connections();
+
+        // NOTE: take most recently released connection
+        // first, it is the least likely to have been
+        // dropped by the server
+        for (int i = pool_idle_list.size() - 1; i >= 0; i--) {
+            const AdIdleConnection &connection = pool_idle_list[i];
+
+            if (connection.key != key) {
+                continue;
+            }
+
+            const AdIdleConnection taken = pool_idle_list.takeAt(i);
+
+            // NOTE: responses to pending requests make the
+            // socket readable, which would fail the health
+            // check, so collect them first
+            const QList<int> still_pending_list = collect_responses(taken.ld, taken.pending_msgid_list);
+
+            if (connection_is_healthy(taken.ld)) {
+                out = taken.ld;
+                *client_user = taken.client_user;
+                *pending_msgid_list = still_pending_list;
+
+                break;
+            } else {
+                unusable_list.append(taken.ld);
+            }
+        }
+    }
+
+    for (LDAP *ld : unusable_list) {
+        connection_unbind(ld);
+    }
+
+    return out;
+}
+
+void AdConnectionPool::release(const QString &key, LDAP *ld, const QString &client_user, const QList<int> &pending_msgid_list_arg) {
+    if (ld == NULL) {
+        return;
+    }
+
+    QList<LDAP *> unusable_list;
+
+    {
+        QMutexLocker locker(&pool_mutex);
+
+        unusable_list = take_expired_connections();
+
+        const int idle_count_for_key = [&]() {
+            int out = 0;
+
+            for (const AdIdleConnection &connection : pool_idle_list) {
+                if (connection.key == key) {
+                    out++;
+                }
+            }
+
+            return out;
+        }();
+
+        const QList<int> pending_msgid_list = collect_responses(ld, pending_msgid_list_arg);
+
+        const bool can_keep = (idle_count_for_key < pool_max_idle_count && connection_is_healthy(ld));
+
+        if (can_keep) {
+            AdIdleConnection connection;
+            connection.key = key;
+            connection.ld = ld;
+            connection.client_user = client_user;
+            connection.pending_msgid_list = pending_msgid_list;
+            connection.idle_timer.start();
+
+            pool_idle_list.append(connection);
+        } else {
+            unusable_list.append(ld);
+        }
+    }
+
+    for (LDAP *unusable : unusable_list) {
+        connection_unbind(unusable);
+    }
+}
+
+void AdConnectionPool::clear() {
+    QList<LDAP *> unbind_list;
+
+    {
+        QMutexLocker locker(&pool_mutex);
+
+        for (const AdIdleConnection &connection : pool_idle_list) {
+            unbind_list.append(connection.ld);
+        }
+
+        pool_idle_list.clear();
+    }
+
+    for (LDAP *ld : unbind_list) {
+        connection_unbind(ld);
+    }
+}
+
+QList<int> AdConnectionPool::collect_responses(LDAP *ld, const QList<int> &msgid_list) {
+    QList<int> out;
+
+    for (const int msgid : msgid_list) {
+        struct timeval zero_timeout = {0, 0};
+        LDAPMessage *res = NULL;
+        const int result = ldap_result(ld, msgid, LDAP_MSG_ALL, &zero_timeout, &res);
+        ldap_msgfree(res);
+
+        const bool is_pending = (result == 0);
+        if (is_pending) {
+            out.append(msgid);
+        }
+    }
+
+    return out;
+}
+
+void AdConnectionPool::set_idle_timeout(const int msecs) {
+    QMutexLocker locker(&pool_mutex);
+
+    pool_idle_timeout = msecs;
+}
+
+void AdConnectionPool::set_max_idle_count(const int count) {
+    QMutexLocker locker(&pool_mutex);
+
+    pool_max_idle_count = count;
+}
+
+// NOTE: this doesn't do a round trip to the server, it
+// only checks the state of the handle and the socket
+// under it
+bool connection_is_healthy(LDAP *ld) {
+    int last_result = LDAP_SUCCESS;
+    ldap_get_option(ld, LDAP_OPT_RESULT_CODE, &last_result);
+
+    const bool connection_failed = (last_result == LDAP_SERVER_DOWN || last_result == LDAP_CONNECT_ERROR);
+    if (connection_failed) {
+        return false;
+    }
+
+    int fd = -1;
+    const int get_desc_result = ldap_get_option(ld, LDAP_OPT_DESC, &fd);
+    if (get_desc_result != LDAP_OPT_SUCCESS || fd < 0) {
+        return false;
+    }
+
+    // NOTE: an idle connection should have nothing to
+    // read. If the socket is readable, then the server
+    // either closed the connection or sent a notice of
+    // disconnection, both of which make the handle
+    // unusable.
+    struct pollfd socket_poll;
+    socket_poll.fd = fd;
+    socket_poll.events = POLLIN;
+    socket_poll.revents = 0;
+
+    const int poll_result = poll(&socket_poll, 1, 0);
+
+    const bool socket_is_idle = (poll_result == 0);
+
+    return socket_is_idle;
+}
+
+void connection_unbind(LDAP *ld) {
+    ldap_unbind_ext(ld, NULL, NULL);
+}
+
+// NOTE: pool mutex must be locked when calling this
+QList<LDAP *> take_expired_connections() {
+    QList<LDAP *> out;
+
+    for (int i = pool_idle_list.size() - 1; i >= 0; i--) {
+        const AdIdleConnection &connection = pool_idle_list[i];
+
+        if (connection.idle_timer.hasExpired(pool_idle_timeout)) {
+            out.append(connection.ld);
+            pool_idle_list.removeAt(i);
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,79 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AD_CONNECTION_POOL_H
+#define AD_CONNECTION_POOL_H
+
+/**
+ * Process-wide pool of bound LDAP connections. Binding
+ * (SASL/GSSAPI) is by far the most expensive part of
+ * creating an AdInterface, so instead of unbinding in
+ * AdInterface's destructor the handle is returned here
+ * and leased to the next AdInterface which connects with
+ * the same key (uri and connection options).
+ *
+ * A lease is exclusive: a handle belongs to exactly one
+ * AdInterface, and so to one thread, until it is
+ * released. Idle handles expire after a timeout and are
+ * health checked before they are leased again.
+ *
+ * Handles can be released with requests whose responses
+ * are still pending, for example requests that release
+ * server state of cancelled searches. Pool keeps waiting
+ * for them and passes the ones that are still pending to
+ * the next user of the handle, so that the requests are
+ * not abandoned before server processes them.
+ */
+
+#include <QList>
+#include <QString>
+
+typedef struct ldap LDAP;
+
+class AdConnectionPool {
+
+public:
+    // Returns an idle bound handle for this key and sets
+    // "client_user" to the user it was bound as and
+    // "pending_msgid_list" to requests that are still
+    // pending on the handle. Caller should collect their
+    // responses with collect_responses(). Returns NULL if
+    // there are no usable idle handles, in which case
+    // caller should bind a new one.
+    static LDAP *acquire(const QString &key, QString *client_user, QList<int> *pending_msgid_list);
+
+    // Returns a handle obtained from acquire() or bound
+    // by caller back to the pool. Handle is unbound
+    // instead if it's broken or the pool is full.
+    static void release(const QString &key, LDAP *ld, const QString &client_user, const QList<int> &pending_msgid_list);
+
+    // Frees responses to given requests that have
+    // arrived, without waiting. Returns requests that are
+    // still pending.
+    static QList<int> collect_responses(LDAP *ld, const QList<int> &msgid_list);
+
+    // Unbinds all idle handles
+    static void clear();
+
+    static void set_idle_timeout(const int msecs);
+    static void set_max_idle_count(const int count);
+};
+
+#endif /* AD_CONNECTION_POOL_H */
@@ -0,0 +1,498 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ad_dc_locator.h"
+
+#include <arpa/nameser.h>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <random>
+#include <resolv.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QVector>
+
+#include <algorithm>
+
+// NOTE: time given to all hosts to accept a TCP
+// connection when measuring RTT. Hosts which don't make
+// it in time are ordered last.
+#define RTT_PROBE_TIMEOUT 1000
+#define RTT_UNREACHABLE 1000000
+
+// NOTE: hosts whose RTT falls into the same bucket are
+// considered equally close and are ordered by weight
+#define RTT_BUCKET_MSECS 20
+
+class AdSrvRecord {
+public:
+    QString host;
+    int priority;
+    int weight;
+    int port;
+    int ttl;
+};
+
+class AdSrvCacheEntry {
+public:
+    QList<AdSrvRecord> record_list;
+    QElapsedTimer age_timer;
+    qint64 ttl_msecs;
+};
+
+static QMutex locator_mutex;
+static QHash<QString, AdSrvCacheEntry> srv_cache;
+static QHash<QString, int> rtt_map;
+static QHash<QString, QString> site_map;
+
+QList<AdSrvRecord> get_srv_records(const QString &dname);
+QList<AdSrvRecord> query_server_for_hosts(const char *dname);
+QHash<QString, int> measure_rtt(const QList<AdSrvRecord> &record_list);
+QString site_dname(const QString &domain, const QString &site);
+
+QList<QString> AdDcLocator::get_hosts(const QString &domain, const QString &site) {
+    const QList<AdSrvRecord> site_record_list = [&]() {
+        if (site.isEmpty()) {
+            return QList<AdSrvRecord>();
+        } else {
+            return get_srv_records(site_dname(domain, site));
+        }
+    }();
+
+    const QList<AdSrvRecord> domain_record_list = get_srv_records(QString("_ldap._tcp.%1").arg(domain));
+
+    QSet<QString> site_host_set;
+    for (const AdSrvRecord &record : site_record_list) {
+        site_host_set.insert(record.host);
+    }
+
+    // NOTE: site hosts are also in domain records, so
+    // remove duplicates, keeping site records
+    QList<AdSrvRecord> record_list = site_record_list;
+    for (const AdSrvRecord &record : domain_record_list) {
+        if (!site_host_set.contains(record.host)) {
+            record_list.append(record);
+        }
+    }
+
+    // Measure RTT for hosts that haven't been measured yet
+    const QList<AdSrvRecord> unmeasured_list = [&]() {
+        QMutexLocker locker(&locator_mutex);
+
+        QList<AdSrvRecord> out;
+
+        for (const AdSrvRecord &record : record_list) {
+            if (!rtt_map.contains(record.host)) {
+                out.append(record);
+            }
+        }
+
+        return out;
+    }();
+
+    if (!unmeasured_list.isEmpty()) {
+        const QHash<QString, int> measured_map = measure_rtt(unmeasured_list);
+
+        QMutexLocker locker(&locator_mutex);
+
+        for (const QString &host : measured_map.keys()) {
+            rtt_map[host] = measured_map[host];
+        }
+    }
+
+    // Sort records
+    class SortKey {
+    public:
+        int priority;
+        bool in_site;
+        int rtt_bucket;
+        double weight_key;
+    };
+
+    QHash<QString, SortKey> sort_key_map;
+
+    {
+        QMutexLocker locker(&locator_mutex);
+
+        static std::mt19937 random_engine(std::random_device {}());
+        std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+        for (const AdSrvRecord &record : record_list) {
+            SortKey key;
+            key.priority = record.priority;
+            key.in_site = site_host_set.contains(record.host);
+            key.rtt_bucket = rtt_map.value(record.host, RTT_UNREACHABLE) / RTT_BUCKET_MSECS;
+
+            // NOTE: weighted random order from RFC 2782,
+            // done by sorting on u^(1/weight). Weight of 0
+            // means "very small chance", not "never".
+            const double weight = (record.weight > 0) ? record.weight : 0.01;
+            key.weight_key = std::pow(distribution(random_engine), 1.0 / weight);
+
+            sort_key_map[record.host] = key;
+        }
+    }
+
+    std::sort(record_list.begin(), record_list.end(),
+        [&](const AdSrvRecord &a, const AdSrvRecord &b) {
+            const SortKey &key_a = sort_key_map[a.host];
+            const SortKey &key_b = sort_key_map[b.host];
+
+            if (key_a.priority != key_b.priority) {
+                return key_a.priority < key_b.priority;
+            } else if (key_a.in_site != key_b.in_site) {
+                return key_a.in_site;
+            } else if (key_a.rtt_bucket != key_b.rtt_bucket) {
+                return key_a.rtt_bucket < key_b.rtt_bucket;
+            } else {
+                return key_a.weight_key > key_b.weight_key;
+            }
+        });
+
+    QList<QString> out;
+    for (const AdSrvRecord &record : record_list) {
+        out.append(record.host);
+    }
+
+    return out;
+}
+
+QList<QString> AdDcLocator::get_site_hosts(const QString &domain, const QString &site) {
+    QList<QString> out;
+
+    if (site.isEmpty()) {
+        return out;
+    }
+
+    const QList<AdSrvRecord> record_list = get_srv_records(site_dname(domain, site));
+    for (const AdSrvRecord &record : record_list) {
+        out.append(record.host);
+    }
+
+    return out;
+}
+
+QString AdDcLocator::get_site(const QString &domain) {
+    QMutexLocker locker(&locator_mutex);
+
+    return site_map.value(domain.toLower());
+}
+
+void AdDcLocator::set_site(const QString &domain, const QString &site) {
+    QMutexLocker locker(&locator_mutex);
+
+    site_map[domain.toLower()] = site;
+}
+
+void AdDcLocator::clear() {
+    QMutexLocker locker(&locator_mutex);
+
+    srv_cache.clear();
+    rtt_map.clear();
+    site_map.clear();
+}
+
+QString site_dname(const QString &domain, const QString &site) {
+    return QString("_ldap._tcp.%1._sites.%2").arg(site, domain);
+}
+
+// Returns cached records if they are still within TTL,
+// otherwise queries the resolver
+QList<AdSrvRecord> get_srv_records(const QString &dname) {
+    {
+        QMutexLocker locker(&locator_mutex);
+
+        if (srv_cache.contains(dname)) {
+            const AdSrvCacheEntry &entry = srv_cache[dname];
+
+            if (!entry.age_timer.hasExpired(entry.ttl_msecs)) {
+                return entry.record_list;
+            }
+        }
+    }
+
+    const QList<AdSrvRecord> record_list = query_server_for_hosts(dname.toUtf8().constData());
+
+    // NOTE: don't cache failures, so that next
+    // connection attempt retries the query
+    if (record_list.isEmpty()) {
+        return record_list;
+    }
+
+    const int ttl = [&]() {
+        int out = record_list[0].ttl;
+
+        for (const AdSrvRecord &record : record_list) {
+            out = std::min(out, record.ttl);
+        }
+
+        return out;
+    }();
+
+    AdSrvCacheEntry entry;
+    entry.record_list = record_list;
+    entry.ttl_msecs = ttl * 1000;
+    entry.age_timer.start();
+
+    QMutexLocker locker(&locator_mutex);
+    srv_cache[dname] = entry;
+
+    return record_list;
+}
+
+/**
+ * Perform a query for dname and output SRV records
+ * dname is a combination of protocols (d->ldap, tcp), domain and site
+ * NOTE: this is rewritten from
+ * https://github.com/paleg/libadclient/blob/master/adclient.cpp
+ * which itself is copied from
+ * https://www.ccnx.org/releases/latest/doc/ccode/html/ccndc-srv_8c_source.html
+ * Another example of similar procedure:
+ * https://www.gnu.org/software/shishi/coverage/shishi/lib/resolv.c.gcov.html
+ */
+QList<AdSrvRecord> query_server_for_hosts(const char *dname) {
+    union dns_msg {
+        HEADER header;
+        unsigned char buf[NS_MAXMSG];
+    } msg;
+
+    auto error = []() {
+        return QList<AdSrvRecord>();
+    };
+
+    const int msg_len = res_search(dname, ns_c_in, ns_t_srv, msg.buf, sizeof(msg.buf));
+
+    // NOTE: res_search() returns full length of the
+    // answer even if it didn't fit into the buffer and was
+    // truncated
+    const bool message_error = (msg_len < (int) sizeof(HEADER) || msg_len > (int) sizeof(msg.buf));
+    if (message_error) {
+        return error();
+    }
+
+    const int packet_count = ntohs(msg.header.qdcount);
+    const int answer_count = ntohs(msg.header.ancount);
+
+    unsigned char *curr = msg.buf + sizeof(msg.header);
+    const unsigned char *eom = msg.buf + msg_len;
+
+    // Skip over packet records
+    for (int i = packet_count; i > 0 && curr < eom; i--) {
+        const int packet_len = dn_skipname(curr, eom);
+
+        const bool packet_error = (packet_len < 0);
+        if (packet_error) {
+            return error();
+        }
+
+        if (eom - curr < packet_len + QFIXEDSZ) {
+            return error();
+        }
+
+        curr = curr + packet_len + QFIXEDSZ;
+    }
+
+    QList<AdSrvRecord> record_list;
+
+    // Process answers by collecting records into list
+    for (int i = 0; i < answer_count; i++) {
+        // Get server
+        char server[NS_MAXDNAME];
+        const int server_len = dn_expand(msg.buf, eom, curr, server, sizeof(server));
+
+        const bool server_error = (server_len < 0);
+        if (server_error) {
+            return error();
+        }
+
+        curr = curr + server_len;
+
+        // Check that fixed part of the record is inside the
+        // answer before reading it
+        if (eom - curr < RRFIXEDSZ) {
+            return error();
+        }
+
+        int record_type;
+        int record_class;
+        unsigned int ttl;
+        int record_len;
+        GETSHORT(record_type, curr);
+        GETSHORT(record_class, curr);
+        GETLONG(ttl, curr);
+        GETSHORT(record_len, curr);
+
+        if (eom - curr < record_len) {
+            return error();
+        }
+        unsigned char *record_end = curr + record_len;
+
+        // Skip non-server records
+        if (record_type != ns_t_srv || record_class != ns_c_in) {
+            curr = record_end;
+
+            continue;
+        }
+
+        // Priority, weight and port
+        const int srv_fixed_size = 3 * NS_INT16SZ;
+        if (record_len < srv_fixed_size) {
+            return error();
+        }
+
+        int priority;
+        int weight;
+        int port;
+        GETSHORT(priority, curr);
+        GETSHORT(weight, curr);
+        GETSHORT(port, curr);
+
+        // Get host
+        char host[NS_MAXDNAME];
+        const int host_len = dn_expand(msg.buf, record_end, curr, host, sizeof(host));
+        const bool host_error = (host_len < 0);
+        if (host_error) {
+            return error();
+        }
+
+        AdSrvRecord record;
+        record.host = QString(host);
+        record.priority = priority;
+        record.weight = weight;
+        record.port = port;
+        record.ttl = (int) ttl;
+
+        record_list.append(record);
+
+        curr = record_end;
+    }
+
+    return record_list;
+}
+
+// Measures time it takes each host to accept a TCP
+// connection. All hosts are probed in parallel, so this
+// takes as long as the slowest host, but no longer than
+// RTT_PROBE_TIMEOUT.
+QHash<QString, int> measure_rtt(const QList<AdSrvRecord> &record_list) {
+    QHash<QString, int> out;
+
+    QVector<struct pollfd> poll_list;
+    QVector<QString> poll_host_list;
+    QVector<qint64> poll_start_list;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (const AdSrvRecord &record : record_list) {
+        out[record.host] = RTT_UNREACHABLE;
+
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        struct addrinfo *info = NULL;
+        const QByteArray port_string = QByteArray::number(record.port);
+        const int getaddrinfo_result = getaddrinfo(record.host.toUtf8().constData(), port_string.constData(), &hints, &info);
+        if (getaddrinfo_result != 0 || info == NULL) {
+            continue;
+        }
+
+        const int fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd < 0) {
+            freeaddrinfo(info);
+
+            continue;
+        }
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+        const qint64 start = timer.elapsed();
+        const int connect_result = connect(fd, info->ai_addr, info->ai_addrlen);
+        freeaddrinfo(info);
+
+        if (connect_result == 0) {
+            out[record.host] = (int) (timer.elapsed() - start);
+            close(fd);
+        } else if (errno == EINPROGRESS) {
+            struct pollfd host_poll;
+            host_poll.fd = fd;
+            host_poll.events = POLLOUT;
+            host_poll.revents = 0;
+
+            poll_list.append(host_poll);
+            poll_host_list.append(record.host);
+            poll_start_list.append(start);
+        } else {
+            close(fd);
+        }
+    }
+
+    while (!poll_list.isEmpty()) {
+        const qint64 remaining = RTT_PROBE_TIMEOUT - timer.elapsed();
+        if (remaining <= 0) {
+            break;
+        }
+
+        const int poll_result = poll(poll_list.data(), poll_list.size(), (int) remaining);
+        if (poll_result <= 0) {
+            break;
+        }
+
+        for (int i = poll_list.size() - 1; i >= 0; i--) {
+            const struct pollfd &host_poll = poll_list[i];
+
+            if (host_poll.revents == 0) {
+                continue;
+            }
+
+            int socket_error = 0;
+            socklen_t socket_error_len = sizeof(socket_error);
+            getsockopt(host_poll.fd, SOL_SOCKET, SO_ERROR, &socket_error, &socket_error_len);
+
+            if (socket_error == 0) {
+                out[poll_host_list[i]] = (int) (timer.elapsed() - poll_start_list[i]);
+            }
+
+            close(host_poll.fd);
+            poll_list.remove(i);
+            poll_host_list.remove(i);
+            poll_start_list.remove(i);
+        }
+    }
+
+    for (const struct pollfd &host_poll : poll_list) {
+        close(host_poll.fd);
+    }
+
+    return out;
+}
@@ -0,0 +1,58 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AD_DC_LOCATOR_H
+#define AD_DC_LOCATOR_H
+
+/**
+ * Finds domain controllers of a domain through DNS SRV
+ * records. Results are cached process-wide for as long as
+ * the TTL of the records allows, so connecting doesn't
+ * hit the resolver every time.
+ *
+ * Hosts are ordered best first: by SRV priority, then
+ * hosts of the client's site, then by measured round trip
+ * time. Hosts with similar RTT are shuffled according to
+ * SRV weights, so that clients spread load across DC's
+ * instead of all using the first SRV record.
+ */
+
+#include <QList>
+#include <QString>
+
+class AdDcLocator {
+
+public:
+    static QList<QString> get_hosts(const QString &domain, const QString &site);
+
+    // Returns only the hosts of given site, unordered
+    static QList<QString> get_site_hosts(const QString &domain, const QString &site);
+
+    // Client's site is unknown until it's found by
+    // AdInterface after the first connection. Once set,
+    // site hosts are ordered first.
+    static QString get_site(const QString &domain);
+    static void set_site(const QString &domain, const QString &site);
+
+    // Drops all cached records and RTT measurements
+    static void clear();
+};
+
+#endif /* AD_DC_LOCATOR_H */
@@ -125,6 +125,9 @@ enum SystemFlagsBit {
 #define ATTRIBUTE_WHEN_CHANGED "whenChanged"
 #define ATTRIBUTE_USN_CHANGED "uSNChanged"
 #define ATTRIBUTE_USN_CREATED "uSNCreated"
+#define ATTRIBUTE_HIGHEST_COMMITTED_USN "highestCommittedUSN"
+#define ATTRIBUTE_IS_DELETED "isDeleted"
+#define ATTRIBUTE_LAST_KNOWN_PARENT "lastKnownParent"
 #define ATTRIBUTE_OBJECT_CATEGORY "objectCategory"
 #define ATTRIBUTE_MEMBER "member"
 #define ATTRIBUTE_MEMBER_OF "memberOf"
@@ -176,6 +179,7 @@ enum SystemFlagsBit {
 #define ATTRIBUTE_OTHER_IP_PHONE "otherIpPhone"
 #define ATTRIBUTE_UPN_SUFFIXES "uPNSuffixes"
 #define ATTRIBUTE_SECURITY_DESCRIPTOR "nTSecurityDescriptor"
+#define ATTRIBUTE_TOKEN_GROUPS "tokenGroups"
 #define ATTRIBUTE_RIGHTS_GUID "rightsGuid"
 #define ATTRIBUTE_LOCATION "location"
 #define ATTRIBUTE_OS "operatingSystem"
@@ -203,6 +207,7 @@ enum SystemFlagsBit {
 #define ATTRIBUTE_DOMAIN_FUNCTIONALITY_LEVEL "domainFunctionality"
 #define ATTRIBUTE_FOREST_FUNCTIONALITY_LEVEL "forestFunctionality"
 #define ATTRIBUTE_OBJECT_VERSION "objectVersion"
+#define ATTRIBUTE_SITE_OBJECT "siteObject"
 
 
 #define CLASS_GROUP "group"
@@ -231,6 +236,7 @@ enum SystemFlagsBit {
 #define CLASS_SITE "site"
 #define CLASS_SERVER "server"
 #define CLASS_SERVERS_CONTAINER "serversContainer"
+#define CLASS_SUBNET "subnet"
 // NOTE: for schema object
 #define CLASS_dMD "dMD"
 #define CLASS_CONTROL_ACCESS_RIGHT "controlAccessRight"
@@ -262,6 +268,10 @@ enum SystemFlagsBit {
 const long long MILLIS_TO_100_NANOS = 10000LL;
 
 #define LDAP_SERVER_SD_FLAGS_OID "1.2.840.113556.1.4.801"
+#define LDAP_SERVER_SORT_OID "1.2.840.113556.1.4.473"
+#define LDAP_SERVER_VLV_OID "2.16.840.1.113730.3.4.9"
+#define LDAP_SERVER_SHOW_DELETED_OID "1.2.840.113556.1.4.417"
+#define LDAP_SERVER_NOTIFICATION_OID "1.2.840.113556.1.4.528"
 #define OWNER_SECURITY_INFORMATION 0x01
 #define GROUP_SECURITY_INFORMATION 0x04
 #define SACL_SECURITY_INFORMATION 0x08
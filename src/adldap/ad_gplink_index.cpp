@@ -0,0 +1,270 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ad_gplink_index.h"
+
+#include "adldap.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+
+// Time in msecs after which index is reloaded, to pick up
+// links changed by others
+#define GPLINK_INDEX_TTL (5 * 60 * 1000)
+
+// NOTE: DN's are compared case insensitively, so keys
+// are lower case DN's
+static QMutex index_mutex;
+static bool index_loaded = false;
+static QString index_domain;
+static QElapsedTimer index_age_timer;
+static QHash<QString, AdObject> container_map;
+static QHash<QString, QSet<QString>> gpo_map;
+
+bool load_index(AdInterface &ad);
+void index_add(const AdObject &object);
+void index_remove(const QString &key);
+void index_clear();
+
+QList<AdObject> AdGplinkIndex::get_links(AdInterface &ad, const QString &gpo) {
+    const bool load_success = load_index(ad);
+    if (!load_success) {
+        return QList<AdObject>();
+    }
+
+    QMutexLocker locker(&index_mutex);
+
+    QList<AdObject> out;
+
+    const QSet<QString> key_set = gpo_map.value(gpo.toLower());
+    for (const QString &key : key_set) {
+        out.append(container_map[key]);
+    }
+
+    return out;
+}
+
+QString AdGplinkIndex::get_gplink(AdInterface &ad, const QString &container_dn) {
+    const bool load_success = load_index(ad);
+
+    if (load_success) {
+        QMutexLocker locker(&index_mutex);
+
+        // NOTE: containers without links are not in the
+        // index, for them this returns empty string
+        const AdObject object = container_map.value(container_dn.toLower());
+        const QString out = object.get_string(ATTRIBUTE_GPLINK);
+
+        return out;
+    } else {
+        const AdObject object = ad.search_object(container_dn, {ATTRIBUTE_GPLINK});
+        const QString out = object.get_string(ATTRIBUTE_GPLINK);
+
+        return out;
+    }
+}
+
+bool AdGplinkIndex::get_loaded_gplink(const QString &container_dn, QString *out) {
+    QMutexLocker locker(&index_mutex);
+
+    if (!index_loaded) {
+        return false;
+    }
+
+    const AdObject object = container_map.value(container_dn.toLower());
+    *out = object.get_string(ATTRIBUTE_GPLINK);
+
+    return true;
+}
+
+void AdGplinkIndex::update(const QString &container_dn, const QString &gplink_string) {
+    QMutexLocker locker(&index_mutex);
+
+    if (!index_loaded) {
+        return;
+    }
+
+    const QString key = container_dn.toLower();
+
+    if (!container_map.contains(key)) {
+        if (gplink_string.isEmpty()) {
+            return;
+        }
+
+        // NOTE: container which had no links yet is not
+        // in the index and its other attributes are
+        // unknown, so load index again on next use
+        index_clear();
+
+        return;
+    }
+
+    QHash<QString, QList<QByteArray>> attributes_data = container_map[key].get_attributes_data();
+    if (gplink_string.isEmpty()) {
+        attributes_data.remove(ATTRIBUTE_GPLINK);
+    } else {
+        attributes_data[ATTRIBUTE_GPLINK] = {gplink_string.toUtf8()};
+    }
+
+    AdObject updated_object;
+    updated_object.load(container_map[key].get_dn(), attributes_data);
+
+    index_remove(key);
+    index_add(updated_object);
+}
+
+void AdGplinkIndex::remove(const QString &dn) {
+    QMutexLocker locker(&index_mutex);
+
+    const QString dn_key = dn.toLower();
+    const QString suffix = "," + dn_key;
+
+    const QList<QString> key_list = container_map.keys();
+    for (const QString &key : key_list) {
+        if (key == dn_key || key.endsWith(suffix)) {
+            index_remove(key);
+        }
+    }
+}
+
+void AdGplinkIndex::invalidate(const QString &dn) {
+    QMutexLocker locker(&index_mutex);
+
+    const QString dn_key = dn.toLower();
+    const QString suffix = "," + dn_key;
+
+    const QList<QString> key_list = container_map.keys();
+    for (const QString &key : key_list) {
+        if (key == dn_key || key.endsWith(suffix)) {
+            index_clear();
+
+            return;
+        }
+    }
+}
+
+void AdGplinkIndex::clear() {
+    QMutexLocker locker(&index_mutex);
+
+    index_clear();
+}
+
+// Loads index if it's not loaded yet, has expired or was
+// loaded for a different domain. Returns false if search
+// failed.
+bool load_index(AdInterface &ad) {
+    if (ad.adconfig() == nullptr) {
+        return false;
+    }
+
+    const QString domain = ad.adconfig()->domain_dn();
+
+    {
+        QMutexLocker locker(&index_mutex);
+
+        const bool index_is_valid = (index_loaded && index_domain == domain && !index_age_timer.hasExpired(GPLINK_INDEX_TTL));
+        if (index_is_valid) {
+            return true;
+        }
+    }
+
+    // NOTE: links can be set on the domain, OU's and
+    // sites, which are in the configuration partition
+    const QList<QString> base_list = {
+        domain,
+        QString("CN=Sites,%1").arg(ad.adconfig()->configuration_dn()),
+    };
+    const QString filter = filter_CONDITION(Condition_Set, ATTRIBUTE_GPLINK);
+    const QList<QString> attributes = {
+        ATTRIBUTE_GPLINK,
+        ATTRIBUTE_OBJECT_CLASS,
+        ATTRIBUTE_OBJECT_CATEGORY,
+    };
+
+    QList<AdObject> object_list;
+
+    for (const QString &base : base_list) {
+        const bool search_success = ad.search_iterate(base, SearchScope_All, filter, attributes,
+            [&](const AdObject &object) {
+                object_list.append(object);
+
+                return true;
+            });
+
+        if (!search_success) {
+            return false;
+        }
+    }
+
+    QMutexLocker locker(&index_mutex);
+
+    index_clear();
+
+    for (const AdObject &object : object_list) {
+        index_add(object);
+    }
+
+    index_loaded = true;
+    index_domain = domain;
+    index_age_timer.start();
+
+    return true;
+}
+
+// NOTE: index f-ns below must be called with index_mutex
+// locked
+void index_add(const AdObject &object) {
+    const QString key = object.get_dn().toLower();
+    container_map[key] = object;
+
+    const Gplink gplink = Gplink(object.get_string(ATTRIBUTE_GPLINK));
+    const QList<QString> gpo_list = gplink.get_gpo_list();
+    for (const QString &gpo : gpo_list) {
+        gpo_map[gpo.toLower()].insert(key);
+    }
+}
+
+void index_remove(const QString &key) {
+    if (!container_map.contains(key)) {
+        return;
+    }
+
+    const Gplink gplink = Gplink(container_map[key].get_string(ATTRIBUTE_GPLINK));
+    const QList<QString> gpo_list = gplink.get_gpo_list();
+    for (const QString &gpo : gpo_list) {
+        const QString gpo_key = gpo.toLower();
+
+        gpo_map[gpo_key].remove(key);
+
+        if (gpo_map[gpo_key].isEmpty()) {
+            gpo_map.remove(gpo_key);
+        }
+    }
+
+    container_map.remove(key);
+}
+
+void index_clear() {
+    index_loaded = false;
+    container_map.clear();
+    gpo_map.clear();
+}
@@ -0,0 +1,80 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AD_GPLINK_INDEX_H
+#define AD_GPLINK_INDEX_H
+
+/**
+ * Process-wide index of policy links. Maps each GPO to
+ * containers (OU's, domain and sites) whose gPLink links
+ * to it. Substring filters on gPLink can't use server
+ * indexes, so instead of searching the whole domain each
+ * time links of a GPO are needed, gPLink of all
+ * containers is loaded once with one search and parsed.
+ *
+ * AdInterface keeps the index up to date when gPLink is
+ * changed or linked containers are deleted, moved or
+ * renamed through it. Changes made by others are picked
+ * up when the index expires, or after clear().
+ */
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class AdInterface;
+class AdObject;
+
+class AdGplinkIndex {
+
+public:
+    // Returns containers which link given GPO. Objects
+    // contain gPLink, objectClass and objectCategory.
+    // Index is loaded on first use and reloaded after it
+    // expires. Returns empty list if index couldn't be
+    // loaded.
+    static QList<AdObject> get_links(AdInterface &ad, const QString &gpo);
+
+    // Returns gPLink of given container. Falls back to
+    // reading it from the server if index couldn't be
+    // loaded.
+    static QString get_gplink(AdInterface &ad, const QString &container_dn);
+
+    // Same as above but never loads the index. Returns
+    // false if index isn't loaded, in which case caller
+    // should use a gPLink value that it has.
+    static bool get_loaded_gplink(const QString &container_dn, QString *out);
+
+    // Updates index after gPLink of container was
+    // changed
+    static void update(const QString &container_dn, const QString &gplink_string);
+
+    // Removes container and its descendants from index
+    // after they were deleted
+    static void remove(const QString &dn);
+
+    // Drops index if given object is a linked container
+    // or contains one, after it's moved or renamed
+    static void invalidate(const QString &dn);
+
+    static void clear();
+};
+
+#endif /* AD_GPLINK_INDEX_H */
@@ -22,9 +22,14 @@
 #include "ad_interface_p.h"
 
 #include "ad_config.h"
+#include "ad_connection_pool.h"
+#include "ad_dc_locator.h"
 #include "ad_display.h"
+#include "ad_gplink_index.h"
 #include "ad_object.h"
+#include "ad_search.h"
 #include "ad_security.h"
+#include "ad_sid_resolver.h"
 #include "ad_utils.h"
 #include "gplink.h"
 #include "samba/dom_sid.h"
@@ -35,6 +40,7 @@
 
 #include "ad_filter.h"
 
+#include <arpa/inet.h>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -45,6 +51,7 @@
 #include <libsmbclient.h>
 #include <resolv.h>
 #include <sasl/sasl.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <uuid/uuid.h>
@@ -67,6 +74,11 @@
 #define MAX_DN_LENGTH 1024
 #define MAX_PASSWORD_LENGTH 255
 
+// NOTE: number of requests that search_objects() keeps
+// outstanding at once, so that a huge list of objects
+// doesn't flood the server
+#define SEARCH_OBJECTS_BATCH_SIZE 100
+
 typedef struct sasl_defaults_gssapi {
     char *mech;
     char *realm;
@@ -80,13 +92,15 @@ enum AceMaskFormat {
     AceMaskFormat_Decimal,
 };
 
-QList<QString> query_server_for_hosts(const char *dname);
 int sasl_interact_gssapi(LDAP *ld, unsigned flags, void *indefaults, void *in);
 QString get_gpt_sd_string(const AdObject &gpc_object, const AceMaskFormat format);
-int create_sd_control(bool get_sacl, int iscritical, LDAPControl **ctrlp);
+QByteArray address_from_string(const QString &string);
+bool address_is_in_subnet(const QByteArray &address, const QByteArray &subnet, const int prefix_len);
 
 AdConfig *AdInterfacePrivate::adconfig = nullptr;
 bool AdInterfacePrivate::s_log_searches = false;
+int AdInterfacePrivate::s_page_size = 100;
+bool AdInterfacePrivate::s_adaptive_page_size = false;
 QString AdInterfacePrivate::s_dc = QString();
 bool AdInterfacePrivate::s_domain_is_default = true;
 QString AdInterfacePrivate::s_custom_domain = QString();
@@ -130,8 +144,14 @@ AdInterface::AdInterface() {
     // Connect via LDAP
     //
 
+    // NOTE: if dc wasn't chosen explicitly, then the
+    // locator chooses it. Client's site is found after the
+    // first connection.
+    const bool dc_is_chosen_by_locator = AdInterfacePrivate::s_dc.isEmpty();
+    const QString site = AdDcLocator::get_site(d->domain);
+
     d->dc = [&]() {
-        const QList<QString> dc_list = get_domain_hosts(d->domain, QString());
+        const QList<QString> dc_list = get_domain_hosts(d->domain, site);
         if (dc_list.isEmpty()) {
             d->error_message_plain(tr("Failed to find domain controllers. Make sure your computer is in the domain and that domain controllers are operational."));
 
@@ -157,6 +177,38 @@ AdInterface::AdInterface() {
         return;
     }
 
+    // NOTE: when locator chose a DC without knowing the
+    // client's site, it could be in a far away site. Find
+    // out the site and switch to a DC in it.
+    if (dc_is_chosen_by_locator && site.isEmpty()) {
+        const QString client_site = d->find_client_site();
+
+        if (!client_site.isEmpty()) {
+            AdDcLocator::set_site(d->domain, client_site);
+
+            const QList<QString> site_dc_list = AdDcLocator::get_site_hosts(d->domain, client_site);
+            const bool dc_is_in_site = (site_dc_list.isEmpty() || site_dc_list.contains(d->dc));
+
+            if (!dc_is_in_site) {
+                const QList<QString> dc_list = get_domain_hosts(d->domain, client_site);
+                if (dc_list.isEmpty()) {
+                    d->error_message_plain(tr("Failed to find domain controllers. Make sure your computer is in the domain and that domain controllers are operational."));
+
+                    return;
+                }
+
+                const QString site_dc = dc_list[0];
+
+                AdInterfacePrivate::s_dc = site_dc;
+                update_dc();
+
+                if (d->ld == NULL) {
+                    return;
+                }
+            }
+        }
+    }
+
     // Initialize SMB context
 
     // NOTE: initialize only once, because otherwise
@@ -191,6 +243,14 @@ void AdInterface::set_log_searches(const bool enabled) {
     AdInterfacePrivate::s_log_searches = enabled;
 }
 
+void AdInterface::set_page_size(const int page_size) {
+    AdInterfacePrivate::s_page_size = page_size;
+}
+
+void AdInterface::set_adaptive_page_size(const bool enabled) {
+    AdInterfacePrivate::s_adaptive_page_size = enabled;
+}
+
 void AdInterface::set_dc(const QString &dc) {
     AdInterfacePrivate::s_dc = dc;
 }
@@ -254,272 +314,120 @@ AdConfig *AdInterface::adconfig() const {
     return d->adconfig;
 }
 
-QString AdInterface::client_user() const {
-    return d->client_user;
-}
-
-// Helper f-n for search()
-// NOTE: cookie is starts as NULL. Then after each while
-// loop, it is set to the value returned by
-// ldap_search_ext_s(). At the end cookie is set back to
-// NULL.
-bool AdInterfacePrivate::search_paged_internal(const char *base, const int scope, const char *filter, char **attributes, QHash<QString, AdObject> *results, AdCookie *cookie, const bool get_sacl) {
-    int result;
-    LDAPMessage *res = NULL;
-    LDAPControl *page_control = NULL;
-    LDAPControl *sd_control = NULL;
-    LDAPControl **returned_controls = NULL;
-    struct berval *prev_cookie = cookie->cookie;
-    struct berval *new_cookie = NULL;
-
-    auto cleanup = [&]() {
-        ldap_msgfree(res);
-        ldap_control_free(page_control);
-        ldap_control_free(sd_control);
-        ldap_controls_free(returned_controls);
-        ber_bvfree(prev_cookie);
-        ber_bvfree(new_cookie);
-    };
-
-    const int is_critical = 1;
+qint64 AdInterface::get_highest_committed_usn() {
+    const AdObject rootDSE_object = search_object(ROOT_DSE, {ATTRIBUTE_HIGHEST_COMMITTED_USN});
 
-    result = create_sd_control(get_sacl, is_critical, &sd_control);
-    if (result != LDAP_SUCCESS) {
-        qDebug() << "Failed to create sd control: " << ldap_err2string(result);
-
-        cleanup();
-        return false;
-    }
-
-    // Create page control
-    const ber_int_t page_size = 100;
-    result = ldap_create_page_control(ld, page_size, prev_cookie, is_critical, &page_control);
-    if (result != LDAP_SUCCESS) {
-        qDebug() << "Failed to create page control: " << ldap_err2string(result);
-
-        cleanup();
-        return false;
-    }
-    LDAPControl *server_controls[3] = {page_control, sd_control, NULL};
-
-    // Perform search
-    const int attrsonly = 0;
-    result = ldap_search_ext_s(ld, base, scope, filter, attributes, attrsonly, server_controls, NULL, NULL, LDAP_NO_LIMIT, &res);
-
-    if ((result != LDAP_SUCCESS) && (result != LDAP_PARTIAL_RESULTS)) {
-        // NOTE: it's not really an error for an object to
-        // not exist. For example, sometimes it's needed to
-        // check whether an object exists. Not sure how to
-        // distinguish this error type from others
-        if (result != LDAP_NO_SUCH_OBJECT) {
-            qDebug() << "Error in paged ldap_search_ext_s: " << ldap_err2string(result);
-        }
-
-        cleanup();
-        return false;
+    if (!rootDSE_object.contains(ATTRIBUTE_HIGHEST_COMMITTED_USN)) {
+        return -1;
     }
 
-    // Collect results for this search
-    for (LDAPMessage *entry = ldap_first_entry(ld, res); entry != NULL; entry = ldap_next_entry(ld, entry)) {
-        char *dn_cstr = ldap_get_dn(ld, entry);
-        const QString dn(dn_cstr);
-        ldap_memfree(dn_cstr);
-
-        QHash<QString, QList<QByteArray>> object_attributes;
-
-        BerElement *berptr;
-        for (char *attr = ldap_first_attribute(ld, entry, &berptr); attr != NULL; attr = ldap_next_attribute(ld, entry, berptr)) {
-            struct berval **values_ldap = ldap_get_values_len(ld, entry, attr);
-
-            const QList<QByteArray> values_bytes = [=]() {
-                QList<QByteArray> out;
-
-                if (values_ldap != NULL) {
-                    const int values_count = ldap_count_values_len(values_ldap);
-                    for (int i = 0; i < values_count; i++) {
-                        struct berval value_berval = *values_ldap[i];
-                        const QByteArray value_bytes(value_berval.bv_val, value_berval.bv_len);
-
-                        out.append(value_bytes);
-                    }
-                }
-
-                return out;
-            }();
+    return rootDSE_object.get_string(ATTRIBUTE_HIGHEST_COMMITTED_USN).toLongLong();
+}
 
-            const QString attribute(attr);
+QString AdInterface::client_user() const {
+    return d->client_user;
+}
 
-            object_attributes[attribute] = values_bytes;
+QHash<QString, AdObject> AdInterface::search(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const bool get_sacl) {
+    QHash<QString, AdObject> results;
 
-            ldap_value_free_len(values_ldap);
-            ldap_memfree(attr);
-        }
-        ber_free(berptr, 0);
+    const bool success = search_iterate(base, scope, filter, attributes,
+        [&](const AdObject &object) {
+            results.insert(object.get_dn(), object);
 
-        AdObject object;
-        object.load(dn, object_attributes);
+            return true;
+        },
+        get_sacl);
 
-        results->insert(dn, object);
+    if (success) {
+        return results;
+    } else {
+        return QHash<QString, AdObject>();
     }
+}
 
-    // Parse the results to retrieve returned controls
-    int errcodep;
-    result = ldap_parse_result(ld, res, &errcodep, NULL, NULL, NULL, &returned_controls, false);
-    if (result != LDAP_SUCCESS) {
-        qDebug() << "Failed to parse result: " << ldap_err2string(result);
+bool AdInterface::search_iterate(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const std::function<bool(const AdObject &object)> &callback, const bool get_sacl, const QList<QString> &sort_key_list) {
+    AdSearch search(*this, base, scope, filter, attributes, get_sacl);
+    search.set_sort_keys(sort_key_list);
 
-        cleanup();
-        return false;
-    }
+    while (true) {
+        AdObject object;
+        const AdSearchStatus status = search.next(&object);
 
-    // Get page response control
-    //
-    // NOTE: not sure if absence of page response control is
-    // an error. Decided to not treat it as error because
-    // searching the rootDSE doesn't return this control.
-    LDAPControl *pageresponse_control = ldap_control_find(LDAP_CONTROL_PAGEDRESULTS, returned_controls, NULL);
-    if (pageresponse_control != NULL) {
-        // Parse page response control to determine whether
-        // there are more pages
-        ber_int_t total_count;
-        new_cookie = (struct berval *) malloc(sizeof(struct berval));
-        result = ldap_parse_pageresponse_control(ld, pageresponse_control, &total_count, new_cookie);
-        if (result != LDAP_SUCCESS) {
-            qDebug() << "Failed to parse pageresponse control: " << ldap_err2string(result);
+        switch (status) {
+            case AdSearchStatus_Entry: {
+                const bool should_continue = callback(object);
 
-            cleanup();
-            return false;
-        }
+                // NOTE: search is abandoned when it goes
+                // out of scope
+                if (!should_continue) {
+                    return true;
+                }
 
-        // Switch to new cookie if there are more pages
-        // NOTE: there are more pages if the cookie isn't
-        // empty
-        const bool more_pages = (new_cookie->bv_len > 0);
-        if (more_pages) {
-            cookie->cookie = ber_bvdup(new_cookie);
-        } else {
-            cookie->cookie = NULL;
+                break;
+            }
+            case AdSearchStatus_PageDone: break;
+            case AdSearchStatus_Finished: return true;
+            case AdSearchStatus_Error: return false;
+            case AdSearchStatus_Timeout: break;
         }
-    } else {
-        cookie->cookie = NULL;
     }
-
-    cleanup();
-    return true;
 }
 
-QHash<QString, AdObject> AdInterface::search(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const bool get_sacl) {
-    AdCookie cookie;
-    QHash<QString, AdObject> results;
-
-    while (true) {
-        const bool success = search_paged(base, scope, filter, attributes, &results, &cookie, get_sacl);
+AdObject AdInterface::search_object(const QString &dn, const QList<QString> &attributes, const bool get_sacl) {
+    const QString base = dn;
+    const SearchScope scope = SearchScope_Object;
+    const QString filter = QString();
 
-        if (!success) {
-            break;
-        }
+    AdObject out;
+    search_iterate(base, scope, filter, attributes,
+        [&](const AdObject &object) {
+            if (object.get_dn() == dn) {
+                out = object;
+            }
 
-        if (!cookie.more_pages()) {
-            break;
-        }
-    }
+            return true;
+        },
+        get_sacl);
 
-    return results;
+    return out;
 }
 
-bool AdInterface::search_paged(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, QHash<QString, AdObject> *results, AdCookie *cookie, const bool get_sacl) {
-    // NOTE: only log once per cycle of search pages,
-    // to avoid duplicate messages
-    const bool is_first_page = results->isEmpty();
-    const bool need_to_log = (AdInterfacePrivate::s_log_searches && is_first_page);
-    if (need_to_log) {
-        const QString attributes_string = "{" + attributes.join(",") + "}";
+QHash<QString, AdObject> AdInterface::search_objects(const QList<QString> &dn_list, const QList<QString> &attributes, const bool get_sacl) {
+    QHash<QString, AdObject> out;
 
-        const QString scope_string = [&scope]() -> QString {
-            switch (scope) {
-                case SearchScope_Object: return "object";
-                case SearchScope_Children: return "children";
-                case SearchScope_Descendants: return "descendants";
-                case SearchScope_All: return "all";
-                default: break;
-            }
-            return QString();
-        }();
+    for (int batch_start = 0; batch_start < dn_list.size(); batch_start += SEARCH_OBJECTS_BATCH_SIZE) {
+        const QList<QString> batch = dn_list.mid(batch_start, SEARCH_OBJECTS_BATCH_SIZE);
 
-        d->success_message(QString(tr("Search:\n\tfilter = \"%1\"\n\tattributes = %2\n\tscope = \"%3\"\n\tbase = \"%4\"")).arg(filter, attributes_string, scope_string, base));
-    }
+        QList<AdSearch *> search_list;
+        for (const QString &dn : batch) {
+            AdSearch *search = new AdSearch(*this, dn, SearchScope_Object, QString(), attributes, get_sacl);
+            search->start();
 
-    const char *base_cstr = cstr(base);
-
-    const int scope_int = [&]() {
-        switch (scope) {
-            case SearchScope_Object: return LDAP_SCOPE_BASE;
-            case SearchScope_Children: return LDAP_SCOPE_ONELEVEL;
-            case SearchScope_All: return LDAP_SCOPE_SUBTREE;
-            case SearchScope_Descendants: return LDAP_SCOPE_CHILDREN;
+            search_list.append(search);
         }
-        return 0;
-    }();
 
-    const char *filter_cstr = [&]() {
-        if (filter.isEmpty()) {
-            // NOTE: need to pass NULL instead of empty
-            // string to denote "no filter"
-            return (const char *) NULL;
-        } else {
-            return cstr(filter);
-        }
-    }();
+        for (int i = 0; i < batch.size(); i++) {
+            const QString &dn = batch[i];
+            AdSearch *search = search_list[i];
 
-    // Convert attributes list to NULL-terminated array
-    char **attributes_array = [&]() {
-        char **out;
-        if (attributes.isEmpty()) {
-            // Pass NULL so LDAP gets all attributes
-            out = NULL;
-        } else {
-            out = (char **) malloc((attributes.size() + 1) * sizeof(char *));
+            // NOTE: read until the end, so that the
+            // result message doesn't need to be abandoned
+            AdSearchStatus status = AdSearchStatus_Entry;
+            while (status == AdSearchStatus_Entry || status == AdSearchStatus_PageDone) {
+                AdObject object;
+                status = search->next(&object);
 
-            if (out != NULL) {
-                for (int i = 0; i < attributes.size(); i++) {
-                    const QString attribute = attributes[i];
-                    out[i] = strdup(cstr(attribute));
+                if (status == AdSearchStatus_Entry) {
+                    out[dn] = object;
                 }
-                out[attributes.size()] = NULL;
             }
         }
 
-        return out;
-    }();
-
-    const bool search_success = d->search_paged_internal(base_cstr, scope_int, filter_cstr, attributes_array, results, cookie, get_sacl);
-    if (!search_success) {
-        results->clear();
-
-        return false;
-    }
-
-    if (attributes_array != NULL) {
-        for (int i = 0; attributes_array[i] != NULL; i++) {
-            free(attributes_array[i]);
-        }
-        free(attributes_array);
+        qDeleteAll(search_list);
     }
 
-    return true;
-}
-
-AdObject AdInterface::search_object(const QString &dn, const QList<QString> &attributes, const bool get_sacl) {
-    const QString base = dn;
-    const SearchScope scope = SearchScope_Object;
-    const QString filter = QString();
-    const QHash<QString, AdObject> results = search(base, scope, filter, attributes, get_sacl);
-
-    if (results.contains(dn)) {
-        return results[dn];
-    } else {
-        return AdObject();
-    }
+    return out;
 }
 
 bool AdInterface::attribute_replace_values(const QString &dn, const QString &attribute, const QList<QByteArray> &values, const DoStatusMsg do_msg) {
@@ -560,6 +468,19 @@ bool AdInterface::attribute_replace_values(const QString &dn, const QString &att
     if (result == LDAP_SUCCESS) {
         d->success_message(QString(tr("Attribute %1 of object %2 was changed from \"%3\" to \"%4\".")).arg(attribute, name, old_values_display, values_display), do_msg);
 
+        const bool is_gplink = (attribute.compare(ATTRIBUTE_GPLINK, Qt::CaseInsensitive) == 0);
+        if (is_gplink) {
+            const QString gplink_string = [&]() {
+                if (values.isEmpty()) {
+                    return QString();
+                } else {
+                    return QString(values[0]);
+                }
+            }();
+
+            AdGplinkIndex::update(dn, gplink_string);
+        }
+
         return true;
     } else {
         const QString context = QString(tr("Failed to change attribute %1 of object %2 from \"%3\" to \"%4\".")).arg(attribute, name, old_values_display, values_display);
@@ -613,6 +534,13 @@ bool AdInterface::attribute_add_value(const QString &dn, const QString &attribut
 
         d->success_message(context, do_msg);
 
+        // NOTE: gPLink is single-valued, so added value
+        // is the whole new gPLink
+        const bool is_gplink = (attribute.compare(ATTRIBUTE_GPLINK, Qt::CaseInsensitive) == 0);
+        if (is_gplink) {
+            AdGplinkIndex::update(dn, QString(value));
+        }
+
         return true;
     } else {
         const QString context = QString(tr("Failed to add value \"%1\" for attribute %2 of object %3.")).arg(new_display_value, attribute, name);
@@ -653,6 +581,13 @@ bool AdInterface::attribute_delete_value(const QString &dn, const QString &attri
 
         d->success_message(context, do_msg);
 
+        // NOTE: gPLink is single-valued, so deleting a
+        // value leaves it empty
+        const bool is_gplink = (attribute.compare(ATTRIBUTE_GPLINK, Qt::CaseInsensitive) == 0);
+        if (is_gplink) {
+            AdGplinkIndex::update(dn, QString());
+        }
+
         return true;
     } else {
         const QString context = QString(tr("Failed to delete value \"%1\" for attribute %2 of object %3.")).arg(value_display, attribute, name);
@@ -795,6 +730,8 @@ bool AdInterface::object_delete(const QString &dn, const DoStatusMsg do_msg) {
     if (result == LDAP_SUCCESS) {
         d->success_message(QString(tr("Object %1 was deleted.")).arg(name), do_msg);
 
+        AdGplinkIndex::remove(dn);
+
         return true;
     } else {
         d->error_message(error_context, d->default_error(), do_msg);
@@ -814,6 +751,9 @@ bool AdInterface::object_move(const QString &dn, const QString &new_container) {
     if (result == LDAP_SUCCESS) {
         d->success_message(QString(tr("Object %1 was moved to %2.")).arg(object_name, container_name));
 
+        AdGplinkIndex::invalidate(dn);
+        AdSidResolver::clear();
+
         return true;
     } else {
         const QString context = QString(tr("Failed to move object %1 to %2.")).arg(object_name, container_name);
@@ -834,6 +774,9 @@ bool AdInterface::object_rename(const QString &dn, const QString &new_name) {
     if (result == LDAP_SUCCESS) {
         d->success_message(QString(tr("Object %1 was renamed to %2.")).arg(old_name, new_name));
 
+        AdGplinkIndex::invalidate(dn);
+        AdSidResolver::clear();
+
         return true;
     } else {
         const QString context = QString(tr("Failed to rename object %1 to %2.")).arg(old_name, new_name);
@@ -1425,12 +1368,11 @@ bool AdInterface::gpo_delete(const QString &dn, bool *deleted_object) {
     }
 
     // Unlink policy
-    const QString base = adconfig()->domain_dn();
-    const SearchScope scope = SearchScope_All;
-    const QList<QString> attributes = {ATTRIBUTE_GPLINK};
-    const QString filter = filter_CONDITION(Condition_Contains, ATTRIBUTE_GPLINK, dn);
-    const QHash<QString, AdObject> results = search(base, scope, filter, attributes);
-    for (const AdObject &linked_object : results.values()) {
+    // NOTE: reload index so that links made by other
+    // clients since it was loaded are also removed
+    AdGplinkIndex::clear();
+    const QList<AdObject> linked_list = AdGplinkIndex::get_links(*this, dn);
+    for (const AdObject &linked_object : linked_list) {
         const QString gplink_old_string = linked_object.get_string(ATTRIBUTE_GPLINK);
 
         Gplink gplink = Gplink(gplink_old_string);
@@ -1485,7 +1427,7 @@ bool AdInterface::ldap_init() {
             out = "ldap://" + d->dc;
 
             if (AdInterfacePrivate::s_port > 0) {
-                out = out + ":" + AdInterfacePrivate::s_port;
+                out = out + ":" + QString::number(AdInterfacePrivate::s_port);
             }
         }
 
@@ -1496,19 +1438,43 @@ bool AdInterface::ldap_init() {
         return false;
     }
 
+    // NOTE: connections are pooled by uri and the options
+    // which are set below, so that changing connection
+    // options never leases a connection made with old
+    // options. Principal of current credentials is also
+    // part of the key, so that after kinit as a different
+    // user, connections bound as the previous user are not
+    // reused.
+    const QString principal = get_default_principal_from_krb5();
+    d->pool_key = QString("%1;nocanon=%2;cert=%3;principal=%4").arg(uri, QString::number(AdInterfacePrivate::s_sasl_nocanon == LDAP_OPT_ON), QString::number(AdInterfacePrivate::s_cert_strat), principal);
+
+    d->ld = AdConnectionPool::acquire(d->pool_key, &d->client_user, &d->release_msgid_list);
+    if (d->ld != NULL) {
+        return true;
+    }
+
     int result;
 
     // NOTE: this doesn't leak memory. False positive.
     result = ldap_initialize(&d->ld, cstr(uri));
     if (result != LDAP_SUCCESS) {
         ldap_memfree(d->ld);
+        d->ld = NULL;
         d->error_message(tr("Failed to initialize LDAP library."), strerror(errno));
 
         return false;
     }
 
+    // NOTE: handle is unbound on failure so that it's
+    // never returned to the pool half-initialized
+    auto free_handle = [&]() {
+        ldap_unbind_ext(d->ld, NULL, NULL);
+        d->ld = NULL;
+    };
+
     auto option_error = [&](const QString &option) {
         d->error_message(connect_error_context, QString(tr("Failed to set ldap option %1.")).arg(option));
+        free_handle();
     };
 
     // Set version
@@ -1575,6 +1541,7 @@ bool AdInterface::ldap_init() {
     if (result != LDAP_SUCCESS) {
         d->error_message_plain(tr("Failed to connect to server. Check your connection and make sure you have initialized your credentials using kinit."));
         d->error_message_plain(d->default_error());
+        free_handle();
 
         return false;
     }
@@ -1598,12 +1565,47 @@ bool AdInterface::ldap_init() {
     return true;
 }
 
+// NOTE: instead of unbinding, the connection is returned
+// to the pool so that the next AdInterface can reuse it
 void AdInterface::ldap_free() {
+    if (d->ld == NULL) {
+        return;
+    }
+
+    // NOTE: releases that are still pending are passed to
+    // the pool, which keeps collecting their responses.
+    // They aren't abandoned, because then server could
+    // drop them before freeing search state.
     if (d->is_connected) {
-        ldap_unbind_ext(d->ld, NULL, NULL);
+        AdConnectionPool::release(d->pool_key, d->ld, d->client_user, d->release_msgid_list);
     } else {
-        ldap_memfree(d->ld);
+        ldap_unbind_ext(d->ld, NULL, NULL);
+    }
+
+    d->ld = NULL;
+    d->release_msgid_list.clear();
+}
+
+bool AdInterfacePrivate::reconnect() {
+    if (ld != NULL) {
+        ldap_unbind_ext(ld, NULL, NULL);
+        ld = NULL;
     }
+
+    // NOTE: requests were lost with the old connection
+    release_msgid_list.clear();
+
+    return q->ldap_init();
+}
+
+void AdInterfacePrivate::collect_releases() {
+    if (ld == NULL) {
+        release_msgid_list.clear();
+
+        return;
+    }
+
+    release_msgid_list = AdConnectionPool::collect_responses(ld, release_msgid_list);
 }
 
 bool AdInterface::gpo_check_perms(const QString &gpo, bool *ok) {
@@ -2060,132 +2062,135 @@ void AdInterface::update_dc() {
     ldap_init();
 }
 
-QList<QString> get_domain_hosts(const QString &domain, const QString &site) {
-    QList<QString> hosts;
-
-    // Query site hosts
-    if (!site.isEmpty()) {
-        char dname[1000];
-        snprintf(dname, sizeof(dname), "_ldap._tcp.%s._sites.%s", cstr(site), cstr(domain));
-
-        const QList<QString> site_hosts = query_server_for_hosts(dname);
-        hosts.append(site_hosts);
-    }
-
-    // Query default hosts
-    char dname_default[1000];
-    snprintf(dname_default, sizeof(dname_default), "_ldap._tcp.%s", cstr(domain));
-
-    const QList<QString> default_hosts = query_server_for_hosts(dname_default);
-    hosts.append(default_hosts);
+QString AdInterfacePrivate::find_client_site() {
+    // Get address of this end of the connection, which
+    // is the address that the DC sees
+    const QByteArray client_address = [&]() {
+        int fd = -1;
+        ldap_get_option(ld, LDAP_OPT_DESC, &fd);
+        if (fd < 0) {
+            return QByteArray();
+        }
 
-    hosts.removeDuplicates();
+        struct sockaddr_storage local_addr;
+        socklen_t local_addr_len = sizeof(local_addr);
+        const int getsockname_result = getsockname(fd, (struct sockaddr *) &local_addr, &local_addr_len);
+        if (getsockname_result != 0) {
+            return QByteArray();
+        }
 
-    return hosts;
-}
+        if (local_addr.ss_family == AF_INET) {
+            const struct sockaddr_in *addr_in = (struct sockaddr_in *) &local_addr;
 
-/**
- * Perform a query for dname and output hosts
- * dname is a combination of protocols (d->ldap, tcp), domain and site
- * NOTE: this is rewritten from
- * https://github.com/paleg/libadclient/blob/master/adclient.cpp
- * which itself is copied from
- * https://www.ccnx.org/releases/latest/doc/ccode/html/ccndc-srv_8c_source.html
- * Another example of similar procedure:
- * https://www.gnu.org/software/shishi/coverage/shishi/lib/resolv.c.gcov.html
- */
-QList<QString> query_server_for_hosts(const char *dname) {
-    union dns_msg {
-        HEADER header;
-        unsigned char buf[NS_MAXMSG];
-    } msg;
-
-    auto error = []() {
-        return QList<QString>();
-    };
+            return QByteArray((const char *) &addr_in->sin_addr, sizeof(addr_in->sin_addr));
+        } else if (local_addr.ss_family == AF_INET6) {
+            const struct sockaddr_in6 *addr_in6 = (struct sockaddr_in6 *) &local_addr;
+            const QByteArray out = QByteArray((const char *) &addr_in6->sin6_addr, sizeof(addr_in6->sin6_addr));
 
-    const long unsigned msg_len = res_search(dname, ns_c_in, ns_t_srv, msg.buf, sizeof(msg.buf));
+            // NOTE: subnets for IPv4 clients connected
+            // through IPv6 socket are still IPv4 subnets
+            if (IN6_IS_ADDR_V4MAPPED(&addr_in6->sin6_addr)) {
+                return out.right(4);
+            } else {
+                return out;
+            }
+        } else {
+            return QByteArray();
+        }
+    }();
 
-    const bool message_error = (msg_len < sizeof(HEADER));
-    if (message_error) {
-        error();
+    if (client_address.isEmpty()) {
+        return QString();
     }
 
-    const int packet_count = ntohs(msg.header.qdcount);
-    const int answer_count = ntohs(msg.header.ancount);
+    const AdObject rootDSE_object = q->search_object(ROOT_DSE, {ATTRIBUTE_CONFIGURATION_NAMING_CONTEXT});
+    const QString configuration_dn = rootDSE_object.get_string(ATTRIBUTE_CONFIGURATION_NAMING_CONTEXT);
+    if (configuration_dn.isEmpty()) {
+        return QString();
+    }
 
-    unsigned char *curr = msg.buf + sizeof(msg.header);
-    const unsigned char *eom = msg.buf + msg_len;
+    const QString subnets_dn = QString("CN=Subnets,CN=Sites,%1").arg(configuration_dn);
+    const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_SUBNET);
+    const QList<QString> attributes = {ATTRIBUTE_CN, ATTRIBUTE_SITE_OBJECT};
+    const QHash<QString, AdObject> subnet_results = q->search(subnets_dn, SearchScope_Children, filter, attributes);
+
+    // NOTE: subnets can be nested, in which case the most
+    // specific one wins
+    QString site_dn;
+    int best_prefix_len = -1;
+    for (const AdObject &subnet : subnet_results) {
+        // NOTE: subnet name is in "address/prefix" format,
+        // for example "10.1.0.0/16"
+        const QList<QString> subnet_parts = subnet.get_string(ATTRIBUTE_CN).split("/");
+        if (subnet_parts.size() != 2) {
+            continue;
+        }
 
-    // Skip over packet records
-    for (int i = packet_count; i > 0 && curr < eom; i--) {
-        const int packet_len = dn_skipname(curr, eom);
+        const QByteArray subnet_address = address_from_string(subnet_parts[0]);
+        bool prefix_len_ok;
+        const int prefix_len = subnet_parts[1].toInt(&prefix_len_ok);
+        if (!prefix_len_ok || prefix_len <= best_prefix_len) {
+            continue;
+        }
 
-        const bool packet_error = (packet_len < 0);
-        if (packet_error) {
-            error();
+        if (address_is_in_subnet(client_address, subnet_address, prefix_len)) {
+            site_dn = subnet.get_string(ATTRIBUTE_SITE_OBJECT);
+            best_prefix_len = prefix_len;
         }
+    }
 
-        curr = curr + packet_len + QFIXEDSZ;
+    if (site_dn.isEmpty()) {
+        return QString();
     }
 
-    QList<QString> hosts;
+    const QString out = dn_get_name(site_dn);
 
-    // Process answers by collecting hosts into list
-    for (int i = 0; i < answer_count; i++) {
-        // Get server
-        char server[NS_MAXDNAME];
-        const int server_len = dn_expand(msg.buf, eom, curr, server, sizeof(server));
+    return out;
+}
 
-        const bool server_error = (server_len < 0);
-        if (server_error) {
-            error();
-        }
+QList<QString> get_domain_hosts(const QString &domain, const QString &site) {
+    return AdDcLocator::get_hosts(domain, site);
+}
 
-        curr = curr + server_len;
+// Returns address in network byte order, 4 bytes for
+// IPv4 and 16 bytes for IPv6
+QByteArray address_from_string(const QString &string) {
+    const QByteArray string_bytes = string.toLatin1();
 
-        int record_type;
-        int UNUSED(record_class);
-        int UNUSED(ttl);
-        int record_len;
-        GETSHORT(record_type, curr);
-        GETSHORT(record_class, curr);
-        GETLONG(ttl, curr);
-        GETSHORT(record_len, curr);
+    struct in_addr addr_ipv4;
+    if (inet_pton(AF_INET, string_bytes.constData(), &addr_ipv4) == 1) {
+        return QByteArray((const char *) &addr_ipv4, sizeof(addr_ipv4));
+    }
 
-        unsigned char *record_end = curr + record_len;
-        if (record_end > eom) {
-            error();
-        }
+    struct in6_addr addr_ipv6;
+    if (inet_pton(AF_INET6, string_bytes.constData(), &addr_ipv6) == 1) {
+        return QByteArray((const char *) &addr_ipv6, sizeof(addr_ipv6));
+    }
 
-        // Skip non-server records
-        if (record_type != ns_t_srv) {
-            curr = record_end;
+    return QByteArray();
+}
 
-            continue;
-        }
+bool address_is_in_subnet(const QByteArray &address, const QByteArray &subnet, const int prefix_len) {
+    if (address.size() != subnet.size() || prefix_len < 0 || prefix_len > address.size() * 8) {
+        return false;
+    }
 
-        int UNUSED(priority);
-        int UNUSED(weight);
-        int UNUSED(port);
-        GETSHORT(priority, curr);
-        GETSHORT(weight, curr);
-        GETSHORT(port, curr);
-
-        // Get host
-        char host[NS_MAXDNAME];
-        const int host_len = dn_expand(msg.buf, eom, curr, host, sizeof(host));
-        const bool host_error = (host_len < 0);
-        if (host_error) {
-            error();
-        }
+    const int full_bytes = prefix_len / 8;
+    const int remaining_bits = prefix_len % 8;
 
-        hosts.append(QString(host));
+    if (address.left(full_bytes) != subnet.left(full_bytes)) {
+        return false;
+    }
+
+    if (remaining_bits > 0) {
+        const unsigned char mask = (unsigned char) (0xFF << (8 - remaining_bits));
+        const unsigned char address_byte = (unsigned char) address[full_bytes];
+        const unsigned char subnet_byte = (unsigned char) subnet[full_bytes];
 
-        curr = record_end;
+        return ((address_byte & mask) == (subnet_byte & mask));
     }
 
-    return hosts;
+    return true;
 }
 
 /**
@@ -2312,18 +2317,6 @@ QString get_gpt_sd_string(const AdObject &gpc_object, const AceMaskFormat format
     return out;
 }
 
-AdCookie::AdCookie() {
-    cookie = NULL;
-}
-
-bool AdCookie::more_pages() const {
-    return (cookie != NULL);
-}
-
-AdCookie::~AdCookie() {
-    ber_bvfree(cookie);
-}
-
 AdMessage::AdMessage(const QString &text, const AdMessageType &type) {
     m_text = text;
     m_type = type;
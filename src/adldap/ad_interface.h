@@ -29,10 +29,13 @@
 #include <QCoreApplication>
 #include <QHash>
 #include <QSet>
+#include <functional>
 
 #include "ad_defines.h"
 
 class AdInterfacePrivate;
+class AdSearchPrivate;
+class AdVlvSearchPrivate;
 class QString;
 class QByteArray;
 class QDateTime;
@@ -55,20 +58,6 @@ enum DoStatusMsg {
     DoStatusMsg_No
 };
 
-class AdCookie {
-public:
-    AdCookie();
-    ~AdCookie();
-
-    bool more_pages() const;
-
-private:
-    struct berval *cookie;
-
-    friend class AdInterface;
-    friend class AdInterfacePrivate;
-};
-
 class AdMessage {
 
 public:
@@ -100,6 +89,15 @@ public:
 
     static void set_log_searches(const bool enabled);
 
+    // Page size of paged searches. If adaptive page size
+    // is enabled, searches start with a small first page
+    // so that first results arrive quickly, then grow the
+    // page while the server responds fast, up to the
+    // given page size or the server's MaxPageSize,
+    // whichever is smaller.
+    static void set_page_size(const int page_size);
+    static void set_adaptive_page_size(const bool enabled);
+
     static void set_dc(const QString &dc);
     static void set_sasl_nocanon(const bool is_on);
     static void set_port(const int port);
@@ -117,6 +115,12 @@ public:
     QString get_dc() const;
     QString get_domain() const;
 
+    // Returns highest USN committed on current DC, or -1
+    // if it couldn't be read. Objects changed after this
+    // will have greater uSNChanged. Note that USN's are
+    // local to each DC.
+    qint64 get_highest_committed_usn();
+
     // NOTE: Updates dc for AdInterface instance from static AdInterfacePrivate::s_dc.
     // It is needed when DC changes after AdInterface object was constructed.
     void update_dc();
@@ -125,21 +129,31 @@ public:
     // attributes are returned
 
     // This is a simplified version that searches all pages
-    // in one go
+    // in one go. For cases where you want to display
+    // search results as they come in instead of all at
+    // once, use AdSearch.
     QHash<QString, AdObject> search(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const bool get_sacl = false);
 
-    // This is a more complicated version of search() which
-    // separates the search process by pages as they arrive
-    // from the server. In general you can use the simpler
-    // search(). This version is for cases where you want to
-    // display search results as they come in instead of all
-    // at once.
-    bool search_paged(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, QHash<QString, AdObject> *results, AdCookie *cookie, const bool get_sacl = false);
+    // Calls given function for each object as soon as it
+    // is received, without collecting results, so that
+    // large searches run in bounded memory. Return false
+    // from the function to stop the search early. Returns
+    // false if search failed. Objects are received in
+    // order of sort keys if they are given and server
+    // supports sorting, see AdSearch::set_sort_keys().
+    bool search_iterate(const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const std::function<bool(const AdObject &object)> &callback, const bool get_sacl = false, const QList<QString> &sort_key_list = QList<QString>());
 
     // Simplest search f-n that only searches for attributes
     // of one object
     AdObject search_object(const QString &dn, const QList<QString> &attributes = QList<QString>(), const bool get_sacl = false);
 
+    // Searches for attributes of multiple objects. Requests
+    // are sent in batches without waiting for responses,
+    // so this takes a few round trips instead of one per
+    // object. Results are keyed by given dn's. Objects that
+    // weren't found are not included.
+    QHash<QString, AdObject> search_objects(const QList<QString> &dn_list, const QList<QString> &attributes = QList<QString>(), const bool get_sacl = false);
+
     bool attribute_replace_values(const QString &dn, const QString &attribute, const QList<QByteArray> &values, const DoStatusMsg do_msg = DoStatusMsg_Yes);
 
     bool attribute_replace_value(const QString &dn, const QString &attribute, const QByteArray &value, const DoStatusMsg do_msg = DoStatusMsg_Yes);
@@ -187,6 +201,10 @@ public:
 private:
     AdInterfacePrivate *d;
 
+    friend AdInterfacePrivate;
+    friend AdSearchPrivate;
+    friend AdVlvSearchPrivate;
+
     bool ldap_init();
     void ldap_free();
 };
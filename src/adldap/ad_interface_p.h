@@ -27,14 +27,19 @@
 
 class AdInterface;
 class AdConfig;
+class AdSearchPrivate;
+class AdVlvSearchPrivate;
 class QString;
 typedef struct ldap LDAP;
+typedef struct ldapcontrol LDAPControl;
 typedef struct _SMBCCTX SMBCCTX;
 
 class AdInterfacePrivate {
     Q_DECLARE_TR_FUNCTIONS(AdInterfacePrivate)
 
     friend AdInterface;
+    friend AdSearchPrivate;
+    friend AdVlvSearchPrivate;
     static QMutex mutex;
 
 public:
@@ -45,15 +50,33 @@ public:
     QString domain;
     QString dc;
     QString client_user;
+    QString pool_key;
     QList<AdMessage> messages;
 
+    // Requests that release server state of cancelled
+    // paged searches. Their responses are not waited for,
+    // see AdSearchPrivate::release_cookie().
+    QList<int> release_msgid_list;
+
     void success_message(const QString &msg, const DoStatusMsg do_msg = DoStatusMsg_Yes);
     void error_message(const QString &context, const QString &error, const DoStatusMsg do_msg = DoStatusMsg_Yes);
     void error_message_plain(const QString &text, const DoStatusMsg do_msg = DoStatusMsg_Yes);
     QString default_error() const;
     int get_ldap_result() const;
-    bool search_paged_internal(const char *base, const int scope, const char *filter, char **attributes, QHash<QString, AdObject> *results, AdCookie *cookie, const bool get_sacl);
     bool connect_via_ldap(const char *uri);
+
+    // Replaces a handle that lost connection to the
+    // server with a newly bound one
+    bool reconnect();
+
+    // Frees responses to release requests that have
+    // arrived. Requests that are still pending are kept.
+    void collect_releases();
+
+    // Finds client's site by matching local address of
+    // the connection against subnet objects. Returns
+    // empty string if no subnet matches.
+    QString find_client_site();
     bool delete_gpt(const QString &parent_path);
     bool smb_path_is_dir(const QString &path, bool *ok);
 
@@ -64,6 +87,8 @@ public:
 private:
     static AdConfig *adconfig;
     static bool s_log_searches;
+    static int s_page_size;
+    static bool s_adaptive_page_size;
     static QString s_dc;
     static void *s_sasl_nocanon;
     static int s_port;
@@ -74,4 +99,8 @@ private:
     AdInterface *q;
 };
 
+// Creates control which sets security descriptor
+// parts returned by searches
+int create_sd_control(bool get_sacl, int iscritical, LDAPControl **ctrlp);
+
 #endif /* AD_INTERFACE_P_H */
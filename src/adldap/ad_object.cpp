@@ -19,6 +19,7 @@
  */
 
 #include "ad_object.h"
+#include "ad_object_p.h"
 
 #include "ad_config.h"
 #include "ad_display.h"
@@ -32,15 +33,68 @@
 #include <QHash>
 #include <QList>
 #include <QMap>
+#include <QReadWriteLock>
 #include <QString>
 #include <algorithm>
+#include <cstring>
+
+// NOTE: chunks are started at this size and grow to fit
+// a whole page
+#define ARENA_MIN_CHUNK_SIZE (16 * 1024)
+
+static QReadWriteLock attribute_table_lock;
+static QHash<QByteArray, int> attribute_bytes_to_id_map;
+static QHash<QString, int> attribute_to_id_map;
+static QList<QString> attribute_name_list;
+
+bool ref_attribute_less_than(const AdValueRef &ref, const int attribute_id);
 
 AdObject::AdObject() {
 }
 
 void AdObject::load(const QString &dn_arg, const QHash<QString, QList<QByteArray>> &attributes_data_arg) {
+    const int total_size = [&]() {
+        int out = 0;
+
+        for (const QList<QByteArray> &values : attributes_data_arg) {
+            for (const QByteArray &value : values) {
+                out += value.size();
+            }
+        }
+
+        return out;
+    }();
+
+    QSharedPointer<AdValueChunk> new_chunk = QSharedPointer<AdValueChunk>(new AdValueChunk(total_size));
+    QVector<AdValueRef> new_ref_list;
+
+    for (auto it = attributes_data_arg.begin(); it != attributes_data_arg.end(); it++) {
+        const int attribute_id = ad_attribute_id(it.key());
+        const QList<QByteArray> &values = it.value();
+
+        if (values.isEmpty()) {
+            new_ref_list.append({attribute_id, 0, -1});
+        }
+
+        for (const QByteArray &value : values) {
+            memcpy(new_chunk->data + new_chunk->size, value.constData(), value.size());
+            new_ref_list.append({attribute_id, new_chunk->size, value.size()});
+            new_chunk->size += value.size();
+        }
+    }
+
+    std::stable_sort(new_ref_list.begin(), new_ref_list.end(),
+        [](const AdValueRef &a, const AdValueRef &b) {
+            return a.attribute_id < b.attribute_id;
+        });
+
+    load(dn_arg, new_chunk, new_ref_list);
+}
+
+void AdObject::load(const QString &dn_arg, const QSharedPointer<AdValueChunk> &chunk_arg, const QVector<AdValueRef> &ref_list_arg) {
     dn = dn_arg;
-    attributes_data = attributes_data_arg;
+    chunk = chunk_arg;
+    ref_list = ref_list_arg;
 }
 
 QString AdObject::get_dn() const {
@@ -48,34 +102,65 @@ QString AdObject::get_dn() const {
 }
 
 QHash<QString, QList<QByteArray>> AdObject::get_attributes_data() const {
-    return attributes_data;
+    QHash<QString, QList<QByteArray>> out;
+
+    for (const AdValueRef &ref : ref_list) {
+        QList<QByteArray> &values = out[ad_attribute_name(ref.attribute_id)];
+
+        if (ref.size != -1) {
+            values.append(get_ref_value(ref));
+        }
+    }
+
+    return out;
 }
 
 bool AdObject::is_empty() const {
-    return attributes_data.isEmpty();
+    return ref_list.isEmpty();
 }
 
 bool AdObject::contains(const QString &attribute) const {
-    return attributes_data.contains(attribute);
+    return (find_attribute(attribute) != ref_list.end());
 }
 
 QList<QString> AdObject::attributes() const {
-    return attributes_data.keys();
+    QList<QString> out;
+
+    for (int i = 0; i < ref_list.size(); i++) {
+        const bool is_new_attribute = (i == 0 || ref_list[i].attribute_id != ref_list[i - 1].attribute_id);
+
+        if (is_new_attribute) {
+            out.append(ad_attribute_name(ref_list[i].attribute_id));
+        }
+    }
+
+    return out;
 }
 
 QList<QByteArray> AdObject::get_values(const QString &attribute) const {
-    if (contains(attribute)) {
-        return attributes_data[attribute];
-    } else {
-        return QList<QByteArray>();
+    QList<QByteArray> out;
+
+    auto it = find_attribute(attribute);
+    if (it == ref_list.end()) {
+        return out;
     }
+
+    const int attribute_id = it->attribute_id;
+
+    for (; it != ref_list.end() && it->attribute_id == attribute_id; it++) {
+        if (it->size != -1) {
+            out.append(get_ref_value(*it));
+        }
+    }
+
+    return out;
 }
 
 QByteArray AdObject::get_value(const QString &attribute) const {
-    const QList<QByteArray> values = get_values(attribute);
+    auto it = find_attribute(attribute);
 
-    if (!values.isEmpty()) {
-        return values.first();
+    if (it != ref_list.end() && it->size != -1) {
+        return get_ref_value(*it);
     } else {
         return QByteArray();
     }
@@ -274,3 +359,124 @@ security_descriptor *AdObject::get_security_descriptor(TALLOC_CTX *mem_ctx_arg)
 
     return out;
 }
+
+// Returns iterator to the first value of attribute
+QVector<AdValueRef>::const_iterator AdObject::find_attribute(const QString &attribute) const {
+    const int attribute_id = ad_attribute_find_id(attribute);
+    if (attribute_id == -1) {
+        return ref_list.end();
+    }
+
+    auto it = std::lower_bound(ref_list.begin(), ref_list.end(), attribute_id, ref_attribute_less_than);
+
+    if (it != ref_list.end() && it->attribute_id == attribute_id) {
+        return it;
+    } else {
+        return ref_list.end();
+    }
+}
+
+// NOTE: value is copied out of the chunk, so that it
+// stays valid after the object is destroyed
+QByteArray AdObject::get_ref_value(const AdValueRef &ref) const {
+    return QByteArray(chunk->data + ref.offset, ref.size);
+}
+
+bool ref_attribute_less_than(const AdValueRef &ref, const int attribute_id) {
+    return (ref.attribute_id < attribute_id);
+}
+
+AdValueChunk::AdValueChunk(const int capacity_arg) {
+    capacity = capacity_arg;
+    size = 0;
+    data = new char[std::max(capacity, 1)];
+}
+
+AdValueChunk::~AdValueChunk() {
+    delete[] data;
+}
+
+int AdValueChunk::available() const {
+    return capacity - size;
+}
+
+AdValueArena::AdValueArena() {
+    page_size = 0;
+    last_page_size = ARENA_MIN_CHUNK_SIZE;
+}
+
+QSharedPointer<AdValueChunk> AdValueArena::reserve(const int size) {
+    const bool need_new_chunk = (current.isNull() || current->available() < size);
+
+    if (need_new_chunk) {
+        const int capacity = std::max(size, std::max(last_page_size - page_size, ARENA_MIN_CHUNK_SIZE));
+
+        current = QSharedPointer<AdValueChunk>(new AdValueChunk(capacity));
+    }
+
+    page_size += size;
+
+    return current;
+}
+
+void AdValueArena::start_page() {
+    if (page_size > 0) {
+        last_page_size = page_size;
+    }
+
+    page_size = 0;
+    current.clear();
+}
+
+int ad_attribute_id(const QByteArray &attribute) {
+    {
+        QReadLocker locker(&attribute_table_lock);
+
+        const int out = attribute_bytes_to_id_map.value(attribute, -1);
+        if (out != -1) {
+            return out;
+        }
+    }
+
+    QWriteLocker locker(&attribute_table_lock);
+
+    // NOTE: check again because another thread could've
+    // added the attribute while lock was released
+    const int existing = attribute_bytes_to_id_map.value(attribute, -1);
+    if (existing != -1) {
+        return existing;
+    }
+
+    // NOTE: attribute could be a raw view of LDAP's
+    // memory, so make a deep copy for the table
+    const QByteArray attribute_copy = QByteArray(attribute.constData(), attribute.size());
+    const QString attribute_string = QString::fromUtf8(attribute_copy);
+    const int new_id = attribute_name_list.size();
+
+    attribute_name_list.append(attribute_string);
+    attribute_bytes_to_id_map[attribute_copy] = new_id;
+    attribute_to_id_map[attribute_string] = new_id;
+
+    return new_id;
+}
+
+int ad_attribute_id(const QString &attribute) {
+    const int existing = ad_attribute_find_id(attribute);
+    if (existing != -1) {
+        return existing;
+    }
+
+    return ad_attribute_id(attribute.toUtf8());
+}
+
+int ad_attribute_find_id(const QString &attribute) {
+    QReadLocker locker(&attribute_table_lock);
+
+    return attribute_to_id_map.value(attribute, -1);
+}
+
+QString ad_attribute_name(const int id) {
+    QReadLocker locker(&attribute_table_lock);
+
+    return attribute_name_list.value(id);
+}
@@ -36,13 +36,26 @@
 #include <QByteArray>
 #include <QHash>
 #include <QList>
+#include <QSharedPointer>
 #include <QString>
+#include <QVector>
 
 class QDateTime;
 class AdConfig;
+class AdValueChunk;
 typedef void TALLOC_CTX;
 struct security_descriptor;
 
+// Location of one attribute value inside of the chunk.
+// Attributes without values have size of -1.
+class AdValueRef {
+public:
+    int attribute_id;
+    int offset;
+    int size;
+};
+Q_DECLARE_TYPEINFO(AdValueRef, Q_PRIMITIVE_TYPE);
+
 class AdObject {
 
 public:
@@ -50,6 +63,11 @@ public:
 
     void load(const QString &dn_arg, const QHash<QString, QList<QByteArray>> &attributes_data_arg);
 
+    // NOTE: used by AdSearch to load objects without
+    // copying values. Refs must be sorted by attribute id,
+    // keeping the order of values of each attribute.
+    void load(const QString &dn_arg, const QSharedPointer<AdValueChunk> &chunk_arg, const QVector<AdValueRef> &ref_list_arg);
+
     QString get_dn() const;
     QHash<QString, QList<QByteArray>> get_attributes_data() const;
     bool is_empty() const;
@@ -89,7 +107,11 @@ public:
 
 private:
     QString dn;
-    QHash<QString, QList<QByteArray>> attributes_data;
+    QSharedPointer<AdValueChunk> chunk;
+    QVector<AdValueRef> ref_list;
+
+    QVector<AdValueRef>::const_iterator find_attribute(const QString &attribute) const;
+    QByteArray get_ref_value(const AdValueRef &ref) const;
 };
 
 #endif /* AD_OBJECT_H */
@@ -0,0 +1,89 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AD_OBJECT_P_H
+#define AD_OBJECT_P_H
+
+/**
+ * Storage used by AdObject. Attribute names are interned
+ * into process-wide integer id's, so objects don't store a
+ * copy of each name. Values of many objects are stored
+ * back to back in shared chunks of memory, and objects
+ * only store offsets into the chunk.
+ */
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+
+// NOTE: chunk is allocated once and never reallocated.
+// It's only appended to, so data that was already given
+// out to objects never moves or changes. This makes it
+// safe to pass objects to other threads while the search
+// thread keeps filling the rest of the chunk.
+class AdValueChunk {
+
+public:
+    AdValueChunk(const int capacity_arg);
+    ~AdValueChunk();
+
+    char *data;
+    int capacity;
+    int size;
+
+    int available() const;
+
+private:
+    Q_DISABLE_COPY(AdValueChunk)
+};
+
+// Hands out chunks for values of objects that are
+// received in one page of a search. Each page starts a
+// new chunk, sized based on how much the previous page
+// used, so that usually one page is stored in one chunk.
+class AdValueArena {
+
+public:
+    AdValueArena();
+
+    // Returns chunk with at least given amount of free
+    // space
+    QSharedPointer<AdValueChunk> reserve(const int size);
+
+    void start_page();
+
+private:
+    QSharedPointer<AdValueChunk> current;
+    int page_size;
+    int last_page_size;
+};
+
+// Returns id of attribute, adding it to the table if it's
+// not there yet
+int ad_attribute_id(const QByteArray &attribute);
+int ad_attribute_id(const QString &attribute);
+
+// Returns -1 if attribute is not in the table. Such
+// attribute can't be contained in any object.
+int ad_attribute_find_id(const QString &attribute);
+
+QString ad_attribute_name(const int id);
+
+#endif /* AD_OBJECT_P_H */
@@ -0,0 +1,965 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ad_search.h"
+
+#include "ad_config.h"
+#include "ad_interface.h"
+#include "ad_interface_p.h"
+#include "ad_object.h"
+#include "ad_object_p.h"
+
+#include <lber.h>
+#include <ldap.h>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+
+// NOTE: adaptive page size starts small so that the
+// first rows show up quickly, then grows while pages
+// come back fast and shrinks if they become slow
+#define ADAPTIVE_FIRST_PAGE_SIZE 50
+#define ADAPTIVE_GROW_LATENCY 300
+#define ADAPTIVE_SHRINK_LATENCY 1500
+
+class AdSearchPrivate {
+public:
+    AdInterface *ad;
+    QByteArray base;
+    int scope;
+    QByteArray filter;
+    QList<QByteArray> attribute_list;
+    QVector<char *> attributes_array;
+    bool get_sacl;
+    QByteArray sort_keys;
+    bool show_deleted;
+    bool notify;
+
+    int msgid;
+    LDAP *request_ld;
+    struct berval *cookie;
+    bool started;
+    bool finished;
+    AdSearchStatus final_status;
+    bool received_entries;
+    int page_size;
+    QElapsedTimer page_timer;
+    AdValueArena arena;
+
+    bool start();
+    AdSearchStatus next(AdObject *object, const int timeout);
+    void cancel();
+    void release_cookie();
+    LDAP *ld() const;
+    bool create_controls(const int request_page_size, QList<LDAPControl *> *out);
+    bool send_request();
+    bool can_retry() const;
+    AdSearchStatus finish(const AdSearchStatus status);
+    AdSearchStatus process_page_result(LDAPMessage *message);
+    int max_page_size() const;
+    void update_page_size();
+    void log_search(const QString &base_string, const SearchScope scope_enum, const QString &filter_string, const QList<QString> &attributes);
+};
+
+void load_object_from_entry(LDAP *ld, LDAPMessage *entry, AdValueArena *arena, AdObject *object);
+
+class AdVlvSearchPrivate {
+public:
+    AdInterface *ad;
+    QByteArray base;
+    int scope;
+    QByteArray filter;
+    QList<QByteArray> attribute_list;
+    QVector<char *> attributes_array;
+    QByteArray sort_attribute;
+
+    struct berval *context;
+    int offset;
+    int count;
+
+    LDAP *ld() const;
+    bool search(const int offset, const QString &value, const int size, QList<AdObject> *out);
+};
+
+int ldap_scope_from_search_scope(const SearchScope scope);
+
+AdSearch::AdSearch(AdInterface &ad, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const bool get_sacl) {
+    d = new AdSearchPrivate();
+
+    d->ad = &ad;
+    d->base = base.toUtf8();
+    d->filter = filter.toUtf8();
+    d->get_sacl = get_sacl;
+    d->show_deleted = false;
+    d->notify = false;
+    d->msgid = -1;
+    d->request_ld = NULL;
+    d->cookie = NULL;
+    d->started = false;
+    d->finished = false;
+    d->final_status = AdSearchStatus_Finished;
+    d->received_entries = false;
+
+    d->page_size = [&]() {
+        if (AdInterfacePrivate::s_adaptive_page_size) {
+            return std::min(ADAPTIVE_FIRST_PAGE_SIZE, d->max_page_size());
+        } else {
+            return d->max_page_size();
+        }
+    }();
+
+    d->scope = ldap_scope_from_search_scope(scope);
+
+    // Convert attributes list to NULL-terminated array.
+    // Empty array stays empty so that NULL is passed to
+    // LDAP and it returns all attributes.
+    for (const QString &attribute : attributes) {
+        d->attribute_list.append(attribute.toUtf8());
+    }
+    for (QByteArray &attribute : d->attribute_list) {
+        d->attributes_array.append(attribute.data());
+    }
+    if (!d->attributes_array.isEmpty()) {
+        d->attributes_array.append(NULL);
+    }
+
+    d->log_search(base, scope, filter, attributes);
+}
+
+AdSearch::~AdSearch() {
+    // NOTE: cancel search that is still in progress,
+    // otherwise it's results would keep arriving on this
+    // connection after it's returned to the pool
+    d->cancel();
+
+    ber_bvfree(d->cookie);
+
+    delete d;
+}
+
+void AdSearch::set_sort_keys(const QList<QString> &key_list) {
+    if (d->started) {
+        qDebug() << "Sort keys set after search started, ignoring";
+
+        return;
+    }
+
+    // NOTE: keylist string format is keys separated by
+    // spaces
+    d->sort_keys = QStringList(key_list).join(" ").toUtf8();
+}
+
+void AdSearch::set_show_deleted(const bool show_deleted) {
+    if (d->started) {
+        qDebug() << "Show deleted set after search started, ignoring";
+
+        return;
+    }
+
+    d->show_deleted = show_deleted;
+}
+
+void AdSearch::set_notify(const bool notify) {
+    if (d->started) {
+        qDebug() << "Notify set after search started, ignoring";
+
+        return;
+    }
+
+    d->notify = notify;
+}
+
+bool AdSearch::start() {
+    return d->start();
+}
+
+AdSearchStatus AdSearch::next(AdObject *object, const int timeout) {
+    return d->next(object, timeout);
+}
+
+void AdSearch::cancel() {
+    d->cancel();
+}
+
+bool AdSearchPrivate::start() {
+    if (started) {
+        return !(finished && final_status == AdSearchStatus_Error);
+    }
+
+    started = true;
+
+    if (ld() == NULL) {
+        finish(AdSearchStatus_Error);
+
+        return false;
+    }
+
+    // NOTE: collect responses to releases of previously
+    // cancelled searches, so they don't pile up
+    ad->d->collect_releases();
+
+    const bool send_success = send_request();
+    if (!send_success) {
+        finish(AdSearchStatus_Error);
+
+        return false;
+    }
+
+    return true;
+}
+
+AdSearchStatus AdSearchPrivate::next(AdObject *object, const int timeout) {
+    if (finished) {
+        return final_status;
+    }
+
+    const bool start_success = start();
+    if (!start_success) {
+        return finish(AdSearchStatus_Error);
+    }
+
+    // NOTE: if multiple searches are in progress and one
+    // of them reconnected, then requests of others were
+    // lost together with the old connection. Resend if
+    // possible, otherwise waiting on new connection would
+    // never end.
+    if (request_ld != ld()) {
+        msgid = -1;
+
+        const bool resend_success = (can_retry() && ld() != NULL && send_request());
+        if (!resend_success) {
+            return finish(AdSearchStatus_Error);
+        }
+    }
+
+    struct timeval timeout_timeval;
+    timeout_timeval.tv_sec = timeout / 1000;
+    timeout_timeval.tv_usec = (timeout % 1000) * 1000;
+    struct timeval *timeout_ptr = (timeout >= 0) ? &timeout_timeval : NULL;
+
+    while (true) {
+        LDAPMessage *message = NULL;
+        const int message_type = ldap_result(ld(), msgid, LDAP_MSG_ONE, timeout_ptr, &message);
+
+        if (message_type == 0 && timeout_ptr != NULL) {
+            ldap_msgfree(message);
+
+            return AdSearchStatus_Timeout;
+        }
+
+        if (message_type == -1 || message_type == 0) {
+            ldap_msgfree(message);
+
+            const bool connection_lost = (ad->d->get_ldap_result() == LDAP_SERVER_DOWN);
+            if (connection_lost && can_retry()) {
+                msgid = -1;
+
+                const bool retry_success = (ad->d->reconnect() && send_request());
+                if (retry_success) {
+                    continue;
+                }
+            }
+
+            qDebug() << "Error in ldap_result: " << ldap_err2string(ad->d->get_ldap_result());
+
+            msgid = -1;
+
+            return finish(AdSearchStatus_Error);
+        }
+
+        switch (message_type) {
+            case LDAP_RES_SEARCH_ENTRY: {
+                load_object_from_entry(ld(), message, &arena, object);
+                ldap_msgfree(message);
+
+                received_entries = true;
+
+                return AdSearchStatus_Entry;
+            }
+            case LDAP_RES_SEARCH_RESULT: {
+                return process_page_result(message);
+            }
+            default: {
+                // NOTE: referrals are turned off, so
+                // references are skipped
+                ldap_msgfree(message);
+
+                break;
+            }
+        }
+    }
+}
+
+void AdSearchPrivate::cancel() {
+    if (finished) {
+        return;
+    }
+
+    // NOTE: if connection was replaced, requests sent on
+    // the old one are gone together with it
+    const bool connection_is_same = (request_ld != NULL && request_ld == ld());
+
+    if (connection_is_same) {
+        if (msgid != -1) {
+            ldap_abandon_ext(ld(), msgid, NULL, NULL);
+        }
+
+        release_cookie();
+    }
+
+    msgid = -1;
+
+    finish(AdSearchStatus_Finished);
+}
+
+// NOTE: abandoning a request doesn't free the state that
+// server keeps for the paged search. To free it, need to
+// send the same search, with the same controls, page size
+// of 0 and current cookie. Response is not waited for, so
+// that cancelling doesn't block the caller. It's collected
+// later by AdInterface.
+void AdSearchPrivate::release_cookie() {
+    if (cookie == NULL || cookie->bv_len == 0) {
+        return;
+    }
+
+    QList<LDAPControl *> control_list;
+    const int release_page_size = 0;
+    const bool create_success = create_controls(release_page_size, &control_list);
+
+    if (create_success) {
+        QVector<LDAPControl *> server_control_list = control_list.toVector();
+        server_control_list.append(NULL);
+        LDAPControl **server_controls = server_control_list.data();
+
+        const char *filter_cstr = filter.isEmpty() ? NULL : filter.constData();
+        char **attributes_cstr = attributes_array.isEmpty() ? NULL : attributes_array.data();
+
+        const int attrsonly = 0;
+        int release_msgid;
+        const int result = ldap_search_ext(ld(), base.constData(), scope, filter_cstr, attributes_cstr, attrsonly, server_controls, NULL, NULL, LDAP_NO_LIMIT, &release_msgid);
+
+        if (result == LDAP_SUCCESS) {
+            ad->d->release_msgid_list.append(release_msgid);
+        } else {
+            qDebug() << "Failed to release paged search: " << ldap_err2string(result);
+        }
+
+        for (LDAPControl *control : control_list) {
+            ldap_control_free(control);
+        }
+    }
+
+    ber_bvfree(cookie);
+    cookie = NULL;
+}
+
+LDAP *AdSearchPrivate::ld() const {
+    return ad->d->ld;
+}
+
+// Creates server controls of the search, with page
+// control of given size and current cookie. On success,
+// caller needs to free the controls.
+bool AdSearchPrivate::create_controls(const int request_page_size, QList<LDAPControl *> *out) {
+    LDAPControl *page_control = NULL;
+    LDAPControl *sd_control = NULL;
+    LDAPSortKey **sort_key_list = NULL;
+    LDAPControl *sort_control = NULL;
+    LDAPControl *show_deleted_control = NULL;
+    LDAPControl *notify_control = NULL;
+
+    auto cleanup = [&]() {
+        ldap_control_free(page_control);
+        ldap_control_free(sd_control);
+        ldap_free_sort_keylist(sort_key_list);
+        ldap_control_free(sort_control);
+        ldap_control_free(show_deleted_control);
+        ldap_control_free(notify_control);
+    };
+
+    const int is_critical = 1;
+
+    int result;
+
+    // NOTE: notification requests allow only a limited set
+    // of controls, so they don't get sd control. They also
+    // can't be paged, since they never finish.
+    if (notify) {
+        result = ldap_control_create(LDAP_SERVER_NOTIFICATION_OID, is_critical, NULL, 0, &notify_control);
+        if (result != LDAP_SUCCESS) {
+            qDebug() << "Failed to create notification control: " << ldap_err2string(result);
+
+            cleanup();
+            return false;
+        }
+    } else {
+        result = create_sd_control(get_sacl, is_critical, &sd_control);
+        if (result != LDAP_SUCCESS) {
+            qDebug() << "Failed to create sd control: " << ldap_err2string(result);
+
+            cleanup();
+            return false;
+        }
+
+        result = ldap_create_page_control(ld(), request_page_size, cookie, is_critical, &page_control);
+        if (result != LDAP_SUCCESS) {
+            qDebug() << "Failed to create page control: " << ldap_err2string(result);
+
+            cleanup();
+            return false;
+        }
+    }
+
+    // NOTE: sort control is not critical, so that if
+    // server can't sort by given keys (for example, too
+    // many results without an index) it still returns
+    // unsorted results instead of failing the search
+    const bool sort_is_supported = [&]() {
+        AdConfig *adconfig = ad->adconfig();
+
+        return (!sort_keys.isEmpty() && adconfig != nullptr && adconfig->control_is_supported(LDAP_SERVER_SORT_OID));
+    }();
+    if (sort_is_supported) {
+        const int sort_is_critical = 0;
+
+        result = ldap_create_sort_keylist(&sort_key_list, sort_keys.data());
+        if (result == LDAP_SUCCESS) {
+            result = ldap_create_sort_control(ld(), sort_key_list, sort_is_critical, &sort_control);
+        }
+        if (result != LDAP_SUCCESS) {
+            qDebug() << "Failed to create sort control: " << ldap_err2string(result);
+
+            cleanup();
+            return false;
+        }
+    }
+
+    // NOTE: without this control, notifications are not
+    // sent for deleted objects
+    if (show_deleted || notify) {
+        result = ldap_control_create(LDAP_SERVER_SHOW_DELETED_OID, is_critical, NULL, 0, &show_deleted_control);
+        if (result != LDAP_SUCCESS) {
+            qDebug() << "Failed to create show deleted control: " << ldap_err2string(result);
+
+            cleanup();
+            return false;
+        }
+    }
+
+    ldap_free_sort_keylist(sort_key_list);
+
+    // NOTE: optional controls may be NULL, so only add
+    // the ones that were created
+    out->clear();
+    for (LDAPControl *control : {page_control, notify_control, sd_control, sort_control, show_deleted_control}) {
+        if (control != NULL) {
+            out->append(control);
+        }
+    }
+
+    return true;
+}
+
+bool AdSearchPrivate::send_request() {
+    QList<LDAPControl *> control_list;
+    const bool create_success = create_controls(page_size, &control_list);
+    if (!create_success) {
+        return false;
+    }
+
+    auto cleanup = [&]() {
+        for (LDAPControl *control : control_list) {
+            ldap_control_free(control);
+        }
+    };
+
+    QVector<LDAPControl *> server_control_list = control_list.toVector();
+    server_control_list.append(NULL);
+    LDAPControl **server_controls = server_control_list.data();
+
+    // NOTE: need to pass NULL instead of empty string to
+    // denote "no filter"
+    const char *filter_cstr = filter.isEmpty() ? NULL : filter.constData();
+    char **attributes_cstr = attributes_array.isEmpty() ? NULL : attributes_array.data();
+
+    const int attrsonly = 0;
+    int result = ldap_search_ext(ld(), base.constData(), scope, filter_cstr, attributes_cstr, attrsonly, server_controls, NULL, NULL, LDAP_NO_LIMIT, &msgid);
+
+    // NOTE: pooled connection could've been dropped by
+    // the server while it was idle. In that case, rebind
+    // and retry once.
+    if (result == LDAP_SERVER_DOWN && can_retry() && ad->d->reconnect()) {
+        result = ldap_search_ext(ld(), base.constData(), scope, filter_cstr, attributes_cstr, attrsonly, server_controls, NULL, NULL, LDAP_NO_LIMIT, &msgid);
+    }
+
+    cleanup();
+
+    if (result != LDAP_SUCCESS) {
+        qDebug() << "Error in ldap_search_ext: " << ldap_err2string(result);
+
+        msgid = -1;
+
+        return false;
+    }
+
+    request_ld = ld();
+    page_timer.start();
+    arena.start_page();
+
+    return true;
+}
+
+// NOTE: can only retry the first page, because cookies
+// for next pages are tied to the connection that was
+// lost. Also can't retry if some entries were already
+// given out, since they would be received again.
+bool AdSearchPrivate::can_retry() const {
+    return (cookie == NULL && !received_entries);
+}
+
+AdSearchStatus AdSearchPrivate::finish(const AdSearchStatus status) {
+    finished = true;
+    final_status = status;
+
+    return status;
+}
+
+AdSearchStatus AdSearchPrivate::process_page_result(LDAPMessage *message) {
+    int errcode;
+    LDAPControl **returned_controls = NULL;
+
+    // NOTE: message is freed by this call
+    const int freeit = 1;
+    int result = ldap_parse_result(ld(), message, &errcode, NULL, NULL, NULL, &returned_controls, freeit);
+
+    msgid = -1;
+
+    if (result != LDAP_SUCCESS) {
+        qDebug() << "Failed to parse result: " << ldap_err2string(result);
+
+        ldap_controls_free(returned_controls);
+
+        return finish(AdSearchStatus_Error);
+    }
+
+    if ((errcode != LDAP_SUCCESS) && (errcode != LDAP_PARTIAL_RESULTS)) {
+        // NOTE: it's not really an error for an object to
+        // not exist. For example, sometimes it's needed to
+        // check whether an object exists. Not sure how to
+        // distinguish this error type from others
+        if (errcode != LDAP_NO_SUCH_OBJECT) {
+            qDebug() << "Error in paged search: " << ldap_err2string(errcode);
+        }
+
+        ldap_controls_free(returned_controls);
+
+        return finish(AdSearchStatus_Error);
+    }
+
+    // Get page response control
+    //
+    // NOTE: not sure if absence of page response control is
+    // an error. Decided to not treat it as error because
+    // searching the rootDSE doesn't return this control.
+    struct berval new_cookie;
+    new_cookie.bv_len = 0;
+    new_cookie.bv_val = NULL;
+
+    LDAPControl *pageresponse_control = ldap_control_find(LDAP_CONTROL_PAGEDRESULTS, returned_controls, NULL);
+    if (pageresponse_control != NULL) {
+        ber_int_t total_count;
+        result = ldap_parse_pageresponse_control(ld(), pageresponse_control, &total_count, &new_cookie);
+        if (result != LDAP_SUCCESS) {
+            qDebug() << "Failed to parse pageresponse control: " << ldap_err2string(result);
+
+            ldap_controls_free(returned_controls);
+
+            return finish(AdSearchStatus_Error);
+        }
+    }
+
+    ldap_controls_free(returned_controls);
+
+    // NOTE: there are more pages if the cookie isn't
+    // empty
+    const bool more_pages = (new_cookie.bv_len > 0);
+
+    ber_bvfree(cookie);
+    cookie = NULL;
+
+    if (more_pages) {
+        cookie = ber_bvdup(&new_cookie);
+    }
+
+    ber_memfree(new_cookie.bv_val);
+
+    if (!more_pages) {
+        return finish(AdSearchStatus_Finished);
+    }
+
+    if (AdInterfacePrivate::s_adaptive_page_size) {
+        update_page_size();
+    }
+
+    // NOTE: request next page before returning, so that
+    // the server works on it while caller processes the
+    // page that just finished
+    const bool send_success = send_request();
+    if (!send_success) {
+        return finish(AdSearchStatus_Error);
+    }
+
+    return AdSearchStatus_PageDone;
+}
+
+// Page size can't go over the server limit, otherwise
+// server silently truncates pages to it's limit
+int AdSearchPrivate::max_page_size() const {
+    const int server_max = [&]() {
+        if (AdInterfacePrivate::adconfig != nullptr) {
+            return AdInterfacePrivate::adconfig->max_page_size();
+        } else {
+            return AdInterfacePrivate::s_page_size;
+        }
+    }();
+
+    const int out = std::min(AdInterfacePrivate::s_page_size, server_max);
+
+    return std::max(out, 1);
+}
+
+// NOTE: latency is measured from sending the request to
+// receiving the result of the page, which includes the
+// time it took the server to prepare the page and the
+// time to transfer it
+void AdSearchPrivate::update_page_size() {
+    const qint64 latency = page_timer.elapsed();
+
+    if (latency < ADAPTIVE_GROW_LATENCY) {
+        page_size = std::min(page_size * 2, max_page_size());
+    } else if (latency > ADAPTIVE_SHRINK_LATENCY) {
+        page_size = std::max(page_size / 2, std::min(ADAPTIVE_FIRST_PAGE_SIZE, max_page_size()));
+    }
+}
+
+void AdSearchPrivate::log_search(const QString &base_string, const SearchScope scope_enum, const QString &filter_string, const QList<QString> &attributes) {
+    if (!AdInterfacePrivate::s_log_searches) {
+        return;
+    }
+
+    const QString attributes_string = "{" + attributes.join(",") + "}";
+
+    const QString scope_string = [&]() -> QString {
+        switch (scope_enum) {
+            case SearchScope_Object: return "object";
+            case SearchScope_Children: return "children";
+            case SearchScope_Descendants: return "descendants";
+            case SearchScope_All: return "all";
+            default: break;
+        }
+        return QString();
+    }();
+
+    ad->d->success_message(QString(AdInterface::tr("Search:\n\tfilter = \"%1\"\n\tattributes = %2\n\tscope = \"%3\"\n\tbase = \"%4\"")).arg(filter_string, attributes_string, scope_string, base_string));
+}
+
+// NOTE: attribute names and values are read straight out
+// of the entry's BER buffer, without intermediate copies.
+// Values are then copied once, into the arena.
+void load_object_from_entry(LDAP *ld, LDAPMessage *entry, AdValueArena *arena, AdObject *object) {
+    BerElement *ber = NULL;
+    struct berval dn_berval;
+
+    const int get_dn_result = ldap_get_dn_ber(ld, entry, &ber, &dn_berval);
+    if (get_dn_result != LDAP_SUCCESS) {
+        qDebug() << "Failed to get entry dn: " << ldap_err2string(get_dn_result);
+
+        ber_free(ber, 0);
+        *object = AdObject();
+
+        return;
+    }
+
+    const QString dn = QString::fromUtf8(dn_berval.bv_val, dn_berval.bv_len);
+
+    class EntryAttribute {
+    public:
+        int attribute_id;
+        struct berval *values;
+    };
+
+    QVector<EntryAttribute> attribute_list;
+    int total_size = 0;
+
+    while (true) {
+        struct berval attribute_berval;
+        struct berval *values = NULL;
+
+        const int get_attribute_result = ldap_get_attribute_ber(ld, entry, ber, &attribute_berval, &values);
+        if (get_attribute_result != LDAP_SUCCESS || attribute_berval.bv_val == NULL) {
+            ber_memfree(values);
+
+            break;
+        }
+
+        const QByteArray attribute_bytes = QByteArray::fromRawData(attribute_berval.bv_val, attribute_berval.bv_len);
+        const int attribute_id = ad_attribute_id(attribute_bytes);
+
+        if (values != NULL) {
+            for (int i = 0; values[i].bv_val != NULL; i++) {
+                total_size += values[i].bv_len;
+            }
+        }
+
+        attribute_list.append({attribute_id, values});
+    }
+
+    QSharedPointer<AdValueChunk> chunk = arena->reserve(total_size);
+    QVector<AdValueRef> ref_list;
+
+    for (const EntryAttribute &attribute : attribute_list) {
+        if (attribute.values == NULL || attribute.values[0].bv_val == NULL) {
+            ref_list.append({attribute.attribute_id, 0, -1});
+        } else {
+            for (int i = 0; attribute.values[i].bv_val != NULL; i++) {
+                const struct berval &value = attribute.values[i];
+
+                memcpy(chunk->data + chunk->size, value.bv_val, value.bv_len);
+                ref_list.append({attribute.attribute_id, chunk->size, (int) value.bv_len});
+                chunk->size += value.bv_len;
+            }
+        }
+
+        ber_memfree(attribute.values);
+    }
+
+    ber_free(ber, 0);
+
+    std::stable_sort(ref_list.begin(), ref_list.end(),
+        [](const AdValueRef &a, const AdValueRef &b) {
+            return a.attribute_id < b.attribute_id;
+        });
+
+    object->load(dn, chunk, ref_list);
+}
+
+int ldap_scope_from_search_scope(const SearchScope scope) {
+    switch (scope) {
+        case SearchScope_Object: return LDAP_SCOPE_BASE;
+        case SearchScope_Children: return LDAP_SCOPE_ONELEVEL;
+        case SearchScope_All: return LDAP_SCOPE_SUBTREE;
+        case SearchScope_Descendants: return LDAP_SCOPE_CHILDREN;
+    }
+    return 0;
+}
+
+AdVlvSearch::AdVlvSearch(AdInterface &ad, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const QString &sort_attribute) {
+    d = new AdVlvSearchPrivate();
+
+    d->ad = &ad;
+    d->base = base.toUtf8();
+    d->scope = ldap_scope_from_search_scope(scope);
+    d->filter = filter.toUtf8();
+    d->sort_attribute = sort_attribute.toUtf8();
+    d->context = NULL;
+    d->offset = 0;
+    d->count = 0;
+
+    for (const QString &attribute : attributes) {
+        d->attribute_list.append(attribute.toUtf8());
+    }
+    for (QByteArray &attribute : d->attribute_list) {
+        d->attributes_array.append(attribute.data());
+    }
+    if (!d->attributes_array.isEmpty()) {
+        d->attributes_array.append(NULL);
+    }
+}
+
+AdVlvSearch::~AdVlvSearch() {
+    ber_bvfree(d->context);
+
+    delete d;
+}
+
+bool AdVlvSearch::get_window(const int offset, const int size, QList<AdObject> *out) {
+    return d->search(offset, QString(), size, out);
+}
+
+bool AdVlvSearch::seek(const QString &value, const int size, QList<AdObject> *out) {
+    return d->search(0, value, size, out);
+}
+
+int AdVlvSearch::offset() const {
+    return d->offset;
+}
+
+int AdVlvSearch::count() const {
+    return d->count;
+}
+
+LDAP *AdVlvSearchPrivate::ld() const {
+    return ad->d->ld;
+}
+
+// NOTE: window is requested as a target entry plus a
+// number of entries after it. Target is either given by
+// offset or by assertion value, when seeking.
+bool AdVlvSearchPrivate::search(const int offset_arg, const QString &value, const int size, QList<AdObject> *out) {
+    out->clear();
+
+    if (ld() == NULL || size <= 0) {
+        return false;
+    }
+
+    const QByteArray value_bytes = value.toUtf8();
+    struct berval value_berval;
+    value_berval.bv_val = (char *) value_bytes.constData();
+    value_berval.bv_len = value_bytes.size();
+
+    LDAPSortKey **sort_key_list = NULL;
+    LDAPControl *sort_control = NULL;
+    LDAPControl *vlv_control = NULL;
+    LDAPMessage *res = NULL;
+    LDAPControl **returned_controls = NULL;
+
+    auto cleanup = [&]() {
+        ldap_free_sort_keylist(sort_key_list);
+        ldap_control_free(sort_control);
+        ldap_control_free(vlv_control);
+        ldap_controls_free(returned_controls);
+        ldap_msgfree(res);
+    };
+
+    const int is_critical = 1;
+
+    int result = ldap_create_sort_keylist(&sort_key_list, sort_attribute.data());
+    if (result == LDAP_SUCCESS) {
+        result = ldap_create_sort_control(ld(), sort_key_list, is_critical, &sort_control);
+    }
+    if (result != LDAP_SUCCESS) {
+        qDebug() << "Failed to create sort control: " << ldap_err2string(result);
+
+        cleanup();
+        return false;
+    }
+
+    // NOTE: offsets in the control start from 1. Content
+    // count of 0 tells the server to treat offset as
+    // absolute position.
+    LDAPVLVInfo vlv_info;
+    vlv_info.ldvlv_version = 1;
+    vlv_info.ldvlv_before_count = 0;
+    vlv_info.ldvlv_after_count = size - 1;
+    vlv_info.ldvlv_offset = offset_arg + 1;
+    vlv_info.ldvlv_count = 0;
+    vlv_info.ldvlv_attrvalue = value.isEmpty() ? NULL : &value_berval;
+    vlv_info.ldvlv_context = context;
+    vlv_info.ldvlv_extradata = NULL;
+
+    result = ldap_create_vlv_control(ld(), &vlv_info, &vlv_control);
+    if (result != LDAP_SUCCESS) {
+        qDebug() << "Failed to create vlv control: " << ldap_err2string(result);
+
+        cleanup();
+        return false;
+    }
+
+    LDAPControl *server_controls[3] = {sort_control, vlv_control, NULL};
+
+    const char *filter_cstr = filter.isEmpty() ? NULL : filter.constData();
+    char **attributes_cstr = attributes_array.isEmpty() ? NULL : attributes_array.data();
+
+    const int attrsonly = 0;
+    result = ldap_search_ext_s(ld(), base.constData(), scope, filter_cstr, attributes_cstr, attrsonly, server_controls, NULL, NULL, LDAP_NO_LIMIT, &res);
+
+    if (result == LDAP_SERVER_DOWN && ad->d->reconnect()) {
+        ldap_msgfree(res);
+        res = NULL;
+
+        result = ldap_search_ext_s(ld(), base.constData(), scope, filter_cstr, attributes_cstr, attrsonly, server_controls, NULL, NULL, LDAP_NO_LIMIT, &res);
+    }
+
+    if (result != LDAP_SUCCESS) {
+        qDebug() << "Error in vlv search: " << ldap_err2string(result);
+
+        cleanup();
+        return false;
+    }
+
+    AdValueArena arena;
+    arena.start_page();
+
+    for (LDAPMessage *entry = ldap_first_entry(ld(), res); entry != NULL; entry = ldap_next_entry(ld(), entry)) {
+        AdObject object;
+        load_object_from_entry(ld(), entry, &arena, &object);
+
+        out->append(object);
+    }
+
+    int errcode;
+    const int freeit = 0;
+    result = ldap_parse_result(ld(), res, &errcode, NULL, NULL, NULL, &returned_controls, freeit);
+    if (result != LDAP_SUCCESS || errcode != LDAP_SUCCESS) {
+        qDebug() << "Error in vlv search result: " << ldap_err2string(result != LDAP_SUCCESS ? result : errcode);
+
+        out->clear();
+        cleanup();
+        return false;
+    }
+
+    LDAPControl *vlvresponse_control = ldap_control_find(LDAP_CONTROL_VLVRESPONSE, returned_controls, NULL);
+    if (vlvresponse_control == NULL) {
+        qDebug() << "Vlv search didn't return vlv response control";
+
+        out->clear();
+        cleanup();
+        return false;
+    }
+
+    ber_int_t target_position;
+    ber_int_t list_count;
+    struct berval *new_context = NULL;
+    ber_int_t vlv_errcode;
+    result = ldap_parse_vlvresponse_control(ld(), vlvresponse_control, &target_position, &list_count, &new_context, &vlv_errcode);
+    if (result != LDAP_SUCCESS || vlv_errcode != LDAP_SUCCESS) {
+        qDebug() << "Failed to parse vlv response control: " << ldap_err2string(result != LDAP_SUCCESS ? result : vlv_errcode);
+
+        ber_bvfree(new_context);
+        out->clear();
+        cleanup();
+        return false;
+    }
+
+    ber_bvfree(context);
+    context = new_context;
+
+    offset = std::max(0, (int) target_position - 1);
+    count = list_count;
+
+    cleanup();
+
+    return true;
+}
@@ -0,0 +1,153 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AD_SEARCH_H
+#define AD_SEARCH_H
+
+/**
+ * Asynchronous paged search. Entries are received one at
+ * a time as they arrive from the server, instead of
+ * waiting for the whole page. When a page is done,
+ * request for the next page is sent right away, so that
+ * the server prepares it while the client is processing
+ * the current one.
+ *
+ * Search uses the connection of the AdInterface it was
+ * created with, so it must not outlive it and must be
+ * used from the same thread.
+ */
+
+#include "ad_defines.h"
+
+#include <QList>
+#include <QString>
+
+class AdInterface;
+class AdObject;
+class AdSearchPrivate;
+class AdVlvSearchPrivate;
+
+enum AdSearchStatus {
+    // Received an entry, it was loaded into the object
+    AdSearchStatus_Entry,
+    // Page is done and next page was requested
+    AdSearchStatus_PageDone,
+    // Last page is done
+    AdSearchStatus_Finished,
+    AdSearchStatus_Error,
+    // Nothing arrived within given timeout, search is
+    // still in progress
+    AdSearchStatus_Timeout,
+};
+
+class AdSearch {
+
+public:
+    // NOTE: If request attributes list is empty, all
+    // attributes are returned
+    AdSearch(AdInterface &ad, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const bool get_sacl = false);
+    ~AdSearch();
+
+    // Asks the server to return results sorted by given
+    // keys. Key format is "attribute" for ascending order
+    // and "-attribute" for descending. Must be called
+    // before the search is started. Sort is only requested
+    // if the server supports it, otherwise results come
+    // unsorted, so callers still need to be able to
+    // handle any order.
+    void set_sort_keys(const QList<QString> &key_list);
+
+    // Includes deleted objects (tombstones) in results.
+    // Tombstones keep only a few attributes, like
+    // lastKnownParent. Must be called before the search is
+    // started.
+    void set_show_deleted(const bool show_deleted);
+
+    // Turns search into a change notification request.
+    // Instead of current objects, server sends objects as
+    // they are changed, for as long as search is running.
+    // Deleted objects are included as tombstones. Server
+    // requires filter to be empty and scope to be either
+    // children or, for the root of a naming context, all.
+    // Check that server supports the control before using
+    // this, see AdConfig::control_is_supported().
+    void set_notify(const bool notify);
+
+    // Sends the request without waiting for results. This
+    // is optional, first call of next() sends the request
+    // if it wasn't sent yet. Use this to send multiple
+    // searches at once and then wait for all of them.
+    bool start();
+
+    // Waits for the next result from the server. First
+    // call sends the request. Timeout is in msecs,
+    // negative timeout waits for as long as needed.
+    AdSearchStatus next(AdObject *object, const int timeout = -1);
+
+    // Stops search that is in progress. Request that is
+    // being processed is abandoned and paged results
+    // state held by the server is released, so the server
+    // stops working on the search right away. After this,
+    // next() returns AdSearchStatus_Finished. Search is
+    // also cancelled when it's destroyed before finishing.
+    void cancel();
+
+private:
+    AdSearchPrivate *d;
+};
+
+/**
+ * Browses sorted results of a search one window at a
+ * time, using server side sort and virtual list view
+ * controls. Only the requested window is transferred, so
+ * results of any size can be browsed in constant memory
+ * and time. Check that server supports both controls
+ * before using this, see AdConfig::control_is_supported().
+ *
+ * Same as AdSearch, must not outlive the AdInterface it
+ * was created with.
+ */
+
+class AdVlvSearch {
+
+public:
+    AdVlvSearch(AdInterface &ad, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const QString &sort_attribute);
+    ~AdVlvSearch();
+
+    // Gets window of given size which starts at given
+    // offset. Offsets start from 0.
+    bool get_window(const int offset, const int size, QList<AdObject> *out);
+
+    // Gets window of given size which starts at the first
+    // object whose sort attribute is greater than or equal
+    // to given value. Use to seek by first letters.
+    bool seek(const QString &value, const int size, QList<AdObject> *out);
+
+    // Offset of the first object of the last window
+    int offset() const;
+
+    // Total amount of results, as estimated by the server
+    int count() const;
+
+private:
+    AdVlvSearchPrivate *d;
+};
+
+#endif /* AD_SEARCH_H */
@@ -31,6 +31,8 @@
 
 #include <QDebug>
 
+#include <cstddef>
+
 #define UNUSED_ARG(x) (void) (x)
 
 QByteArray dom_sid_to_bytes(const dom_sid &sid);
@@ -41,6 +43,10 @@ QList<security_ace> security_descriptor_get_dacl(const security_descriptor *sd);
 void ad_security_replace_dacl(security_descriptor *sd, const QList<security_ace> &new_dacl);
 uint32_t ad_security_map_access_mask(const uint32_t access_mask);
 int ace_compare_simplified(const security_ace &ace1, const security_ace &ace2);
+QByteArray dom_sid_key(const dom_sid &sid);
+QByteArray ace_get_object_type(const security_ace &ace);
+QByteArray ace_get_inherited_object_type(const security_ace &ace);
+SecurityRightStateInherited ace_get_inherited(const security_ace &ace);
 
 // NOTE: these "base" f-ns are used by the full
 // versions of add/remove right f-ns. Base f-ns do only
@@ -204,40 +210,7 @@ QString ad_security_get_well_known_trustee_name(const QByteArray &trustee) {
 }
 
 QString ad_security_get_trustee_name(AdInterface &ad, const QByteArray &trustee) {
-    const QString trustee_string = object_sid_display_value(trustee);
-
-    if (trustee_name_map.contains(trustee_string)) {
-        return trustee_name_map[trustee_string];
-    } else {
-        // Try to get name of trustee by finding it's DN
-        const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_SID, trustee_string);
-        const QList<QString> attributes = {
-            ATTRIBUTE_DISPLAY_NAME,
-            ATTRIBUTE_SAM_ACCOUNT_NAME,
-        };
-        const auto trustee_search = ad.search(ad.adconfig()->domain_dn(), SearchScope_All, filter, QList<QString>());
-        if (!trustee_search.isEmpty()) {
-            // NOTE: this is some weird name selection logic
-            // but that's how microsoft does it. Maybe need
-            // to use this somewhere else as well?
-            const QString name = [&]() {
-                const AdObject object = trustee_search.values()[0];
-
-                if (object.contains(ATTRIBUTE_DISPLAY_NAME)) {
-                    return object.get_string(ATTRIBUTE_DISPLAY_NAME);
-                } else if (object.contains(ATTRIBUTE_SAM_ACCOUNT_NAME)) {
-                    return object.get_string(ATTRIBUTE_SAM_ACCOUNT_NAME);
-                } else {
-                    return dn_get_name(object.get_dn());
-                }
-            }();
-
-            return name;
-        } else {
-            // Return raw sid as last option
-            return trustee_string;
-        }
-    }
+    return AdSidResolver::get_name(ad, trustee);
 }
 
 bool ad_security_replace_security_descriptor(AdInterface &ad, const QString &dn, security_descriptor *new_sd) {
@@ -265,6 +238,55 @@ QByteArray dom_sid_to_bytes(const dom_sid &sid) {
     return bytes;
 }
 
+// Returns only the significant bytes of sid, so that
+// equal sid's always have equal keys, regardless of
+// padding
+QByteArray dom_sid_key(const dom_sid &sid) {
+    const int num_auths = qBound(0, (int) sid.num_auths, 15);
+    const int size = offsetof(dom_sid, sub_auths) + num_auths * sizeof(uint32_t);
+    const QByteArray out = QByteArray((char *) &sid, size);
+
+    return out;
+}
+
+// NOTE: object ACE's may omit the object type, in which
+// case the union doesn't contain it and the ACE applies
+// to all object types. Returns empty bytes for such
+// ACE's and for ACE's that aren't object ACE's.
+QByteArray ace_get_object_type(const security_ace &ace) {
+    const bool type_present = (ace_types_with_object.contains(ace.type) && bitmask_is_set(ace.object.object.flags, SEC_ACE_OBJECT_TYPE_PRESENT));
+    if (!type_present) {
+        return QByteArray();
+    }
+
+    const GUID guid = ace.object.object.type.type;
+    const QByteArray out = QByteArray((char *) &guid, sizeof(GUID));
+
+    return out;
+}
+
+QByteArray ace_get_inherited_object_type(const security_ace &ace) {
+    const bool type_present = (ace_types_with_object.contains(ace.type) && bitmask_is_set(ace.object.object.flags, SEC_ACE_INHERITED_OBJECT_TYPE_PRESENT));
+    if (!type_present) {
+        return QByteArray();
+    }
+
+    const GUID guid = ace.object.object.inherited_type.inherited_type;
+    const QByteArray out = QByteArray((char *) &guid, sizeof(GUID));
+
+    return out;
+}
+
+SecurityRightStateInherited ace_get_inherited(const security_ace &ace) {
+    const bool ace_is_inherited = bitmask_is_set(ace.flags, SEC_ACE_FLAG_INHERITED_ACE);
+
+    if (ace_is_inherited) {
+        return SecurityRightStateInherited_Yes;
+    } else {
+        return SecurityRightStateInherited_No;
+    }
+}
+
 // Copy sid bytes into dom_sid struct and adds padding
 // if necessary
 dom_sid dom_sid_from_bytes(const QByteArray &bytes) {
@@ -461,25 +483,23 @@ SecurityRightState security_descriptor_get_right(const security_descriptor *sd,
         }
     }
 
-    const QList<security_ace> dacl = security_descriptor_get_dacl(sd);
+    const dom_sid trustee_sid = dom_sid_from_bytes(trustee);
 
-    for (const security_ace &ace : dacl) {
-        const bool match = [&]() {
-            const bool trustee_match = [&]() {
-                const dom_sid trustee_sid = dom_sid_from_bytes(trustee);
-                const bool trustees_are_equal = (dom_sid_compare(&ace.trustee, &trustee_sid) == 0);
+    // NOTE: go over DACL in place instead of copying it,
+    // this f-n is called often
+    for (size_t i = 0; i < sd->dacl->num_aces; i++) {
+        const security_ace &ace = sd->dacl->aces[i];
 
-                return trustees_are_equal;
-            }();
+        const bool match = [&]() {
+            const bool trustee_match = (dom_sid_compare(&ace.trustee, &trustee_sid) == 0);
 
             const bool access_mask_match = bitmask_is_set(ace.access_mask, access_mask);
 
             const bool object_match = [&]() {
-                const bool object_present = ace_types_with_object.contains(ace.type);
+                const QByteArray ace_object_type = ace_get_object_type(ace);
+                const bool object_present = !ace_object_type.isEmpty();
 
                 if (object_present) {
-                    const GUID out_guid = ace.object.object.type.type;
-                    const QByteArray ace_object_type = QByteArray((char *) &out_guid, sizeof(GUID));
                     const bool types_are_equal = (ace_object_type == object_type);
 
                     return types_are_equal;
@@ -509,15 +529,7 @@ SecurityRightState security_descriptor_get_right(const security_descriptor *sd,
             state_list[SecurityRightStateType_Allow] = ace_type_allow_set.contains(ace.type);
             state_list[SecurityRightStateType_Deny] = ace_type_deny_set.contains(ace.type);
 
-            const int inherit_i = [&]() {
-                const bool ace_is_inherited = bitmask_is_set(ace.flags, SEC_ACE_FLAG_INHERITED_ACE);
-
-                if (ace_is_inherited) {
-                    return SecurityRightStateInherited_Yes;
-                } else {
-                    return SecurityRightStateInherited_No;
-                }
-            }();
+            const int inherit_i = ace_get_inherited(ace);
 
             for (int type_i = 0; type_i < SecurityRightStateType_COUNT; type_i++) {
                 const bool right_state = state_list[type_i];
@@ -534,13 +546,122 @@ SecurityRightState security_descriptor_get_right(const security_descriptor *sd,
     return out;
 }
 
+SecurityRightMatrix::SecurityRightMatrix() {
+}
+
+SecurityRightMatrix::SecurityRightMatrix(const security_descriptor *sd) {
+    load(sd, false, QList<QByteArray>());
+}
+
+SecurityRightMatrix::SecurityRightMatrix(const security_descriptor *sd, const QList<QByteArray> &class_guid_list) {
+    load(sd, true, class_guid_list);
+}
+
+void SecurityRightMatrix::load(const security_descriptor *sd, const bool effective, const QList<QByteArray> &class_guid_list) {
+    if (sd == nullptr || sd->dacl == nullptr) {
+        return;
+    }
+
+    for (size_t i = 0; i < sd->dacl->num_aces; i++) {
+        const security_ace &ace = sd->dacl->aces[i];
+
+        if (effective) {
+            // NOTE: inherit only ACE's are only passed
+            // down to children and don't apply to the
+            // object itself
+            const bool inherit_only = bitmask_is_set(ace.flags, SEC_ACE_FLAG_INHERIT_ONLY);
+            if (inherit_only) {
+                continue;
+            }
+
+            // NOTE: ACE's scoped to a class, for example
+            // "Descendant User objects", apply only to
+            // objects of that class
+            const QByteArray inherited_object_type = ace_get_inherited_object_type(ace);
+            if (!inherited_object_type.isEmpty() && !class_guid_list.contains(inherited_object_type)) {
+                continue;
+            }
+        }
+
+        Ace matrix_ace;
+        matrix_ace.access_mask = ace.access_mask;
+        matrix_ace.inherited = ace_get_inherited(ace);
+
+        if (ace_type_allow_set.contains(ace.type)) {
+            matrix_ace.type = SecurityRightStateType_Allow;
+        } else if (ace_type_deny_set.contains(ace.type)) {
+            matrix_ace.type = SecurityRightStateType_Deny;
+        } else {
+            // NOTE: audit ace's don't affect rights
+            continue;
+        }
+
+        TrusteeAces &trustee_aces = trustee_map[dom_sid_key(ace.trustee)];
+
+        const QByteArray object_type = ace_get_object_type(ace);
+        const bool object_present = !object_type.isEmpty();
+        if (object_present) {
+            trustee_aces.object_map[object_type].append(matrix_ace);
+        } else {
+            trustee_aces.generic_list.append(matrix_ace);
+        }
+    }
+}
+
+SecurityRightState SecurityRightMatrix::get(const QByteArray &trustee, const uint32_t access_mask_arg, const QByteArray &object_type) const {
+    bool out_data[SecurityRightStateInherited_COUNT][SecurityRightStateType_COUNT];
+
+    for (int x = 0; x < SecurityRightStateInherited_COUNT; x++) {
+        for (int y = 0; y < SecurityRightStateType_COUNT; y++) {
+            out_data[x][y] = false;
+        }
+    }
+
+    const QByteArray trustee_key = dom_sid_key(dom_sid_from_bytes(trustee));
+    const auto trustee_it = trustee_map.find(trustee_key);
+
+    if (trustee_it != trustee_map.end()) {
+        const uint32_t access_mask = ad_security_map_access_mask(access_mask_arg);
+        const TrusteeAces &trustee_aces = trustee_it.value();
+
+        auto apply_ace_list = [&](const QList<Ace> &ace_list) {
+            for (const Ace &ace : ace_list) {
+                if (bitmask_is_set(ace.access_mask, access_mask)) {
+                    out_data[ace.inherited][ace.type] = true;
+                }
+            }
+        };
+
+        apply_ace_list(trustee_aces.generic_list);
+
+        const auto object_it = trustee_aces.object_map.find(object_type);
+        if (object_it != trustee_aces.object_map.end()) {
+            apply_ace_list(object_it.value());
+        }
+    }
+
+    const SecurityRightState out = SecurityRightState(out_data);
+
+    return out;
+}
+
 void security_descriptor_print(security_descriptor *sd, AdInterface &ad) {
     const QList<security_ace> dacl = security_descriptor_get_dacl(sd);
 
+    const QHash<QByteArray, QString> name_map = [&]() {
+        QList<QByteArray> trustee_list;
+
+        for (const security_ace &ace : dacl) {
+            trustee_list.append(dom_sid_to_bytes(ace.trustee));
+        }
+
+        return AdSidResolver::get_names(ad, trustee_list);
+    }();
+
     for (const security_ace &ace : dacl) {
         qInfo() << "\nace:";
         const QByteArray trustee_sid = dom_sid_to_bytes(ace.trustee);
-        const QString trustee_name = ad_security_get_trustee_name(ad, trustee_sid);
+        const QString trustee_name = name_map[trustee_sid];
         qInfo() << "trustee:" << trustee_name;
         qInfo() << "mask:" << int_to_hex_string(ace.access_mask);
         qInfo() << "type:" << ace.type;
@@ -29,6 +29,7 @@
 #include "ad_defines.h"
 
 #include <QByteArray>
+#include <QHash>
 #include <QLocale>
 
 class AdInterface;
@@ -69,6 +70,50 @@ public:
     QByteArray object_type;
 };
 
+// States of all rights of all trustees of a security
+// descriptor, evaluated in one pass over the DACL. Use
+// this instead of security_descriptor_get_right() when
+// getting states of many rights, for example when
+// displaying all rights of a trustee. Matrix doesn't
+// follow changes of the descriptor, so it needs to be
+// rebuilt after descriptor is edited.
+class SecurityRightMatrix {
+public:
+    SecurityRightMatrix();
+    SecurityRightMatrix(const security_descriptor *sd);
+
+    // Matrix of rights that are in effect on the object
+    // itself. Inherit only ACE's are skipped, as well as
+    // ACE's scoped to classes which are not in given
+    // list. Class list should contain schemaIDGUID's of
+    // all of object's classes.
+    SecurityRightMatrix(const security_descriptor *sd, const QList<QByteArray> &class_guid_list);
+
+    // Returns same state as security_descriptor_get_right()
+    SecurityRightState get(const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type) const;
+
+private:
+    class Ace {
+    public:
+        uint32_t access_mask;
+        SecurityRightStateInherited inherited;
+        SecurityRightStateType type;
+    };
+
+    // NOTE: ACE's without object type are kept
+    // separately because they match rights of any
+    // object type
+    class TrusteeAces {
+    public:
+        QList<Ace> generic_list;
+        QHash<QByteArray, QList<Ace>> object_map;
+    };
+
+    QHash<QByteArray, TrusteeAces> trustee_map;
+
+    void load(const security_descriptor *sd, const bool effective, const QList<QByteArray> &class_guid_list);
+};
+
 QString ad_security_get_well_known_trustee_name(const QByteArray &trustee);
 QString ad_security_get_trustee_name(AdInterface &ad, const QByteArray &trustee);
 bool ad_security_get_protected_against_deletion(const AdObject &object);
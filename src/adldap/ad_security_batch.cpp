@@ -0,0 +1,236 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ad_security_batch.h"
+
+#include "adldap.h"
+
+#include "samba/ndr_security.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <algorithm>
+
+// Max amount of objects changed at the same time. Each
+// worker holds a connection.
+#define SECURITY_BATCH_THREAD_MAX 4
+
+// Time in msecs between passing results to callback
+#define RESULTS_POLL_INTERVAL 100
+
+class AdSecurityBatchPrivate {
+public:
+    QList<QString> target_list;
+    QList<AdSecurityEdit> edit_list;
+
+    QAtomicInt stop_flag;
+    QAtomicInt next_index;
+    QAtomicInt done_count;
+
+    QMutex result_mutex;
+    QList<AdSecurityBatchResult> result_list;
+};
+
+class AdSecurityBatchWorker final : public QRunnable {
+public:
+    AdSecurityBatchWorker(AdSecurityBatchPrivate *d_arg);
+
+    void run() override;
+
+private:
+    AdSecurityBatchPrivate *d;
+
+    bool apply(AdInterface &ad, const QString &dn);
+};
+
+AdSecurityBatch::AdSecurityBatch(const QList<QString> &target_list, const QList<AdSecurityEdit> &edit_list) {
+    d = new AdSecurityBatchPrivate();
+
+    d->target_list = target_list;
+    d->edit_list = edit_list;
+    d->stop_flag = 0;
+    d->next_index = 0;
+    d->done_count = 0;
+}
+
+AdSecurityBatch::~AdSecurityBatch() {
+    delete d;
+}
+
+bool AdSecurityBatch::run(const std::function<bool(const AdSecurityBatchResult &result)> &callback) {
+    QThreadPool pool;
+    pool.setMaxThreadCount(SECURITY_BATCH_THREAD_MAX);
+
+    const int worker_count = qMin(SECURITY_BATCH_THREAD_MAX, d->target_list.size());
+    for (int i = 0; i < worker_count; i++) {
+        pool.start(new AdSecurityBatchWorker(d));
+    }
+
+    bool all_success = true;
+
+    auto process_results = [&]() {
+        const QList<AdSecurityBatchResult> ready_list = [&]() {
+            QMutexLocker locker(&d->result_mutex);
+
+            const QList<AdSecurityBatchResult> out = d->result_list;
+            d->result_list.clear();
+
+            return out;
+        }();
+
+        for (const AdSecurityBatchResult &result : ready_list) {
+            all_success = (all_success && result.success);
+
+            // NOTE: after stopping, results of targets
+            // that were in progress are still counted,
+            // but not passed to callback
+            if (d->stop_flag.loadAcquire()) {
+                continue;
+            }
+
+            const bool should_continue = callback(result);
+            if (!should_continue) {
+                stop();
+            }
+        }
+    };
+
+    while (true) {
+        const bool workers_done = pool.waitForDone(RESULTS_POLL_INTERVAL);
+
+        process_results();
+
+        if (workers_done) {
+            break;
+        }
+    }
+
+    const bool processed_all = (d->done_count.loadAcquire() == d->target_list.size());
+
+    return (all_success && processed_all);
+}
+
+void AdSecurityBatch::stop() {
+    d->stop_flag.storeRelease(1);
+}
+
+int AdSecurityBatch::done_count() const {
+    return d->done_count.loadAcquire();
+}
+
+AdSecurityBatchWorker::AdSecurityBatchWorker(AdSecurityBatchPrivate *d_arg) {
+    d = d_arg;
+}
+
+void AdSecurityBatchWorker::run() {
+    AdInterface ad;
+
+    // NOTE: workers take targets one at a time, so that
+    // a worker that got slow objects doesn't hold back
+    // others
+    while (!d->stop_flag.loadAcquire()) {
+        const int index = d->next_index.fetchAndAddOrdered(1);
+        if (index >= d->target_list.size()) {
+            break;
+        }
+
+        const QString dn = d->target_list[index];
+
+        AdSecurityBatchResult result;
+        result.dn = dn;
+
+        if (ad.is_connected()) {
+            ad.clear_messages();
+
+            result.success = apply(ad, dn);
+        } else {
+            result.success = false;
+        }
+
+        result.message_list = ad.messages();
+
+        // NOTE: failing to read the descriptor doesn't
+        // produce an error message, so add one to let user
+        // know which objects weren't changed
+        const bool has_error_message = std::any_of(result.message_list.begin(), result.message_list.end(),
+            [](const AdMessage &message) {
+                return (message.type() == AdMessageType_Error);
+            });
+        if (!result.success && !has_error_message) {
+            const QString error_text = QCoreApplication::translate("AdSecurityBatch", "Failed to change permissions of %1.").arg(dn_get_name(dn));
+            result.message_list.append(AdMessage(error_text, AdMessageType_Error));
+        }
+
+        {
+            QMutexLocker locker(&d->result_mutex);
+            d->result_list.append(result);
+        }
+
+        d->done_count.fetchAndAddRelease(1);
+    }
+}
+
+bool AdSecurityBatchWorker::apply(AdInterface &ad, const QString &dn) {
+    const QList<QString> attributes = {
+        ATTRIBUTE_SECURITY_DESCRIPTOR,
+        ATTRIBUTE_OBJECT_CLASS,
+    };
+    const AdObject object = ad.search_object(dn, attributes);
+
+    // NOTE: descriptor is missing if object doesn't exist
+    // or user isn't allowed to read it
+    if (!object.contains(ATTRIBUTE_SECURITY_DESCRIPTOR)) {
+        return false;
+    }
+
+    const QList<QString> class_list = object.get_strings(ATTRIBUTE_OBJECT_CLASS);
+    security_descriptor *sd = object.get_security_descriptor();
+
+    for (const AdSecurityEdit &edit : d->edit_list) {
+        switch (edit.type) {
+            case AdSecurityEditType_AddRight: {
+                security_descriptor_add_right(sd, ad.adconfig(), class_list, edit.trustee, edit.access_mask, edit.object_type, edit.allow);
+
+                break;
+            }
+            case AdSecurityEditType_RemoveRight: {
+                security_descriptor_remove_right(sd, ad.adconfig(), class_list, edit.trustee, edit.access_mask, edit.object_type, edit.allow);
+
+                break;
+            }
+            case AdSecurityEditType_RemoveTrustee: {
+                security_descriptor_remove_trustee(sd, {edit.trustee});
+
+                break;
+            }
+        }
+    }
+
+    const bool success = ad_security_replace_security_descriptor(ad, dn, sd);
+
+    security_descriptor_free(sd);
+
+    return success;
+}
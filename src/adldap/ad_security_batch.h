@@ -0,0 +1,95 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AD_SECURITY_BATCH_H
+#define AD_SECURITY_BATCH_H
+
+/**
+ * Applies the same security descriptor changes to many
+ * objects. Each object's descriptor is read, changed and
+ * written back by one of a few worker threads, each of
+ * which uses its own pooled connection, so that round
+ * trips to the server overlap.
+ */
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+#include <functional>
+
+class AdMessage;
+class AdSecurityBatchPrivate;
+
+enum AdSecurityEditType {
+    AdSecurityEditType_AddRight,
+    AdSecurityEditType_RemoveRight,
+    AdSecurityEditType_RemoveTrustee,
+};
+
+// One change of a descriptor. Access mask, object type
+// and allow are not used for removing trustee.
+class AdSecurityEdit {
+public:
+    AdSecurityEditType type;
+    QByteArray trustee;
+    uint32_t access_mask;
+    QByteArray object_type;
+    bool allow;
+};
+
+class AdSecurityBatchResult {
+public:
+    QString dn;
+    bool success;
+
+    // Messages of operations on this object
+    QList<AdMessage> message_list;
+};
+
+class AdSecurityBatch {
+
+public:
+    AdSecurityBatch(const QList<QString> &target_list, const QList<AdSecurityEdit> &edit_list);
+    ~AdSecurityBatch();
+
+    // Applies changes to all targets, calling given
+    // function with result for each target. Function is
+    // called from the thread that called run(), return
+    // false from it to stop early. Targets which weren't
+    // processed before stopping are left unchanged and
+    // get no result. Returns true if changes were applied
+    // to all targets.
+    bool run(const std::function<bool(const AdSecurityBatchResult &result)> &callback);
+
+    // Stops batch that is running. Targets that are being
+    // processed are finished. Can be called from any
+    // thread.
+    void stop();
+
+    // Amount of targets processed so far. Can be called
+    // from any thread to display progress.
+    int done_count() const;
+
+private:
+    AdSecurityBatchPrivate *d;
+};
+
+#endif /* AD_SECURITY_BATCH_H */
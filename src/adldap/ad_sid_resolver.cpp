@@ -0,0 +1,215 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ad_sid_resolver.h"
+
+#include "adldap.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+
+// Time in msecs for which resolved names stay in cache
+#define SID_CACHE_TTL (5 * 60 * 1000)
+
+// Max amount of SID's resolved by one search. Keeps
+// filters within limits of the server.
+#define SID_BATCH_MAX 100
+
+class AdSidCacheEntry {
+public:
+    QString name;
+    QString dn;
+    QElapsedTimer age_timer;
+};
+
+static QMutex resolver_mutex;
+static QHash<QString, AdSidCacheEntry> sid_cache;
+
+void resolve_sid_list(AdInterface &ad, const QList<QString> &sid_string_list);
+bool cache_entry_is_valid(const QString &sid_string);
+
+QHash<QByteArray, QString> AdSidResolver::get_names(AdInterface &ad, const QList<QByteArray> &sid_list) {
+    QHash<QByteArray, QString> out;
+
+    // Well known SID's don't need to be searched for
+    QList<QByteArray> unknown_list;
+    for (const QByteArray &sid : sid_list) {
+        const QString well_known_name = ad_security_get_well_known_trustee_name(sid);
+
+        if (!well_known_name.isEmpty()) {
+            out[sid] = well_known_name;
+        } else if (!unknown_list.contains(sid)) {
+            unknown_list.append(sid);
+        }
+    }
+
+    QList<QString> unknown_string_list;
+    for (const QByteArray &sid : unknown_list) {
+        unknown_string_list.append(object_sid_display_value(sid));
+    }
+
+    resolve_sid_list(ad, unknown_string_list);
+
+    QMutexLocker locker(&resolver_mutex);
+
+    for (int i = 0; i < unknown_list.size(); i++) {
+        const QByteArray sid = unknown_list[i];
+        const QString sid_string = unknown_string_list[i];
+
+        // NOTE: if search failed, SID isn't in cache.
+        // Return raw SID as last option, same as for SID's
+        // that weren't found.
+        if (sid_cache.contains(sid_string)) {
+            out[sid] = sid_cache[sid_string].name;
+        } else {
+            out[sid] = sid_string;
+        }
+    }
+
+    return out;
+}
+
+QString AdSidResolver::get_name(AdInterface &ad, const QByteArray &sid) {
+    const QHash<QByteArray, QString> name_map = get_names(ad, {sid});
+    const QString out = name_map.value(sid);
+
+    return out;
+}
+
+QString AdSidResolver::get_dn(AdInterface &ad, const QByteArray &sid) {
+    const QString sid_string = object_sid_display_value(sid);
+
+    resolve_sid_list(ad, {sid_string});
+
+    QMutexLocker locker(&resolver_mutex);
+
+    return sid_cache.value(sid_string).dn;
+}
+
+void AdSidResolver::clear() {
+    QMutexLocker locker(&resolver_mutex);
+
+    sid_cache.clear();
+}
+
+// Searches for SID's that are not in cache yet or whose
+// cache entry has expired and puts results into cache
+void resolve_sid_list(AdInterface &ad, const QList<QString> &sid_string_list) {
+    if (ad.adconfig() == nullptr) {
+        return;
+    }
+
+    const QList<QString> search_list = [&]() {
+        QMutexLocker locker(&resolver_mutex);
+
+        QList<QString> out;
+
+        for (const QString &sid_string : sid_string_list) {
+            if (!cache_entry_is_valid(sid_string) && !out.contains(sid_string)) {
+                out.append(sid_string);
+            }
+        }
+
+        return out;
+    }();
+
+    const QList<QString> attributes = {
+        ATTRIBUTE_OBJECT_SID,
+        ATTRIBUTE_DISPLAY_NAME,
+        ATTRIBUTE_SAM_ACCOUNT_NAME,
+    };
+
+    for (int batch_start = 0; batch_start < search_list.size(); batch_start += SID_BATCH_MAX) {
+        const QList<QString> batch = search_list.mid(batch_start, SID_BATCH_MAX);
+
+        const QString filter = [&]() {
+            QList<QString> subfilter_list;
+
+            for (const QString &sid_string : batch) {
+                const QString subfilter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_SID, sid_string);
+                subfilter_list.append(subfilter);
+            }
+
+            return filter_OR(subfilter_list);
+        }();
+
+        QHash<QString, AdSidCacheEntry> found_map;
+        const bool search_success = ad.search_iterate(ad.adconfig()->domain_dn(), SearchScope_All, filter, attributes,
+            [&](const AdObject &object) {
+                const QString sid_string = object_sid_display_value(object.get_value(ATTRIBUTE_OBJECT_SID));
+
+                AdSidCacheEntry entry;
+                entry.dn = object.get_dn();
+
+                // NOTE: this is some weird name selection
+                // logic but that's how microsoft does it
+                entry.name = [&]() {
+                    if (object.contains(ATTRIBUTE_DISPLAY_NAME)) {
+                        return object.get_string(ATTRIBUTE_DISPLAY_NAME);
+                    } else if (object.contains(ATTRIBUTE_SAM_ACCOUNT_NAME)) {
+                        return object.get_string(ATTRIBUTE_SAM_ACCOUNT_NAME);
+                    } else {
+                        return dn_get_name(object.get_dn());
+                    }
+                }();
+
+                found_map[sid_string] = entry;
+
+                return true;
+            });
+
+        // NOTE: don't cache anything if search failed, so
+        // that it's retried next time
+        if (!search_success) {
+            continue;
+        }
+
+        QMutexLocker locker(&resolver_mutex);
+
+        for (const QString &sid_string : batch) {
+            AdSidCacheEntry entry = [&]() {
+                if (found_map.contains(sid_string)) {
+                    return found_map[sid_string];
+                } else {
+                    AdSidCacheEntry not_found_entry;
+                    not_found_entry.name = sid_string;
+
+                    return not_found_entry;
+                }
+            }();
+
+            entry.age_timer.start();
+
+            sid_cache[sid_string] = entry;
+        }
+    }
+}
+
+// NOTE: must be called with resolver_mutex locked
+bool cache_entry_is_valid(const QString &sid_string) {
+    if (!sid_cache.contains(sid_string)) {
+        return false;
+    }
+
+    const bool expired = sid_cache[sid_string].age_timer.hasExpired(SID_CACHE_TTL);
+
+    return !expired;
+}
@@ -0,0 +1,62 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AD_SID_RESOLVER_H
+#define AD_SID_RESOLVER_H
+
+/**
+ * Finds names and DN's of objects by their SID's. Many
+ * SID's are resolved at once, with one search per batch,
+ * requesting only the attributes needed for the name.
+ * Results are cached process-wide for a limited time, so
+ * that security descriptors and memberships that refer to
+ * the same objects don't search for them again.
+ *
+ * SID's that couldn't be found are also cached, their
+ * name is the SID string and DN is empty.
+ */
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class AdInterface;
+
+class AdSidResolver {
+
+public:
+    // Returns names of given SID's, in the same format as
+    // ad_security_get_trustee_name(). Well known SID's are
+    // named without searching.
+    static QHash<QByteArray, QString> get_names(AdInterface &ad, const QList<QByteArray> &sid_list);
+    static QString get_name(AdInterface &ad, const QByteArray &sid);
+
+    // Returns empty string if object wasn't found or SID
+    // is well known
+    static QString get_dn(AdInterface &ad, const QByteArray &sid);
+
+    // Drops all cached results. AdInterface calls this
+    // after objects are renamed or moved through it. Call
+    // it when refreshing, so that changes made by others
+    // are shown too.
+    static void clear();
+};
+
+#endif /* AD_SID_RESOLVER_H */
@@ -357,6 +357,53 @@ QString get_default_domain_from_krb5() {
     return out;
 }
 
+QString get_default_principal_from_krb5() {
+    krb5_error_code result;
+    krb5_context context;
+    krb5_ccache default_cache;
+    krb5_principal default_principal;
+
+    result = krb5_init_context(&context);
+    if (result) {
+        return QString();
+    }
+
+    result = krb5_cc_default(context, &default_cache);
+    if (result) {
+        krb5_free_context(context);
+
+        return QString();
+    }
+
+    result = krb5_cc_get_principal(context, default_cache, &default_principal);
+    if (result) {
+        krb5_cc_close(context, default_cache);
+        krb5_free_context(context);
+
+        return QString();
+    }
+
+    char *principal_name = NULL;
+    result = krb5_unparse_name(context, default_principal, &principal_name);
+
+    const QString out = [&]() {
+        if (result == 0) {
+            return QString::fromLocal8Bit(principal_name);
+        } else {
+            return QString();
+        }
+    }();
+
+    if (principal_name != NULL) {
+        krb5_free_unparsed_name(context, principal_name);
+    }
+    krb5_free_principal(context, default_principal);
+    krb5_cc_close(context, default_cache);
+    krb5_free_context(context);
+
+    return out;
+}
+
 int bitmask_set(const int input_mask, const int mask_to_set, const bool is_set) {
     if (is_set) {
         return input_mask | mask_to_set;
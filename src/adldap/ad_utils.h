@@ -66,6 +66,11 @@ QString dn_from_name_and_parent(const QString &name, const QString &parent, cons
 
 QString get_default_domain_from_krb5();
 
+// Returns principal of the default ccache, like
+// "user@DOMAIN.COM", or empty string if there are no
+// credentials
+QString get_default_principal_from_krb5();
+
 int bitmask_set(const int input_mask, const int mask_to_set, const bool is_set);
 bool bitmask_is_set(const int input_mask, const int mask_to_read);
 
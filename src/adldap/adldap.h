@@ -21,13 +21,20 @@
 #ifndef ADLDAP_H
 #define ADLDAP_H
 
+#include "ad_acl_audit.h"
 #include "ad_config.h"
+#include "ad_connection_pool.h"
+#include "ad_dc_locator.h"
 #include "ad_defines.h"
 #include "ad_display.h"
 #include "ad_filter.h"
+#include "ad_gplink_index.h"
 #include "ad_interface.h"
 #include "ad_object.h"
+#include "ad_search.h"
 #include "ad_security.h"
+#include "ad_security_batch.h"
+#include "ad_sid_resolver.h"
 #include "ad_utils.h"
 #include "gplink.h"
 
@@ -0,0 +1,170 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "change_watcher.h"
+
+#include "adldap.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutexLocker>
+
+// Time in msecs that search waits for a change before
+// checking if it should stop
+#define WATCH_POLL_INTERVAL 500
+
+// Min time in msecs between batches of changes
+#define CHANGES_INTERVAL 1000
+
+// Max amount of objects in one batch
+#define CHANGES_MAX 500
+
+ChangeWatcher::ChangeWatcher(const QString &base_arg, const QList<QString> &attributes_arg, const QString &filter_arg) {
+    stop_flag = 0;
+    m_failed = false;
+    base = base_arg;
+    attributes = attributes_arg;
+    filter = filter_arg;
+}
+
+void ChangeWatcher::set_filter(const QString &filter_arg) {
+    QMutexLocker locker(&filter_mutex);
+
+    filter = filter_arg;
+}
+
+QString ChangeWatcher::get_filter() {
+    QMutexLocker locker(&filter_mutex);
+
+    return filter;
+}
+
+void ChangeWatcher::stop() {
+    stop_flag.storeRelease(1);
+}
+
+bool ChangeWatcher::failed() const {
+    return m_failed;
+}
+
+void ChangeWatcher::run() {
+    AdInterface ad;
+    if (!ad.is_connected()) {
+        m_failed = true;
+
+        return;
+    }
+
+    // NOTE: matching uses a separate connection because
+    // notification search stays open on the first one
+    AdInterface match_ad;
+    if (!match_ad.is_connected()) {
+        m_failed = true;
+
+        return;
+    }
+
+    AdSearch search(ad, base, SearchScope_All, QString(), attributes);
+    search.set_notify(true);
+
+    // NOTE: pending objects are keyed by guid, so that
+    // if an object changes multiple times, only the
+    // latest version is sent. Guid is used instead of
+    // dn because dn changes on move and rename.
+    QHash<QByteArray, AdObject> pending;
+    bool overflow = false;
+
+    QElapsedTimer batch_timer;
+    batch_timer.start();
+
+    // Finds which of changed objects match the filter,
+    // with one search for the whole batch. Deleted objects
+    // are skipped because they are never added.
+    auto get_matching_set = [&](const QList<AdObject> &object_list) {
+        QSet<QString> out;
+
+        QList<QString> dn_list;
+        for (const AdObject &object : object_list) {
+            if (!object.get_bool(ATTRIBUTE_IS_DELETED)) {
+                dn_list.append(object.get_dn());
+            }
+        }
+
+        if (dn_list.isEmpty()) {
+            return out;
+        }
+
+        const QString matching_filter = filter_AND({get_filter(), filter_dn_list(dn_list)});
+
+        match_ad.search_iterate(base, SearchScope_All, matching_filter, {ATTRIBUTE_DN},
+            [&](const AdObject &object) {
+                out.insert(object.get_dn());
+
+                return !stop_flag.loadAcquire();
+            });
+
+        return out;
+    };
+
+    auto send_changes = [&]() {
+        if (overflow) {
+            emit too_many_changes();
+        } else if (!pending.isEmpty()) {
+            const QList<AdObject> object_list = pending.values();
+            const QSet<QString> matching_set = get_matching_set(object_list);
+
+            emit changes_ready(object_list, matching_set);
+        }
+
+        pending.clear();
+        overflow = false;
+        batch_timer.restart();
+    };
+
+    while (!stop_flag.loadAcquire()) {
+        AdObject object;
+        const AdSearchStatus status = search.next(&object, WATCH_POLL_INTERVAL);
+
+        if (status == AdSearchStatus_Entry) {
+            if (!overflow) {
+                const QByteArray guid = object.get_value(ATTRIBUTE_OBJECT_GUID);
+                pending.insert(guid, object);
+
+                if (pending.size() > CHANGES_MAX) {
+                    overflow = true;
+                    pending.clear();
+                }
+            }
+        } else if (status != AdSearchStatus_Timeout) {
+            // NOTE: notification search never finishes on
+            // its own, so any other status means that
+            // connection was lost or server refused the
+            // request
+            m_failed = !stop_flag.loadAcquire();
+
+            break;
+        }
+
+        const bool have_changes = (overflow || !pending.isEmpty());
+        if (have_changes && batch_timer.hasExpired(CHANGES_INTERVAL)) {
+            send_changes();
+        }
+    }
+}
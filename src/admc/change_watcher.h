@@ -0,0 +1,90 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANGE_WATCHER_H
+#define CHANGE_WATCHER_H
+
+/**
+ * A thread that watches for changes made to objects by
+ * others, using the change notification control. One
+ * request watches the whole subtree of base, which should
+ * be the root of a naming context, because servers limit
+ * the amount of notification requests per connection.
+ * Changed objects are collected and sent in batches at
+ * most once per interval, repeated changes of the same
+ * object are merged. If too many objects change within an
+ * interval, they are dropped and too_many_changes() is
+ * emitted instead, so that a mass change doesn't flood
+ * the GUI thread. Deleted objects are sent as tombstones.
+ * Changed objects are also matched against the filter of
+ * the console here, so that the GUI thread doesn't need
+ * to search to decide which new objects to show.
+ * Same as SearchThread, creator should call deleteLater()
+ * in the finished() slot.
+ */
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThread>
+
+#include <QList>
+#include <QSet>
+#include <QString>
+
+class AdObject;
+
+class ChangeWatcher final : public QThread {
+    Q_OBJECT
+
+public:
+    ChangeWatcher(const QString &base, const QList<QString> &attributes, const QString &filter);
+
+    // Changes filter that objects are matched against.
+    // Applies starting from next batch.
+    void set_filter(const QString &filter);
+
+    // NOTE: watcher stops within one poll interval after
+    // this is called
+    void stop();
+
+    // Returns true if watching stopped because of an error
+    // and not because stop() was called
+    bool failed() const;
+
+signals:
+    // Matching set contains DN's of objects that match
+    // the filter
+    void changes_ready(const QList<AdObject> &object_list, const QSet<QString> &matching_set);
+    void too_many_changes();
+
+private:
+    QAtomicInt stop_flag;
+    bool m_failed;
+    QString base;
+    QList<QString> attributes;
+
+    QMutex filter_mutex;
+    QString filter;
+
+    void run() override;
+    QString get_filter();
+};
+
+#endif /* CHANGE_WATCHER_H */
@@ -52,6 +52,12 @@ ConsoleFilterDialog::ConsoleFilterDialog(QWidget *parent)
     const int object_display_limit = settings_get_variant(SETTING_object_display_limit).toInt();
     ui->limit_spinbox->setValue(object_display_limit);
 
+    const int page_size = settings_get_variant(SETTING_page_size).toInt();
+    ui->page_size_spinbox->setValue(page_size);
+
+    const bool adaptive_page_size = settings_get_variant(SETTING_adaptive_page_size).toBool();
+    ui->adaptive_page_size_check->setChecked(adaptive_page_size);
+
     settings_setup_dialog_geometry(SETTING_console_filter_dialog_geometry, this);
 
     button_state_name_map = {
@@ -87,6 +93,14 @@ void ConsoleFilterDialog::accept() {
     const int object_display_limit = ui->limit_spinbox->value();
     settings_set_variant(SETTING_object_display_limit, object_display_limit);
 
+    const int page_size = ui->page_size_spinbox->value();
+    settings_set_variant(SETTING_page_size, page_size);
+
+    const bool adaptive_page_size = ui->adaptive_page_size_check->isChecked();
+    settings_set_variant(SETTING_adaptive_page_size, adaptive_page_size);
+
+    load_search_options();
+
     QDialog::accept();
 }
 
@@ -163,3 +177,11 @@ void ConsoleFilterDialog::on_classes_button() {
 
     ui->class_filter_widget->setEnabled(checked);
 }
+
+void load_search_options() {
+    const int page_size = settings_get_variant(SETTING_page_size).toInt();
+    AdInterface::set_page_size(page_size);
+
+    const bool adaptive_page_size = settings_get_variant(SETTING_adaptive_page_size).toBool();
+    AdInterface::set_adaptive_page_size(adaptive_page_size);
+}
@@ -64,4 +64,7 @@ private:
     void on_classes_button();
 };
 
+// Applies page size settings to AdInterface
+void load_search_options();
+
 #endif /* CONSOLE_FILTER_DIALOG_H */
@@ -172,9 +172,9 @@ void all_policies_folder_impl_add_objects(ConsoleWidget *console, const QList<Ad
         return;
     }
 
-    for (const AdObject &object : object_list) {
-        const QList<QStandardItem *> row = console->add_scope_item(ItemType_Policy, parent);
+    const QList<QList<QStandardItem *>> row_list = console->add_scope_items(ItemType_Policy, parent, object_list.size());
 
-        console_policy_load(row, object);
+    for (int i = 0; i < object_list.size(); i++) {
+        console_policy_load(row_list[i], object_list[i]);
     }
 }
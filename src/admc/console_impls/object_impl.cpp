@@ -22,9 +22,11 @@
 
 #include "adldap.h"
 #include "attribute_dialogs/list_attribute_dialog.h"
+#include "change_watcher.h"
 #include "console_filter_dialog.h"
 #include "console_impls/find_object_impl.h"
 #include "console_impls/item_type.h"
+#include "console_impls/object_item.h"
 #include "console_impls/policy_ou_impl.h"
 #include "console_impls/policy_root_impl.h"
 #include "console_impls/query_folder_impl.h"
@@ -56,6 +58,9 @@
 #include "icon_manager/icon_manager.h"
 
 #include <QDebug>
+#include <QHeaderView>
+#include <QTreeView>
+#include <QInputDialog>
 #include <QMenu>
 #include <QSet>
 #include <QStandardItemModel>
@@ -76,6 +81,7 @@ QString get_selected_target_dn_object(ConsoleWidget *console);
 void console_object_delete_dn_list(ConsoleWidget *console, const QList<QString> &dn_list, const QModelIndex &tree_root, const int type, const int dn_role);
 bool can_create_class_at_parent(const QString &create_class, const QString &parent_class);
 void console_object_move_and_rename(const QList<ConsoleWidget *> &console_list, AdInterface &ad, const QHash<QString, QString> &old_to_new_dn_map_arg, const QString &new_parent_dn);
+void console_object_move_and_rename_objects(const QList<ConsoleWidget *> &console_list, const QHash<QString, QString> &old_to_new_dn_map, const QHash<QString, AdObject> &object_map, const QString &new_parent_dn);
 
 ObjectImpl::ObjectImpl(ConsoleWidget *console_arg)
 : ConsoleImpl(console_arg) {
@@ -83,6 +89,14 @@ ObjectImpl::ObjectImpl(ConsoleWidget *console_arg)
         console,
     };
 
+    // NOTE: items are often searched by DN, so index them.
+    // Guid is searched for every object changed by others
+    // while live updates are on.
+    console_arg->add_indexed_role(ObjectRole_DN);
+    console_arg->add_indexed_role(ObjectRole_Guid);
+
+    change_watcher = nullptr;
+
     stacked_widget = new QStackedWidget(console_arg);
     set_results_view(new ResultsView(console_arg));
     group_results_widget = new GeneralGroupTab();
@@ -117,6 +131,9 @@ ObjectImpl::ObjectImpl(ConsoleWidget *console_arg)
     reset_password_action = new QAction(tr("Reset password"), this);
     reset_account_action = new QAction(tr("Reset account"), this);
     edit_upn_suffixes_action = new QAction(tr("Edit UPN suffixes"), this);
+    browse_next_action = new QAction(tr("Show next objects"), this);
+    browse_previous_action = new QAction(tr("Show previous objects"), this);
+    browse_seek_action = new QAction(tr("Go to objects starting with..."), this);
 
     auto new_menu = new QMenu(tr("New"), console_arg);
     new_action = new_menu->menuAction();
@@ -177,11 +194,29 @@ ObjectImpl::ObjectImpl(ConsoleWidget *console_arg)
     connect(
         edit_upn_suffixes_action, &QAction::triggered,
         this, &ObjectImpl::on_edit_upn_suffixes);
+    connect(
+        browse_next_action, &QAction::triggered,
+        this, &ObjectImpl::on_browse_next);
+    connect(
+        browse_previous_action, &QAction::triggered,
+        this, &ObjectImpl::on_browse_previous);
+    connect(
+        browse_seek_action, &QAction::triggered,
+        this, &ObjectImpl::on_browse_seek);
     connect(
         console, &ConsoleWidget::selection_changed,
         this, &ObjectImpl::update_toolbar_actions);
 }
 
+ObjectImpl::~ObjectImpl() {
+    // NOTE: thread must finish before it's deleted
+    if (change_watcher != nullptr) {
+        change_watcher->stop();
+        change_watcher->wait();
+        delete change_watcher;
+    }
+}
+
 void ObjectImpl::set_buddy_console(ConsoleWidget *buddy_console) {
     console_list = {
         console,
@@ -199,21 +234,7 @@ void ObjectImpl::fetch(const QModelIndex &index) {
     //
     // Search object's children
     //
-    const QString filter = [=]() {
-        QString out;
-
-        // NOTE: OR user filter with containers filter so
-        // that container objects are always shown, even if
-        // they are filtered out by user filter
-        if (object_filter_enabled) {
-            out = filter_OR({is_container_filter(), out});
-            out = filter_OR({object_filter, out});
-        }
-
-        out = advanced_features_filter(out);
-
-        return out;
-    }();
+    const QString filter = get_fetch_filter();
 
     const QList<QString> attributes = console_object_search_attributes();
 
@@ -230,7 +251,7 @@ void ObjectImpl::fetch(const QModelIndex &index) {
         }
     }
 
-    console_object_search(console, index, base, scope, filter, attributes);
+    console_object_search(console, index, base, scope, filter, attributes, console_object_sort_keys(view()));
 }
 
 bool ObjectImpl::can_drop(const QList<QPersistentModelIndex> &dropped_list, const QSet<int> &dropped_type_list, const QPersistentModelIndex &target, const int target_type) {
@@ -309,6 +330,15 @@ QString ObjectImpl::get_description(const QModelIndex &index) const {
 
     out += object_count_text;
 
+    const QVariant browse_offset = index.data(ObjectRole_BrowseOffset);
+    if (browse_offset.isValid()) {
+        const int first = browse_offset.toInt() + 1;
+        const int last = browse_offset.toInt() + console->get_child_count(index);
+        const int count = index.data(ObjectRole_BrowseCount).toInt();
+
+        out += QString(tr(" [Showing %1-%2 of %3]")).arg(QString::number(first), QString::number(last), QString::number(count));
+    }
+
     if (object_filter_enabled) {
         out += tr(" [Filtering enabled]");
     }
@@ -316,6 +346,68 @@ QString ObjectImpl::get_description(const QModelIndex &index) const {
     return out;
 }
 
+QString ObjectImpl::get_display_value(const QModelIndex &index, const QByteArray &raw_value) const {
+    const QList<QString> columns = g_adconfig->get_columns();
+    const int column = index.column();
+
+    if (column < 0 || column >= columns.size()) {
+        return QString(raw_value);
+    }
+
+    const QString attribute = columns[column];
+
+    return attribute_display_value(attribute, raw_value, g_adconfig);
+}
+
+// NOTE: numbers are sorted by value and strings by
+// themselves, which is what they are displayed as. Other
+// types, like SID's and binary values, are sorted by
+// display text.
+QVariant ObjectImpl::get_sort_value(const QModelIndex &index, const QByteArray &raw_value) const {
+    const QList<QString> columns = g_adconfig->get_columns();
+    const int column = index.column();
+
+    if (column < 0 || column >= columns.size()) {
+        return QVariant();
+    }
+
+    const QString attribute = columns[column];
+    const AttributeType type = g_adconfig->get_attribute_type(attribute);
+
+    switch (type) {
+        case AttributeType_Integer:
+        case AttributeType_Enumeration: {
+            return raw_value.toLongLong();
+        }
+        case AttributeType_LargeInteger: {
+            const qint64 value = raw_value.toLongLong();
+
+            // NOTE: timespans are stored as negative
+            // values but displayed as positive
+            const LargeIntegerSubtype subtype = g_adconfig->get_attribute_large_integer_subtype(attribute);
+            if (subtype == LargeIntegerSubtype_Timespan) {
+                return qAbs(value);
+            } else {
+                return value;
+            }
+        }
+        case AttributeType_StringCase:
+        case AttributeType_Unicode:
+        case AttributeType_IA5:
+        case AttributeType_Printable:
+        case AttributeType_Teletex: {
+            return QString::fromUtf8(raw_value);
+        }
+        default: break;
+    }
+
+    return QVariant();
+}
+
+QStandardItem *ObjectImpl::create_main_item() const {
+    return new ObjectItem();
+}
+
 void ObjectImpl::activate(const QModelIndex &index) {
     properties({index});
 }
@@ -331,6 +423,9 @@ QList<QAction *> ObjectImpl::get_all_custom_actions() const {
         reset_account_action,
         edit_upn_suffixes_action,
         move_action,
+        browse_previous_action,
+        browse_next_action,
+        browse_seek_action,
     };
 
     return out;
@@ -384,6 +479,12 @@ QSet<QAction *> ObjectImpl::get_custom_actions(const QModelIndex &index, const b
             out.insert(edit_upn_suffixes_action);
         }
 
+        const bool is_browsed = index.data(ObjectRole_BrowseOffset).isValid();
+        if (is_browsed) {
+            out.insert(browse_previous_action);
+            out.insert(browse_next_action);
+            out.insert(browse_seek_action);
+        }
     } else {
         // Multi selection only
         if (is_user) {
@@ -427,6 +528,21 @@ QSet<QAction *> ObjectImpl::get_disabled_custom_actions(const QModelIndex &index
         out.insert(move_action);
     }
 
+    const QVariant browse_offset = index.data(ObjectRole_BrowseOffset);
+    if (browse_offset.isValid()) {
+        const int offset = browse_offset.toInt();
+        const int count = index.data(ObjectRole_BrowseCount).toInt();
+        const int window_end = offset + console->get_child_count(index);
+
+        if (offset == 0) {
+            out.insert(browse_previous_action);
+        }
+
+        if (window_end >= count) {
+            out.insert(browse_next_action);
+        }
+    }
+
     return out;
 }
 
@@ -571,8 +687,10 @@ void console_object_properties(const QList<ConsoleWidget *> &console_list, const
         const QList<AdObject> object_list = [&]() {
             QList<AdObject> out;
 
+            const QHash<QString, AdObject> object_map = ad2.search_objects(dn_list);
+
             for (const QString &dn : dn_list) {
-                const AdObject object = ad2.search_object(dn);
+                const AdObject object = object_map.value(dn);
 
                 // TODO: band-aid for the situations
                 // where properties dialog interacts
@@ -592,50 +710,7 @@ void console_object_properties(const QList<ConsoleWidget *> &console_list, const
             return out;
         }();
 
-        auto apply_changes = [&ad2, &object_list](ConsoleWidget *target_console) {
-            auto apply_changes_to_branch = [&](const QModelIndex &root_index, const int item_type, const int update_dn_role) {
-                if (!root_index.isValid()) {
-                    return;
-                }
-
-                for (const AdObject &object : object_list) {
-                    const QString dn = object.get_dn();
-                    const QModelIndex object_index = target_console->search_item(root_index, update_dn_role, dn, {item_type});
-
-                    if (object_index.isValid()) {
-                        const QList<QStandardItem *> object_row = target_console->get_row(object_index);
-                        console_object_load(object_row, object);
-                    }
-                }
-            };
-
-            const QModelIndex object_root = get_object_tree_root(target_console);
-            const QModelIndex query_root = get_query_tree_root(target_console);
-            const QModelIndex policy_root = get_policy_tree_root(target_console);
-            const QModelIndex find_object_root = get_find_object_root(target_console);
-
-            apply_changes_to_branch(object_root, ItemType_Object, ObjectRole_DN);
-            apply_changes_to_branch(query_root, ItemType_Object, ObjectRole_DN);
-            apply_changes_to_branch(find_object_root, ItemType_Object, ObjectRole_DN);
-
-            // Apply to policy branch
-            if (policy_root.isValid()) {
-                for (const AdObject &object : object_list) {
-                    const QString dn = object.get_dn();
-                    const QModelIndex object_index = target_console->search_item(policy_root, PolicyOURole_DN, dn, {ItemType_PolicyOU});
-
-                    if (object_index.isValid()) {
-                        const QList<QStandardItem *> object_row = target_console->get_row(object_index);
-
-                        policy_ou_impl_load_row(object_row, object);
-                    }
-                }
-            }
-        };
-
-        for (ConsoleWidget *console : console_list) {
-            apply_changes(console);
-        }
+        console_object_update_objects(console_list, object_list);
 
         g_status->display_ad_messages(ad2, console_list[0]);
     };
@@ -673,6 +748,21 @@ void ObjectImpl::refresh(const QList<QModelIndex> &index_list) {
 
     const QModelIndex index = index_list[0];
 
+    // NOTE: trustee names may have been changed by
+    // others, resolve them again after refresh
+    AdSidResolver::clear();
+
+    // NOTE: if all children were loaded before, it's
+    // enough to load only what changed since then
+    const bool refreshed_changes = console_object_refresh_changes(console, index, get_fetch_filter());
+    if (refreshed_changes) {
+        return;
+    }
+
+    // NOTE: stop searches of children that are about to be
+    // deleted, their results won't be used
+    console_object_stop_searches(console, index);
+
     console->delete_children(index);
     fetch(index);
 }
@@ -683,6 +773,14 @@ void ObjectImpl::delete_action(const QList<QModelIndex> &index_list) {
 
 void ObjectImpl::selected_as_scope(const QModelIndex &index)
 {
+    // NOTE: if children of this object were requested in
+    // the background and are still waiting, load them
+    // first
+    const QVariant thread_id = index.data(MyConsoleRole_SearchThreadId);
+    if (index.data(ObjectRole_Fetching).toBool() && thread_id.isValid()) {
+        SearchThread::set_priority_by_id(thread_id.toInt(), SearchPriority_Visible);
+    }
+
     AdInterface ad;
     if (ad_failed(ad, console)) {
         return;
@@ -761,28 +859,7 @@ void console_object_delete(const QList<ConsoleWidget *> &console_list, const QLi
         return out;
     }();
 
-    auto apply_changes = [&ad, &deleted_list](ConsoleWidget *target_console) {
-        const QList<QModelIndex> root_list = {
-            get_object_tree_root(target_console),
-            get_query_tree_root(target_console),
-            get_find_object_root(target_console),
-        };
-
-        for (const QModelIndex &root : root_list) {
-            if (root.isValid()) {
-                console_object_delete_dn_list(target_console, deleted_list, root, ItemType_Object, ObjectRole_DN);
-            }
-        }
-
-        const QModelIndex policy_root = get_policy_tree_root(target_console);
-        if (policy_root.isValid()) {
-            console_object_delete_dn_list(target_console, deleted_list, policy_root, ItemType_PolicyOU, PolicyOURole_DN);
-        }
-    };
-
-    for (ConsoleWidget *console : console_list) {
-        apply_changes(console);
-    }
+    console_object_remove_objects(console_list, deleted_list);
 
     hide_busy_indicator();
 
@@ -829,11 +906,99 @@ void ObjectImpl::refresh_tree() {
 
     show_busy_indicator();
 
+    // NOTE: filter might have changed, so changes can't be
+    // applied on top of what is loaded. Reload everything.
+    QStandardItem *root_item = console->get_item(object_tree_root);
+    root_item->setData(QVariant(), ObjectRole_RefreshUsn);
+    root_item->setData(QVariant(), ObjectRole_RefreshDc);
+
+    if (change_watcher != nullptr) {
+        change_watcher->set_filter(get_fetch_filter());
+    }
+
     console->refresh_scope(object_tree_root);
 
     hide_busy_indicator();
 }
 
+void ObjectImpl::set_live_updates_enabled(const bool enabled) {
+    if (enabled == (change_watcher != nullptr)) {
+        return;
+    }
+
+    if (!enabled) {
+        // NOTE: watcher will delete itself when it
+        // finishes, see finished() slot below
+        change_watcher->stop();
+        change_watcher = nullptr;
+
+        return;
+    }
+
+    if (!g_adconfig->control_is_supported(LDAP_SERVER_NOTIFICATION_OID)) {
+        return;
+    }
+
+    const QList<QString> attributes = [&]() {
+        QList<QString> out = console_object_search_attributes();
+        out.append(ATTRIBUTE_IS_DELETED);
+        out.append(ATTRIBUTE_USN_CREATED);
+
+        return out;
+    }();
+
+    auto watcher = new ChangeWatcher(g_adconfig->domain_dn(), attributes, get_fetch_filter());
+    change_watcher = watcher;
+
+    connect(
+        watcher, &ChangeWatcher::changes_ready,
+        this,
+        [this](const QList<AdObject> &object_list, const QSet<QString> &matching_set) {
+            console_object_apply_changes(console_list, object_list, matching_set);
+        },
+        Qt::QueuedConnection);
+    connect(
+        watcher, &ChangeWatcher::too_many_changes,
+        this,
+        [this]() {
+            g_status->add_message(tr("Too many objects were changed by others to show the changes. Refresh to see them."), StatusType_Error);
+        },
+        Qt::QueuedConnection);
+    connect(
+        watcher, &ChangeWatcher::finished,
+        this,
+        [this, watcher]() {
+            if (watcher->failed()) {
+                g_status->add_message(tr("Live updates stopped because of a connection error."), StatusType_Error);
+            }
+
+            if (change_watcher == watcher) {
+                change_watcher = nullptr;
+            }
+
+            watcher->deleteLater();
+        },
+        Qt::QueuedConnection);
+
+    watcher->start();
+}
+
+QString ObjectImpl::get_fetch_filter() const {
+    QString out;
+
+    // NOTE: OR user filter with containers filter so
+    // that container objects are always shown, even if
+    // they are filtered out by user filter
+    if (object_filter_enabled) {
+        out = filter_OR({is_container_filter(), out});
+        out = filter_OR({object_filter, out});
+    }
+
+    out = advanced_features_filter(out);
+
+    return out;
+}
+
 void ObjectImpl::open_console_filter_dialog() {
     auto dialog = new ConsoleFilterDialog(console);
 
@@ -983,6 +1148,47 @@ void ObjectImpl::on_find() {
     find_dialog->open();
 }
 
+void ObjectImpl::on_browse_next() {
+    const QModelIndex index = console->get_selected_item(ItemType_Object);
+    const int offset = index.data(ObjectRole_BrowseOffset).toInt();
+    const QString filter = index.data(ObjectRole_BrowseFilter).toString();
+    const int window_size = settings_get_variant(SETTING_object_display_limit).toInt();
+
+    console_object_browse(console, index, filter, offset + window_size, QString());
+}
+
+void ObjectImpl::on_browse_previous() {
+    const QModelIndex index = console->get_selected_item(ItemType_Object);
+    const int offset = index.data(ObjectRole_BrowseOffset).toInt();
+    const QString filter = index.data(ObjectRole_BrowseFilter).toString();
+    const int window_size = settings_get_variant(SETTING_object_display_limit).toInt();
+
+    console_object_browse(console, index, filter, std::max(0, offset - window_size), QString());
+}
+
+void ObjectImpl::on_browse_seek() {
+    const QPersistentModelIndex index = console->get_selected_item(ItemType_Object);
+
+    auto dialog = new QInputDialog(console);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(tr("Go To Objects"));
+    dialog->setLabelText(tr("Show objects with names starting with:"));
+    dialog->open();
+
+    connect(
+        dialog, &QInputDialog::textValueSelected,
+        this,
+        [this, index](const QString &value) {
+            if (!index.isValid() || value.isEmpty()) {
+                return;
+            }
+
+            const QString filter = index.data(ObjectRole_BrowseFilter).toString();
+
+            console_object_browse(console, index, filter, 0, value);
+        });
+}
+
 void ObjectImpl::on_reset_password() {
     AdInterface ad;
     if (ad_failed(ad, console)) {
@@ -1231,6 +1437,211 @@ void ObjectImpl::set_disabled(const bool disabled) {
     g_status->display_ad_messages(ad, console);
 }
 
+void console_object_update_objects(const QList<ConsoleWidget *> &console_list, const QList<AdObject> &object_list) {
+    auto apply_changes = [&object_list](ConsoleWidget *target_console) {
+        auto apply_changes_to_branch = [&](const QModelIndex &root_index, const int item_type, const int update_dn_role) {
+            if (!root_index.isValid()) {
+                return;
+            }
+
+            for (const AdObject &object : object_list) {
+                const QString dn = object.get_dn();
+                const QModelIndex object_index = target_console->search_item(root_index, update_dn_role, dn, {item_type});
+
+                if (object_index.isValid()) {
+                    const QList<QStandardItem *> object_row = target_console->get_row(object_index);
+                    console_object_load(object_row, object);
+                }
+            }
+        };
+
+        const QModelIndex object_root = get_object_tree_root(target_console);
+        const QModelIndex query_root = get_query_tree_root(target_console);
+        const QModelIndex policy_root = get_policy_tree_root(target_console);
+        const QModelIndex find_object_root = get_find_object_root(target_console);
+
+        apply_changes_to_branch(object_root, ItemType_Object, ObjectRole_DN);
+        apply_changes_to_branch(query_root, ItemType_Object, ObjectRole_DN);
+        apply_changes_to_branch(find_object_root, ItemType_Object, ObjectRole_DN);
+
+        // Apply to policy branch
+        if (policy_root.isValid()) {
+            for (const AdObject &object : object_list) {
+                const QString dn = object.get_dn();
+                const QModelIndex object_index = target_console->search_item(policy_root, PolicyOURole_DN, dn, {ItemType_PolicyOU});
+
+                if (object_index.isValid()) {
+                    const QList<QStandardItem *> object_row = target_console->get_row(object_index);
+
+                    policy_ou_impl_load_row(object_row, object);
+                }
+            }
+        }
+    };
+
+    for (ConsoleWidget *console : console_list) {
+        apply_changes(console);
+    }
+}
+
+void console_object_remove_objects(const QList<ConsoleWidget *> &console_list, const QList<QString> &dn_list) {
+    auto apply_changes = [&dn_list](ConsoleWidget *target_console) {
+        const QList<QModelIndex> root_list = {
+            get_object_tree_root(target_console),
+            get_query_tree_root(target_console),
+            get_find_object_root(target_console),
+        };
+
+        for (const QModelIndex &root : root_list) {
+            if (root.isValid()) {
+                console_object_delete_dn_list(target_console, dn_list, root, ItemType_Object, ObjectRole_DN);
+            }
+        }
+
+        const QModelIndex policy_root = get_policy_tree_root(target_console);
+        if (policy_root.isValid()) {
+            console_object_delete_dn_list(target_console, dn_list, policy_root, ItemType_PolicyOU, PolicyOURole_DN);
+        }
+    };
+
+    for (ConsoleWidget *console : console_list) {
+        apply_changes(console);
+    }
+}
+
+void console_object_apply_changes(const QList<ConsoleWidget *> &console_list, const QList<AdObject> &object_list, const QSet<QString> &matching_set) {
+    if (console_list.isEmpty()) {
+        return;
+    }
+
+    ConsoleWidget *main_console = console_list[0];
+
+    // Sort changes by kind. Items are found by guid
+    // because dn of moved and deleted objects is
+    // different from dn of their items.
+    QList<AdObject> changed_list;
+    QList<QString> deleted_list;
+    QHash<QString, QHash<QString, QString>> moved_map;
+    QHash<QString, QList<AdObject>> created_map;
+
+    for (const AdObject &object : object_list) {
+        const QString guid = QString(object.get_value(ATTRIBUTE_OBJECT_GUID).toHex());
+        const QModelIndex old_index = main_console->search_item(QModelIndex(), ObjectRole_Guid, guid, {ItemType_Object});
+        const QString old_dn = old_index.data(ObjectRole_DN).toString();
+        const QString new_dn = object.get_dn();
+        const bool is_deleted = object.get_bool(ATTRIBUTE_IS_DELETED);
+
+        if (is_deleted) {
+            if (old_index.isValid()) {
+                deleted_list.append(old_dn);
+            }
+        } else if (!old_index.isValid()) {
+            const QString parent_dn = dn_get_parent(new_dn);
+            created_map[parent_dn].append(object);
+        } else if (old_dn != new_dn) {
+            const QString new_parent_dn = dn_get_parent(new_dn);
+            moved_map[new_parent_dn][old_dn] = new_dn;
+        } else {
+            changed_list.append(object);
+        }
+    }
+
+    console_object_update_objects(console_list, changed_list);
+    console_object_remove_objects(console_list, deleted_list);
+
+    // NOTE: new objects are only added to containers whose
+    // children were all loaded, others will load them when
+    // they are fetched. Containers that are still loading
+    // will get them from their search, browsed containers
+    // only show one window of children.
+    const int object_display_limit = settings_get_variant(SETTING_object_display_limit).toInt();
+
+    for (ConsoleWidget *target_console : console_list) {
+        const QModelIndex object_root = get_object_tree_root(target_console);
+        if (!object_root.isValid()) {
+            continue;
+        }
+
+        for (const QString &parent_dn : created_map.keys()) {
+            const QModelIndex parent_index = target_console->search_item(object_root, ObjectRole_DN, parent_dn, {ItemType_Object});
+            if (!parent_index.isValid()) {
+                continue;
+            }
+
+            const QVariant refresh_usn_variant = parent_index.data(ObjectRole_RefreshUsn);
+            const bool is_fetching = parent_index.data(ObjectRole_Fetching).toBool();
+            const bool is_browsed = parent_index.data(ObjectRole_BrowseOffset).isValid();
+            if (!refresh_usn_variant.isValid() || is_fetching || is_browsed) {
+                continue;
+            }
+
+            // NOTE: objects created before children were
+            // loaded are already in the container or were
+            // left out of it on purpose
+            const qint64 refresh_usn = refresh_usn_variant.toLongLong();
+            const QList<AdObject> new_list = [&]() {
+                QList<AdObject> out;
+
+                for (const AdObject &object : created_map[parent_dn]) {
+                    const qint64 usn_created = object.get_string(ATTRIBUTE_USN_CREATED).toLongLong();
+
+                    if (usn_created > refresh_usn) {
+                        out.append(object);
+                    }
+                }
+
+                return out;
+            }();
+
+            if (new_list.isEmpty()) {
+                continue;
+            }
+
+            const int child_count = target_console->get_item(parent_index)->rowCount();
+
+            QList<AdObject> add_list;
+            for (const AdObject &object : new_list) {
+                if (child_count + add_list.size() >= object_display_limit) {
+                    break;
+                }
+
+                if (matching_set.contains(object.get_dn())) {
+                    add_list.append(object);
+                }
+            }
+
+            object_impl_add_objects_to_console(target_console, add_list, parent_index);
+        }
+    }
+
+    // NOTE: changed objects already contain all
+    // attributes that items need, so moved objects don't
+    // need to be loaded again
+    QHash<QString, AdObject> object_map;
+    for (const AdObject &object : object_list) {
+        object_map[object.get_dn()] = object;
+    }
+
+    for (const QString &new_parent_dn : moved_map.keys()) {
+        const QHash<QString, QString> old_to_new_dn_map = moved_map[new_parent_dn];
+
+        console_object_move_and_rename_objects(console_list, old_to_new_dn_map, object_map, new_parent_dn);
+
+        // NOTE: move_and_rename() keeps old items in
+        // object tree if new parent is not loaded, since
+        // for moves made in the app the source is always
+        // loaded. Here objects may be moved out of view,
+        // so remove old items.
+        for (ConsoleWidget *target_console : console_list) {
+            const QModelIndex object_root = get_object_tree_root(target_console);
+
+            if (object_root.isValid()) {
+                console_object_delete_dn_list(target_console, old_to_new_dn_map.keys(), object_root, ItemType_Object, ObjectRole_DN);
+            }
+        }
+    }
+}
+
 void console_object_move_and_rename(const QList<ConsoleWidget *> &console_list, AdInterface &ad, const QHash<QString, QString> &old_to_new_dn_map_arg, const QString &new_parent_dn) {
     // NOTE: sometimes, some objects that are supposed
     // to be moved don't actually need to be. For
@@ -1255,23 +1666,33 @@ void console_object_move_and_rename(const QList<ConsoleWidget *> &console_list,
         return out;
     }();
 
-    const QList<QString> old_dn_list = old_to_new_dn_map.keys();
     const QList<QString> new_dn_list = old_to_new_dn_map.values();
 
     // NOTE: search for objects once here to reuse them
     // multiple times later
+    const QHash<QString, AdObject> object_map = ad.search_objects(new_dn_list);
+
+    console_object_move_and_rename_objects(console_list, old_to_new_dn_map, object_map, new_parent_dn);
+}
+
+// Same as console_object_move_and_rename(), but for
+// objects that were already loaded. Object map should
+// contain objects by their new DN's.
+void console_object_move_and_rename_objects(const QList<ConsoleWidget *> &console_list, const QHash<QString, QString> &old_to_new_dn_map, const QHash<QString, AdObject> &object_map_arg, const QString &new_parent_dn) {
+    const QList<QString> old_dn_list = old_to_new_dn_map.keys();
+    const QList<QString> new_dn_list = old_to_new_dn_map.values();
+
     const QHash<QString, AdObject> object_map = [&]() {
         QHash<QString, AdObject> out;
 
         for (const QString &dn : new_dn_list) {
-            const AdObject object = ad.search_object(dn);
-            out[dn] = object;
+            out[dn] = object_map_arg.value(dn, AdObject());
         }
 
         return out;
     }();
 
-    auto apply_changes = [&ad, &old_to_new_dn_map, &old_dn_list, &new_parent_dn, &object_map](ConsoleWidget *target_console) {
+    auto apply_changes = [&old_to_new_dn_map, &old_dn_list, &new_parent_dn, &object_map](ConsoleWidget *target_console) {
         // For object tree, we add items representing
         // updated objects and delete old items. In the case
         // of move, this moves the items to their new
@@ -1474,6 +1895,12 @@ void object_impl_add_objects_to_console(ConsoleWidget *console, const QList<AdOb
         return;
     }
 
+    const QList<QString> filter_containers = g_adconfig->get_filter_containers();
+    const bool show_non_containers_ON = settings_get_variant(SETTING_show_non_containers_in_console_tree).toBool();
+
+    QList<AdObject> scope_object_list;
+    QList<AdObject> results_object_list;
+
     for (const AdObject &object : object_list) {
         if (object.is_empty())
             continue;
@@ -1483,27 +1910,32 @@ void object_impl_add_objects_to_console(ConsoleWidget *console, const QList<AdOb
             // Instead it means all the objects that can
             // have children(some of which are not
             // "container" class).
-            const bool is_container = [=]() {
-                const QList<QString> filter_containers = g_adconfig->get_filter_containers();
+            const bool is_container = [&]() {
                 const QString object_class = object.get_string(ATTRIBUTE_OBJECT_CLASS);
 
                 return filter_containers.contains(object_class);
             }();
 
-            const bool show_non_containers_ON = settings_get_variant(SETTING_show_non_containers_in_console_tree).toBool();
-
             return (is_container || show_non_containers_ON);
         }();
 
-        const QList<QStandardItem *> row = [&]() {
-            if (should_be_in_scope) {
-                return console->add_scope_item(ItemType_Object, parent);
-            } else {
-                return console->add_results_item(ItemType_Object, parent);
-            }
-        }();
+        if (should_be_in_scope) {
+            scope_object_list.append(object);
+        } else {
+            results_object_list.append(object);
+        }
+    }
 
-        console_object_load(row, object);
+    // NOTE: add objects in batches, so that console
+    // doesn't resort after every object
+    const QList<QList<QStandardItem *>> scope_row_list = console->add_scope_items(ItemType_Object, parent, scope_object_list.size());
+    for (int i = 0; i < scope_object_list.size(); i++) {
+        console_object_load(scope_row_list[i], scope_object_list[i]);
+    }
+
+    const QList<QList<QStandardItem *>> results_row_list = console->add_results_items(ItemType_Object, parent, results_object_list.size());
+    for (int i = 0; i < results_object_list.size(); i++) {
+        console_object_load(results_row_list[i], results_object_list[i]);
     }
 }
 
@@ -1512,8 +1944,10 @@ void object_impl_add_objects_to_console_from_dns(ConsoleWidget *console, AdInter
     const QList<AdObject> object_list = [&]() {
         QList<AdObject> out;
 
+        const QHash<QString, AdObject> object_map = ad.search_objects(dn_list);
+
         for (const QString &dn : dn_list) {
-            const AdObject object = ad.search_object(dn);
+            const AdObject object = object_map.value(dn);
             out.append(object);
         }
 
@@ -1525,15 +1959,22 @@ void object_impl_add_objects_to_console_from_dns(ConsoleWidget *console, AdInter
 
 void console_object_load(const QList<QStandardItem *> row, const AdObject &object) {
     // Load attribute columns
-    for (int i = 0; i < g_adconfig->get_columns().count(); i++) {
-        const QString attribute = g_adconfig->get_columns()[i];
+    const QList<QString> columns = g_adconfig->get_columns();
+
+    for (int i = 0; i < columns.count(); i++) {
+        const QString attribute = columns[i];
 
         if (!object.contains(attribute)) {
             continue;
         }
 
-        const QString display_value = [attribute, object]() {
-            if (attribute == ATTRIBUTE_OBJECT_CLASS) {
+        // NOTE: object class display value depends on other
+        // attributes, so it's created here. Other values are
+        // stored raw and display text is created only when
+        // item is displayed, see
+        // ObjectImpl::get_display_value().
+        if (attribute == ATTRIBUTE_OBJECT_CLASS) {
+            const QString display_value = [&]() {
                 const QString object_class = object.get_string(attribute);
 
                 if (object_class == CLASS_GROUP) {
@@ -1547,13 +1988,14 @@ void console_object_load(const QList<QStandardItem *> row, const AdObject &objec
                 } else {
                     return g_adconfig->get_class_display_name(object_class);
                 }
-            } else {
-                const QByteArray value = object.get_value(attribute);
-                return attribute_display_value(attribute, value, g_adconfig);
-            }
-        }();
+            }();
+
+            row[i]->setText(display_value);
+        } else {
+            const QByteArray value = object.get_value(attribute);
 
-        row[i]->setText(display_value);
+            row[i]->setData(value, ConsoleRole_DisplayValueRaw);
+        }
     }
 
     console_object_item_data_load(row[0], object);
@@ -1568,6 +2010,9 @@ void console_object_load(const QList<QStandardItem *> row, const AdObject &objec
 void console_object_item_data_load(QStandardItem *item, const AdObject &object) {
     item->setData(object.get_dn(), ObjectRole_DN);
 
+    const QString guid = QString(object.get_value(ATTRIBUTE_OBJECT_GUID).toHex());
+    item->setData(guid, ObjectRole_Guid);
+
     const QList<QString> object_classes = object.get_strings(ATTRIBUTE_OBJECT_CLASS);
     item->setData(QVariant(object_classes), ObjectRole_ObjectClasses);
 
@@ -1632,34 +2077,63 @@ QList<QString> console_object_search_attributes() {
     // NOTE: needed to know gpo status
     attributes += ATTRIBUTE_FLAGS;
 
+    // NOTE: needed to find items of objects changed by
+    // others, see console_object_apply_changes()
+    attributes += ATTRIBUTE_OBJECT_GUID;
+
     return attributes;
 }
 
+// Returns true if given thread is the last one that was
+// started for the item. Results of older threads should be
+// discarded.
+bool search_id_matches(QStandardItem *item, SearchThread *thread) {
+    const int id_from_item = item->data(MyConsoleRole_SearchThreadId).toInt();
+    const int thread_id = thread->get_id();
+
+    const bool match = (id_from_item == thread_id);
+
+    return match;
+}
+
 // NOTE: it is possible for a search to start while a
 // previous one hasn't finished. For that reason, this f-n
 // contains multiple workarounds for issues caused by that
 // case.
-void console_object_search(ConsoleWidget *console, const QModelIndex &index, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes) {
-    auto search_id_matches = [](QStandardItem *item, SearchThread *thread) {
-        const int id_from_item = item->data(MyConsoleRole_SearchThreadId).toInt();
-        const int thread_id = thread->get_id();
-
-        const bool match = (id_from_item == thread_id);
-
-        return match;
-    };
-
+void console_object_search(ConsoleWidget *console, const QModelIndex &index, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const QList<QString> &sort_key_list) {
     QStandardItem *item = console->get_item(index);
 
     // Set icon to indicate that item is in "search" state
     item->setIcon(QIcon::fromTheme("system-search"));
 
+    // NOTE: new search replaces browsed window and
+    // previously loaded children
+    item->setData(QVariant(), ObjectRole_BrowseOffset);
+    item->setData(QVariant(), ObjectRole_BrowseCount);
+    item->setData(QVariant(), ObjectRole_BrowseFilter);
+    item->setData(QVariant(), ObjectRole_RefreshUsn);
+    item->setData(QVariant(), ObjectRole_RefreshDc);
+
     // NOTE: need to set this role to disable actions during
     // fetch
     item->setData(true, ObjectRole_Fetching);
     item->setDragEnabled(false);
 
+    // NOTE: only children of objects can be refreshed
+    // incrementally, see console_object_refresh_changes()
+    const bool is_object = (index.data(ConsoleRole_Type).toInt() == ItemType_Object);
+
     auto search_thread = new SearchThread(base, scope, filter, attributes);
+    search_thread->set_sort_keys(sort_key_list);
+    search_thread->set_track_changes(is_object);
+
+    // NOTE: if a search is already running for this item,
+    // its results are not needed anymore, so stop it
+    // right away
+    const QVariant old_thread_id = item->data(MyConsoleRole_SearchThreadId);
+    if (old_thread_id.isValid()) {
+        SearchThread::stop_by_id(old_thread_id.toInt());
+    }
 
     // NOTE: change item's search thread, this will be used
     // later to handle situations where a thread is started
@@ -1676,7 +2150,7 @@ void console_object_search(ConsoleWidget *console, const QModelIndex &index, con
     QObject::connect(
         search_thread, &SearchThread::results_ready,
         console,
-        [=](const QHash<QString, AdObject> &results) {
+        [=](const QList<AdObject> &results) {
             // NOTE: fetched index might become invalid for
             // many reasons, parent getting moved, deleted,
             // item at the index itself might get modified.
@@ -1701,7 +2175,7 @@ void console_object_search(ConsoleWidget *console, const QModelIndex &index, con
                 return;
             }
 
-            object_impl_add_objects_to_console(console, results.values(), persistent_index);
+            object_impl_add_objects_to_console(console, results, persistent_index);
         },
         Qt::QueuedConnection);
     QObject::connect(
@@ -1712,8 +2186,21 @@ void console_object_search(ConsoleWidget *console, const QModelIndex &index, con
                 return;
             }
 
+            // NOTE: if container has too many children to
+            // load all of them, browse it one window at a
+            // time instead of showing an error, if server
+            // supports that
+            const bool should_browse = [&]() {
+                const int type = persistent_index.data(ConsoleRole_Type).toInt();
+                const bool is_object = (type == ItemType_Object);
+
+                return (search_thread->hit_object_display_limit() && is_object && console_object_can_browse());
+            }();
+
             g_status->display_ad_messages(search_thread->get_ad_messages(), console);
-            search_thread_display_errors(search_thread, console);
+            if (!should_browse) {
+                search_thread_display_errors(search_thread, console);
+            }
 
             QStandardItem *item_now = console->get_item(persistent_index);
 
@@ -1731,11 +2218,322 @@ void console_object_search(ConsoleWidget *console, const QModelIndex &index, con
             item_now->setData(false, ObjectRole_Fetching);
             item_now->setDragEnabled(true);
 
+            // NOTE: remember USN only if all children were
+            // loaded, otherwise changes can't be applied
+            // on top of them
+            const bool loaded_all_children = (!search_thread->failed_to_connect() && !search_thread->search_failed() && !search_thread->hit_object_display_limit() && search_thread->get_highest_usn() != -1);
+            if (loaded_all_children) {
+                item_now->setData(search_thread->get_highest_usn(), ObjectRole_RefreshUsn);
+                item_now->setData(search_thread->get_dc(), ObjectRole_RefreshDc);
+            }
+
+            search_thread->deleteLater();
+
+            if (should_browse) {
+                console_object_browse(console, persistent_index, filter, 0, QString());
+            }
+        },
+        Qt::QueuedConnection);
+
+    // NOTE: search for the scope that user is looking at
+    // goes ahead of prefetches of other containers
+    const SearchPriority priority = [&]() {
+        if (index == console->get_current_scope_item()) {
+            return SearchPriority_Visible;
+        } else {
+            return SearchPriority_Background;
+        }
+    }();
+
+    search_thread->start(priority);
+}
+
+void console_object_stop_searches(ConsoleWidget *console, const QModelIndex &index) {
+    const QList<QModelIndex> fetching_list = console->search_items(index, ObjectRole_Fetching, true, {ItemType_Object, ItemType_QueryItem});
+
+    for (const QModelIndex &fetching_index : fetching_list) {
+        const QVariant thread_id = fetching_index.data(MyConsoleRole_SearchThreadId);
+
+        if (thread_id.isValid()) {
+            SearchThread::stop_by_id(thread_id.toInt());
+        }
+    }
+}
+
+QList<QString> console_object_sort_keys(ResultsView *view) {
+    if (view == nullptr) {
+        return QList<QString>();
+    }
+
+    const QHeaderView *header = view->detail_view()->header();
+    const int sort_column = header->sortIndicatorSection();
+    const QList<QString> columns = g_adconfig->get_columns();
+
+    // NOTE: if view is unsorted, any order will do
+    if (sort_column < 0 || sort_column >= columns.size()) {
+        return QList<QString>();
+    }
+
+    const QString attribute = columns[sort_column];
+
+    if (header->sortIndicatorOrder() == Qt::DescendingOrder) {
+        return {"-" + attribute};
+    } else {
+        return {attribute};
+    }
+}
+
+bool console_object_refresh_changes(ConsoleWidget *console, const QModelIndex &index, const QString &filter) {
+    const QVariant old_usn_variant = index.data(ObjectRole_RefreshUsn);
+    const bool is_fetching = index.data(ObjectRole_Fetching).toBool();
+    if (!old_usn_variant.isValid() || is_fetching || !console_item_get_was_fetched(index)) {
+        return false;
+    }
+
+    QStandardItem *item = console->get_item(index);
+
+    item->setIcon(QIcon::fromTheme("system-search"));
+    item->setData(true, ObjectRole_Fetching);
+    item->setDragEnabled(false);
+
+    const QString base = index.data(ObjectRole_DN).toString();
+    const qint64 old_usn = old_usn_variant.toLongLong();
+    const QString old_dc = index.data(ObjectRole_RefreshDc).toString();
+
+    auto search_thread = new SearchThread(base, SearchScope_Children, filter, console_object_search_attributes());
+    search_thread->set_changed_since(old_usn, old_dc);
+
+    item->setData(search_thread->get_id(), MyConsoleRole_SearchThreadId);
+
+    const QPersistentModelIndex persistent_index = index;
+
+    // NOTE: children are matched by guid, because dn of an
+    // object that was renamed in place is different from
+    // dn of its row
+    auto get_child_map = [console, persistent_index]() {
+        QHash<QString, QPersistentModelIndex> out;
+
+        QStandardItem *parent_item = console->get_item(persistent_index);
+        for (int row = 0; row < parent_item->rowCount(); row++) {
+            const QModelIndex child = parent_item->child(row, 0)->index();
+            const QString guid = child.data(ObjectRole_Guid).toString();
+
+            if (!guid.isEmpty()) {
+                out.insert(guid, child);
+            }
+        }
+
+        return out;
+    };
+
+    QObject::connect(
+        search_thread, &SearchThread::results_ready,
+        console,
+        [=](const QList<AdObject> &results) {
+            if (!persistent_index.isValid()) {
+                search_thread->stop();
+
+                return;
+            }
+
+            QStandardItem *item_now = console->get_item(persistent_index);
+
+            const bool thread_id_match = search_id_matches(item_now, search_thread);
+            if (!thread_id_match) {
+                search_thread->stop();
+
+                return;
+            }
+
+            const QHash<QString, QPersistentModelIndex> child_map = get_child_map();
+            const QList<QString> columns = g_adconfig->get_columns();
+
+            // Update changed children and collect new ones
+            QList<AdObject> new_object_list;
+            for (const AdObject &object : results) {
+                const QString guid = QString(object.get_value(ATTRIBUTE_OBJECT_GUID).toHex());
+
+                if (child_map.contains(guid)) {
+                    const QList<QStandardItem *> row = console->get_row(child_map[guid]);
+
+                    // NOTE: console_object_load() skips
+                    // attributes that are missing, so clear
+                    // them here in case they were removed
+                    for (int i = 0; i < columns.size() && i < row.size(); i++) {
+                        if (!object.contains(columns[i])) {
+                            row[i]->setData(QByteArray(), ConsoleRole_DisplayValueRaw);
+                        }
+                    }
+
+                    console_object_load(row, object);
+                } else {
+                    new_object_list.append(object);
+                }
+            }
+
+            object_impl_add_objects_to_console(console, new_object_list, persistent_index);
+        },
+        Qt::QueuedConnection);
+    QObject::connect(
+        search_thread, &SearchThread::finished,
+        console,
+        [=]() {
+            search_thread->deleteLater();
+
+            if (!persistent_index.isValid()) {
+                return;
+            }
+
+            g_status->display_ad_messages(search_thread->get_ad_messages(), console);
+
+            QStandardItem *item_now = console->get_item(persistent_index);
+
+            const bool thread_id_match = search_id_matches(item_now, search_thread);
+            if (!thread_id_match) {
+                return;
+            }
+
+            const bool is_disabled = item_now->data(ObjectRole_AccountDisabled).toBool();
+            console_object_item_load_icon(item_now, is_disabled);
+
+            item_now->setData(false, ObjectRole_Fetching);
+            item_now->setDragEnabled(true);
+
+            // NOTE: if changes couldn't be found, container
+            // is reloaded from scratch. Clear USN first, so
+            // that refresh doesn't try to find changes
+            // again.
+            const bool success = (!search_thread->failed_to_connect() && !search_thread->search_failed() && !search_thread->hit_object_display_limit() && search_thread->get_highest_usn() != -1);
+            if (!success) {
+                item_now->setData(QVariant(), ObjectRole_RefreshUsn);
+                item_now->setData(QVariant(), ObjectRole_RefreshDc);
+
+                console->refresh_scope(persistent_index);
+
+                return;
+            }
+
+            const QHash<QString, QPersistentModelIndex> child_map = get_child_map();
+
+            for (const QByteArray &guid_bytes : search_thread->get_left_guid_list()) {
+                const QString guid = QString(guid_bytes.toHex());
+
+                if (child_map.contains(guid)) {
+                    console->delete_item(child_map[guid]);
+                }
+            }
+
+            item_now->setData(search_thread->get_highest_usn(), ObjectRole_RefreshUsn);
+        },
+        Qt::QueuedConnection);
+
+    search_thread->start(SearchPriority_Visible);
+
+    return true;
+}
+
+void console_object_browse(ConsoleWidget *console, const QModelIndex &index, const QString &filter, const int offset, const QString &seek_value) {
+    if (!index.isValid()) {
+        return;
+    }
+
+    QStandardItem *item = console->get_item(index);
+
+    item->setIcon(QIcon::fromTheme("system-search"));
+    item->setData(true, ObjectRole_Fetching);
+    item->setDragEnabled(false);
+
+    const QString base = index.data(ObjectRole_DN).toString();
+    const QList<QString> attributes = console_object_search_attributes();
+    const int window_size = settings_get_variant(SETTING_object_display_limit).toInt();
+
+    // NOTE: VLV search is run in the background same as
+    // regular fetches, because getting a window can take
+    // a while on slow connections
+    auto search_thread = new SearchThread(base, SearchScope_Children, filter, attributes);
+    search_thread->set_browse(ATTRIBUTE_NAME, offset, seek_value, window_size);
+
+    const QVariant old_thread_id = item->data(MyConsoleRole_SearchThreadId);
+    if (old_thread_id.isValid()) {
+        SearchThread::stop_by_id(old_thread_id.toInt());
+    }
+
+    item->setData(search_thread->get_id(), MyConsoleRole_SearchThreadId);
+
+    const QPersistentModelIndex persistent_index = index;
+
+    // NOTE: window is sent in one piece, so previous
+    // window can be replaced with it right away
+    QObject::connect(
+        search_thread, &SearchThread::results_ready,
+        console,
+        [=](const QList<AdObject> &results) {
+            if (!persistent_index.isValid()) {
+                search_thread->stop();
+
+                return;
+            }
+
+            QStandardItem *item_now = console->get_item(persistent_index);
+
+            const bool thread_id_match = search_id_matches(item_now, search_thread);
+            if (!thread_id_match) {
+                search_thread->stop();
+
+                return;
+            }
+
+            console->delete_children(persistent_index);
+            object_impl_add_objects_to_console(console, results, persistent_index);
+        },
+        Qt::QueuedConnection);
+    QObject::connect(
+        search_thread, &SearchThread::finished,
+        console,
+        [=]() {
             search_thread->deleteLater();
+
+            if (!persistent_index.isValid()) {
+                return;
+            }
+
+            g_status->display_ad_messages(search_thread->get_ad_messages(), console);
+
+            QStandardItem *item_now = console->get_item(persistent_index);
+
+            const bool thread_id_match = search_id_matches(item_now, search_thread);
+            if (!thread_id_match) {
+                return;
+            }
+
+            const bool is_disabled = item_now->data(ObjectRole_AccountDisabled).toBool();
+            console_object_item_load_icon(item_now, is_disabled);
+
+            item_now->setData(false, ObjectRole_Fetching);
+            item_now->setDragEnabled(true);
+
+            const bool browse_success = (!search_thread->failed_to_connect() && !search_thread->search_failed());
+
+            if (browse_success) {
+                item_now->setData(search_thread->get_browse_offset(), ObjectRole_BrowseOffset);
+                item_now->setData(search_thread->get_browse_count(), ObjectRole_BrowseCount);
+                item_now->setData(filter, ObjectRole_BrowseFilter);
+            } else {
+                error_log({QCoreApplication::translate("object_impl.cpp", "Failed to load objects of this container. The container may have too many objects, try reducing the number of objects by applying a filter.")}, console);
+            }
         },
         Qt::QueuedConnection);
 
-    search_thread->start();
+    search_thread->start(SearchPriority_Visible);
+}
+
+// NOTE: browsing requires server side sort and virtual
+// list view controls
+bool console_object_can_browse() {
+    const bool sort_supported = g_adconfig->control_is_supported(LDAP_SERVER_SORT_OID);
+    const bool vlv_supported = g_adconfig->control_is_supported(LDAP_SERVER_VLV_OID);
+
+    return (sort_supported && vlv_supported);
 }
 
 void console_object_tree_init(ConsoleWidget *console, AdInterface &ad) {
@@ -38,11 +38,14 @@ class ConsoleActions;
 class QMenu;
 template <typename T>
 class QList;
+template <typename T>
+class QSet;
 class ConsoleWidget;
 class ConsoleFilterDialog;
 class GeneralUserTab;
 class GeneralGroupTab;
 class QStackedWidget;
+class ChangeWatcher;
 
 enum ObjectRole {
     ObjectRole_DN = MyConsoleRole_LAST + 1,
@@ -55,6 +58,22 @@ enum ObjectRole {
     ObjectRole_Fetching,
     ObjectRole_SearchId,
 
+    // Set for containers that have too many children to
+    // load, which are browsed one window at a time
+    ObjectRole_BrowseOffset,
+    ObjectRole_BrowseCount,
+    ObjectRole_BrowseFilter,
+
+    // Set for containers whose children were all loaded.
+    // Highest USN of the DC at the time of loading and
+    // the DC itself, since USN's are local to each DC.
+    ObjectRole_RefreshUsn,
+    ObjectRole_RefreshDc,
+
+    // Hex string of objectGUID. Used to find items of
+    // objects that were moved or deleted by others.
+    ObjectRole_Guid,
+
     ObjectRole_LAST,
 };
 
@@ -63,6 +82,7 @@ class ObjectImpl final : public ConsoleImpl {
 
 public:
     ObjectImpl(ConsoleWidget *console);
+    ~ObjectImpl();
 
     // This is for cases where there are multiple consoles
     // in the app and you need to propagate changes from one
@@ -75,6 +95,9 @@ public:
     bool can_drop(const QList<QPersistentModelIndex> &dropped_list, const QSet<int> &dropped_type_list, const QPersistentModelIndex &target, const int target_type) override;
     void drop(const QList<QPersistentModelIndex> &dropped_list, const QSet<int> &dropped_type_list, const QPersistentModelIndex &target, const int target_type) override;
     QString get_description(const QModelIndex &index) const override;
+    QString get_display_value(const QModelIndex &index, const QByteArray &raw_value) const override;
+    QVariant get_sort_value(const QModelIndex &index, const QByteArray &raw_value) const override;
+    QStandardItem *create_main_item() const override;
     void activate(const QModelIndex &index) override;
 
     QList<QAction *> get_all_custom_actions() const override;
@@ -102,6 +125,12 @@ public:
 
     void refresh_tree();
 
+    // Live updates keep loaded objects up to date with
+    // changes made by others, without refreshing. Does
+    // nothing if server doesn't support change
+    // notifications.
+    void set_live_updates_enabled(const bool enabled);
+
     void open_console_filter_dialog();
 
 private slots:
@@ -120,6 +149,9 @@ private slots:
     void on_reset_password();
     void on_edit_upn_suffixes();
     void on_reset_account();
+    void on_browse_next();
+    void on_browse_previous();
+    void on_browse_seek();
 
 private:
     QList<ConsoleWidget *> console_list;
@@ -134,6 +166,9 @@ private:
     QAction *reset_password_action;
     QAction *reset_account_action;
     QAction *edit_upn_suffixes_action;
+    QAction *browse_next_action;
+    QAction *browse_previous_action;
+    QAction *browse_seek_action;
     QAction *new_action;
     QHash<QString, QAction *> new_action_map;
 
@@ -148,11 +183,14 @@ private:
     bool find_action_enabled;
     bool refresh_action_enabled;
 
+    ChangeWatcher *change_watcher;
+
     void new_object(const QString &object_class);
     void set_disabled(const bool disabled);
     void move_and_rename(AdInterface &ad, const QHash<QString, QString> &old_dn_list, const QString &new_parent_dn);
     void move(AdInterface &ad, const QList<QString> &old_dn_list, const QString &new_parent_dn);
     void update_toolbar_actions();
+    QString get_fetch_filter() const;
 };
 
 void object_impl_add_objects_to_console(ConsoleWidget *console, const QList<AdObject> &object_list, const QModelIndex &parent);
@@ -163,7 +201,30 @@ void console_object_item_load_icon(QStandardItem *item, bool disabled);
 QList<QString> object_impl_column_labels();
 QList<int> object_impl_default_columns();
 QList<QString> console_object_search_attributes();
-void console_object_search(ConsoleWidget *console, const QModelIndex &index, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes);
+void console_object_search(ConsoleWidget *console, const QModelIndex &index, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const QList<QString> &sort_key_list = QList<QString>());
+// Stops searches of given item and it's descendants that
+// are still in progress
+void console_object_stop_searches(ConsoleWidget *console, const QModelIndex &index);
+// Returns sort keys matching current sort column of
+// results view, to search objects in the order in which
+// they will be displayed
+QList<QString> console_object_sort_keys(ResultsView *view);
+// Starts applying changes made to children of given
+// container since they were loaded: adds new children,
+// updates changed ones and removes deleted, moved or
+// filtered out ones. Changes are searched for in the
+// background. Returns false if this is not possible, for
+// example if children were never fully loaded, in which
+// case container needs to be reloaded from scratch. If
+// changes can't be found after starting, container is
+// reloaded automatically.
+bool console_object_refresh_changes(ConsoleWidget *console, const QModelIndex &index, const QString &filter);
+// Loads a window of children of given container, sorted by
+// name. Window starts at given offset or, if seek value is
+// not empty, at first child whose name starts with seek
+// value or goes after it.
+void console_object_browse(ConsoleWidget *console, const QModelIndex &index, const QString &filter, const int offset, const QString &seek_value);
+bool console_object_can_browse();
 void console_object_tree_init(ConsoleWidget *console, AdInterface &ad);
 // NOTE: this may return an invalid index if there's no tree
 // of objects setup
@@ -172,6 +233,17 @@ QString console_object_count_string(ConsoleWidget *console, const QModelIndex &i
 void console_object_create(const QList<ConsoleWidget *> &console_list, const QString &object_class, const QString &parent_dn);
 void console_object_rename(const QList<ConsoleWidget *> &console_list, const QList<QModelIndex> &index_list, const int dn_role, const QString &object_class);
 void console_object_delete(const QList<ConsoleWidget *> &console_list, const QList<QModelIndex> &index_list, const int dn_role);
+// Reload items of given objects in all trees
+void console_object_update_objects(const QList<ConsoleWidget *> &console_list, const QList<AdObject> &object_list);
+// Remove items of given objects from all trees
+void console_object_remove_objects(const QList<ConsoleWidget *> &console_list, const QList<QString> &dn_list);
+// Applies changes received from ChangeWatcher. Objects can
+// be changed, new, moved, renamed or deleted, each kind is
+// applied the same way as if the change was made in the
+// app. New objects are only added to containers if they
+// are in matching set, which contains DN's of objects that
+// match the console's filter.
+void console_object_apply_changes(const QList<ConsoleWidget *> &console_list, const QList<AdObject> &object_list, const QSet<QString> &matching_set);
 void console_object_properties(const QList<ConsoleWidget *> &console_list, const QList<QModelIndex> &index_list, const int dn_role, const QList<QString> &class_list);
 bool console_object_deletion_dialog(ConsoleWidget *console, const QList<QModelIndex> &index_deleted_list);
 
@@ -0,0 +1,162 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "console_impls/object_item.h"
+
+#include "console_impls/object_impl.h"
+
+#include <QSet>
+
+#define OBJECT_ITEM_TYPE (QStandardItem::UserType + 1)
+
+bool role_is_object_role(const int role);
+quint16 role_bit(const int role);
+QList<QString> intern_string_list(const QList<QString> &list);
+QString intern_string(const QString &string);
+
+ObjectItem::ObjectItem()
+: QStandardItem() {
+    role_set_bits = 0;
+    flag_bits = 0;
+}
+
+QVariant ObjectItem::data(int role) const {
+    if (!role_is_object_role(role)) {
+        return QStandardItem::data(role);
+    }
+
+    const quint16 bit = role_bit(role);
+
+    const bool role_is_set = ((role_set_bits & bit) != 0);
+    if (!role_is_set) {
+        return QVariant();
+    }
+
+    switch (role) {
+        case ObjectRole_DN: return dn;
+        case ObjectRole_ObjectClasses: return QVariant(QStringList(object_classes));
+        case ObjectRole_ObjectCategory: return object_category;
+        default: return ((flag_bits & bit) != 0);
+    }
+}
+
+void ObjectItem::setData(const QVariant &value, int role) {
+    if (!role_is_object_role(role)) {
+        QStandardItem::setData(value, role);
+
+        return;
+    }
+
+    // NOTE: same as QStandardItem, don't notify views if
+    // value didn't change
+    if (data(role) == value) {
+        return;
+    }
+
+    const quint16 bit = role_bit(role);
+
+    if (value.isValid()) {
+        role_set_bits |= bit;
+    } else {
+        role_set_bits &= ~bit;
+    }
+
+    switch (role) {
+        case ObjectRole_DN: {
+            dn = value.toString();
+            break;
+        }
+        case ObjectRole_ObjectClasses: {
+            object_classes = intern_string_list(value.toStringList());
+            break;
+        }
+        case ObjectRole_ObjectCategory: {
+            object_category = intern_string(value.toString());
+            break;
+        }
+        default: {
+            if (value.toBool()) {
+                flag_bits |= bit;
+            } else {
+                flag_bits &= ~bit;
+            }
+            break;
+        }
+    }
+
+    emitDataChanged();
+}
+
+int ObjectItem::type() const {
+    return OBJECT_ITEM_TYPE;
+}
+
+QStandardItem *ObjectItem::clone() const {
+    auto out = new ObjectItem();
+    *out = *this;
+
+    return out;
+}
+
+bool role_is_object_role(const int role) {
+    switch (role) {
+        case ObjectRole_DN: return true;
+        case ObjectRole_ObjectClasses: return true;
+        case ObjectRole_ObjectCategory: return true;
+        case ObjectRole_CannotMove: return true;
+        case ObjectRole_CannotRename: return true;
+        case ObjectRole_CannotDelete: return true;
+        case ObjectRole_AccountDisabled: return true;
+        case ObjectRole_Fetching: return true;
+        default: return false;
+    }
+}
+
+quint16 role_bit(const int role) {
+    return (quint16) (1 << (role - ObjectRole_DN));
+}
+
+// NOTE: items are only created in the main thread, so
+// tables don't need locking
+QList<QString> intern_string_list(const QList<QString> &list) {
+    static QSet<QList<QString>> table;
+
+    auto it = table.constFind(list);
+    if (it != table.constEnd()) {
+        return *it;
+    }
+
+    table.insert(list);
+
+    return list;
+}
+
+QString intern_string(const QString &string) {
+    static QSet<QString> table;
+
+    auto it = table.constFind(string);
+    if (it != table.constEnd()) {
+        return *it;
+    }
+
+    table.insert(string);
+
+    return string;
+}
@@ -0,0 +1,63 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OBJECT_ITEM_H
+#define OBJECT_ITEM_H
+
+/**
+ * Item for first column of object rows. Object roles are
+ * stored in a compact record instead of a list of
+ * variants. Flags are packed into bits and values that
+ * repeat between objects, like object classes and
+ * category, are shared between items.
+ *
+ * NOTE: this only makes the first column of a row
+ * smaller. Rows still have a QStandardItem for each
+ * column, because console API gives out rows of items to
+ * impl's. Replacing QStandardItemModel with a model that
+ * keeps one record per object would require changing
+ * that API.
+ */
+
+#include <QList>
+#include <QStandardItem>
+#include <QString>
+
+class ObjectItem final : public QStandardItem {
+
+public:
+    ObjectItem();
+
+    QVariant data(int role = Qt::UserRole + 1) const override;
+    void setData(const QVariant &value, int role = Qt::UserRole + 1) override;
+    int type() const override;
+    QStandardItem *clone() const override;
+
+private:
+    QString dn;
+    QList<QString> object_classes;
+    QString object_category;
+
+    // NOTE: bit for each role, set if role has a value
+    quint16 role_set_bits;
+    quint16 flag_bits;
+};
+
+#endif /* OBJECT_ITEM_H */
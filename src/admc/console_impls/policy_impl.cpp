@@ -48,6 +48,9 @@ void console_policy_remove_link(const QList<ConsoleWidget *> &console_list, Poli
 
 PolicyImpl::PolicyImpl(ConsoleWidget *console_arg)
 : ConsoleImpl(console_arg) {
+    // NOTE: items are often searched by DN, so index them
+    console_arg->add_indexed_role(PolicyRole_DN);
+
     policy_results = new PolicyResultsWidget(console_arg);
     set_results_widget(policy_results);
 
@@ -51,6 +51,9 @@ bool index_is_domain(const QModelIndex &index) {
 
 PolicyOUImpl::PolicyOUImpl(ConsoleWidget *console_arg)
 : ConsoleImpl(console_arg) {
+    // NOTE: items are often searched by DN, so index them
+    console_arg->add_indexed_role(PolicyOURole_DN);
+
     policy_ou_results_widget = new PolicyOUResultsWidget(console_arg);
     set_results_widget(policy_ou_results_widget);
 
@@ -118,8 +121,7 @@ void PolicyOUImpl::fetch(const QModelIndex &index) {
     }
 
     // Add policies linked to this OU
-    const AdObject parent_object = ad.search_object(dn);
-    const QString gplink_string = parent_object.get_string(ATTRIBUTE_GPLINK);
+    const QString gplink_string = AdGplinkIndex::get_gplink(ad, dn);
     const Gplink gplink = Gplink(gplink_string);
     const QList<QString> gpo_list = gplink.get_gpo_list();
     console->get_item(index)->setData(gplink_string, PolicyOURole_Gplink_String);
@@ -167,6 +169,10 @@ void PolicyOUImpl::drop(const QList<QPersistentModelIndex> &dropped_list, const
 void PolicyOUImpl::refresh(const QList<QModelIndex> &index_list) {
     const QModelIndex index = index_list[0];
 
+    // NOTE: reload links, in case they were changed by
+    // others
+    AdGplinkIndex::clear();
+
     console->delete_children(index);
     fetch(index);
 
@@ -347,8 +353,10 @@ void policy_ou_impl_add_objects_from_dns(ConsoleWidget *console, AdInterface &ad
     const QList<AdObject> object_list = [&]() {
         QList<AdObject> out;
 
+        const QHash<QString, AdObject> object_map = ad.search_objects(dn_list);
+
         for (const QString &dn : dn_list) {
-            const AdObject object = ad.search_object(dn);
+            const AdObject object = object_map.value(dn);
             out.append(object);
         }
 
@@ -368,21 +376,32 @@ void policy_ou_impl_add_objects_to_console(ConsoleWidget *console, const QList<A
         return;
     }
 
+    QList<AdObject> ou_list;
+    QList<AdObject> gpc_list;
+
     for (const AdObject &object : object_list) {
         const bool is_ou = object.is_class(CLASS_OU);
         const bool is_gpc = object.is_class(CLASS_GP_CONTAINER);
 
         if (is_ou) {
-            const QList<QStandardItem *> row = console->add_scope_item(ItemType_PolicyOU, parent);
+            ou_list.append(object);
+        } else if (is_gpc) {
+            gpc_list.append(object);
+        }
+    }
 
-            policy_ou_impl_load_row(row, object);
+    const QList<QList<QStandardItem *>> ou_row_list = console->add_scope_items(ItemType_PolicyOU, parent, ou_list.size());
+    for (int i = 0; i < ou_list.size(); i++) {
+        const QList<QStandardItem *> &row = ou_row_list[i];
 
-            console->set_item_sort_index(row[0]->index(), 1);
-        } else if (is_gpc) {
-            const QList<QStandardItem *> row = console->add_scope_item(ItemType_Policy, parent);
+        policy_ou_impl_load_row(row, ou_list[i]);
 
-            console_policy_load(row, object);
-        }
+        console->set_item_sort_index(row[0]->index(), 1);
+    }
+
+    const QList<QList<QStandardItem *>> gpc_row_list = console->add_scope_items(ItemType_Policy, parent, gpc_list.size());
+    for (int i = 0; i < gpc_list.size(); i++) {
+        console_policy_load(gpc_row_list[i], gpc_list[i]);
     }
 }
 
@@ -83,7 +83,7 @@ void QueryItemImpl::fetch(const QModelIndex &index) {
         }
     }();
 
-    console_object_search(console, index, base, scope, filter, search_attributes);
+    console_object_search(console, index, base, scope, filter, search_attributes, console_object_sort_keys(view()));
 }
 
 QString QueryItemImpl::get_description(const QModelIndex &index) const {
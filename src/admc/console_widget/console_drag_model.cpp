@@ -20,6 +20,7 @@
 
 #include "console_widget/console_drag_model.h"
 
+#include "console_widget/console_impl.h"
 #include "console_widget/console_widget.h"
 #include "console_widget/console_widget_p.h"
 
@@ -27,12 +28,74 @@
 
 #define MIME_TYPE_CONSOLE "MIME_TYPE_CONSOLE"
 
+// Max amount of display values stored in cache
+#define DISPLAY_CACHE_SIZE 20000
+
 QModelIndex prev_parent = QModelIndex();
 bool drag_start = false;
 
 ConsoleDragModel::ConsoleDragModel(ConsoleWidget *console_arg)
 : QStandardItemModel(console_arg) {
     console = console_arg;
+
+    display_cache.setMaxCost(DISPLAY_CACHE_SIZE);
+}
+
+QVariant ConsoleDragModel::data(const QModelIndex &index, int role) const {
+    if (role == ConsoleRole_SortValue) {
+        const QVariant raw_value = QStandardItemModel::data(index, ConsoleRole_DisplayValueRaw);
+
+        if (!raw_value.isValid()) {
+            return QStandardItemModel::data(index, Qt::DisplayRole);
+        }
+
+        // NOTE: raw values can't be compared directly,
+        // numbers would be compared as strings and binary
+        // values are mangled, so impl decides what to sort
+        // by
+        const QModelIndex main_index = index.siblingAtColumn(0);
+        ConsoleImpl *impl = console->d->get_impl(main_index);
+        const QVariant sort_value = impl->get_sort_value(index, raw_value.toByteArray());
+
+        if (sort_value.isValid()) {
+            return sort_value;
+        } else {
+            return data(index, Qt::DisplayRole);
+        }
+    }
+
+    const QVariant out = QStandardItemModel::data(index, role);
+
+    if (role != Qt::DisplayRole || out.isValid()) {
+        return out;
+    }
+
+    const QVariant raw_value_variant = QStandardItemModel::data(index, ConsoleRole_DisplayValueRaw);
+    if (!raw_value_variant.isValid()) {
+        return out;
+    }
+
+    // NOTE: using index at 0th column because that column
+    // has the item roles
+    const QModelIndex main_index = index.siblingAtColumn(0);
+
+    const ConsoleDisplayKey key = {
+        main_index.data(ConsoleRole_Type).toInt(),
+        index.column(),
+        raw_value_variant.toByteArray(),
+    };
+
+    const QString *cached_value = display_cache.object(key);
+    if (cached_value != nullptr) {
+        return *cached_value;
+    }
+
+    ConsoleImpl *impl = console->d->get_impl(main_index);
+    const QString display_value = impl->get_display_value(index, key.raw_value);
+
+    display_cache.insert(key, new QString(display_value));
+
+    return display_value;
 }
 
 QMimeData *ConsoleDragModel::mimeData(const QModelIndexList &indexes) const {
@@ -111,3 +174,11 @@ bool ConsoleDragModel::dropMimeData(const QMimeData *data, Qt::DropAction action
 
     return true;
 }
+
+bool ConsoleDisplayKey::operator==(const ConsoleDisplayKey &other) const {
+    return (type == other.type && column == other.column && raw_value == other.raw_value);
+}
+
+uint qHash(const ConsoleDisplayKey &key, uint seed) {
+    return qHash(key.raw_value, seed) ^ uint(key.type << 16) ^ uint(key.column);
+}
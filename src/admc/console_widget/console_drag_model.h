@@ -21,14 +21,32 @@
 #ifndef CONSOLE_DRAG_MODEL_H
 #define CONSOLE_DRAG_MODEL_H
 
+#include <QByteArray>
+#include <QCache>
 #include <QStandardItemModel>
 
 class ConsoleWidget;
 
+class ConsoleDisplayKey {
+
+public:
+    int type;
+    int column;
+    QByteArray raw_value;
+
+    bool operator==(const ConsoleDisplayKey &other) const;
+};
+
+uint qHash(const ConsoleDisplayKey &key, uint seed = 0);
+
 /**
  * Implements drag and drop. Note that this only implements
  * the framework for drag and drop. The actual logic is
  * implemented by console widget and console types.
+ *
+ * Also creates display text for items that have a raw
+ * display value. Text is created only for items that are
+ * displayed and recently created text is cached.
  */
 
 class ConsoleDragModel : public QStandardItemModel {
@@ -37,12 +55,14 @@ class ConsoleDragModel : public QStandardItemModel {
 public:
     ConsoleDragModel(ConsoleWidget *console_arg);
 
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QMimeData *mimeData(const QModelIndexList &indexes) const override;
     bool dropMimeData(const QMimeData *data, Qt::DropAction action, int row, int column, const QModelIndex &parent) override;
     bool canDropMimeData(const QMimeData *data, Qt::DropAction action, int row, int column, const QModelIndex &parent) const override;
 
 private:
     ConsoleWidget *console;
+    mutable QCache<ConsoleDisplayKey, QString> display_cache;
 };
 
 #endif /* CONSOLE_DRAG_MODEL_H */
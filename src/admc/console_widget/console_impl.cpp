@@ -24,6 +24,7 @@
 #include "console_widget/results_view.h"
 
 #include <QSet>
+#include <QStandardItem>
 #include <QVariant>
 
 ConsoleImpl::ConsoleImpl(ConsoleWidget *console_arg)
@@ -59,6 +60,23 @@ QString ConsoleImpl::get_description(const QModelIndex &index) const {
     return QString();
 }
 
+QString ConsoleImpl::get_display_value(const QModelIndex &index, const QByteArray &raw_value) const {
+    UNUSED_ARG(index);
+
+    return QString(raw_value);
+}
+
+QVariant ConsoleImpl::get_sort_value(const QModelIndex &index, const QByteArray &raw_value) const {
+    UNUSED_ARG(index);
+    UNUSED_ARG(raw_value);
+
+    return QVariant();
+}
+
+QStandardItem *ConsoleImpl::create_main_item() const {
+    return new QStandardItem();
+}
+
 void ConsoleImpl::activate(const QModelIndex &index) {
     UNUSED_ARG(index);
 }
@@ -65,6 +65,27 @@ public:
     // Return whatever text should be displayed.
     virtual QString get_description(const QModelIndex &index) const;
 
+    // Called when an item of this type that has a raw
+    // display value is displayed. Return display text for
+    // the raw value. Default implementation returns raw
+    // value as is. NOTE: results are cached by column and
+    // raw value, so text must depend only on those.
+    virtual QString get_display_value(const QModelIndex &index, const QByteArray &raw_value) const;
+
+    // Called when results are sorted by a column of an item
+    // of this type that has a raw display value. Return a
+    // key to sort by, which should be cheaper to make than
+    // display text, for example a number for numeric
+    // columns. Return invalid variant to sort by display
+    // text, which is the default.
+    virtual QVariant get_sort_value(const QModelIndex &index, const QByteArray &raw_value) const;
+
+    // Called when a row of this type is added to create the
+    // item for the first column. Implement to use an item
+    // class that stores this type's data more compactly.
+    // Default implementation creates a QStandardItem.
+    virtual QStandardItem *create_main_item() const;
+
     // Called when an item of this type is activated, by
     // being double clicked or pressed enter on. Implement
     // appropriate response if needed.
@@ -194,6 +194,20 @@ ConsoleWidget::ConsoleWidget(QWidget *parent)
         d->model, &QStandardItemModel::rowsAboutToBeRemoved,
         d, &ConsoleWidgetPrivate::on_scope_items_about_to_be_removed);
 
+    // Keep role index up to date
+    connect(
+        d->model, &QAbstractItemModel::dataChanged,
+        d, &ConsoleWidgetPrivate::on_items_data_changed);
+    connect(
+        d->model, &QAbstractItemModel::rowsInserted,
+        d, &ConsoleWidgetPrivate::on_items_inserted);
+    connect(
+        d->model, &QAbstractItemModel::rowsAboutToBeRemoved,
+        d, &ConsoleWidgetPrivate::on_items_about_to_be_removed);
+    connect(
+        d->model, &QAbstractItemModel::modelAboutToBeReset,
+        d, &ConsoleWidgetPrivate::on_model_about_to_be_reset);
+
     // Update description bar when results count changes
     connect(
         d->model, &QAbstractItemModel::rowsInserted,
@@ -259,52 +273,25 @@ void ConsoleWidget::register_impl(const int type, ConsoleImpl *impl) {
 }
 
 QList<QStandardItem *> ConsoleWidget::add_scope_item(const int type, const QModelIndex &parent) {
-    const QList<QStandardItem *> row = add_results_item(type, parent);
-
-    row[0]->setData(false, ConsoleRole_WasFetched);
-    row[0]->setData(true, ConsoleRole_IsScope);
-
-    d->scope_proxy_model->sort(0, Qt::AscendingOrder);
-
-    return row;
+    return add_scope_items(type, parent, 1)[0];
 }
 
 QList<QStandardItem *> ConsoleWidget::add_results_item(const int type, const QModelIndex &parent) {
-    QStandardItem *parent_item = [&]() {
-        if (parent.isValid()) {
-            return d->model->itemFromIndex(parent);
-        } else {
-            return d->model->invisibleRootItem();
-        }
-    }();
-
-    // Make item row
-    const QList<QStandardItem *> row = [&]() {
-        QList<QStandardItem *> out;
-
-        const int column_count = [&]() {
-            if (parent_item == d->model->invisibleRootItem()) {
-                return 1;
-            } else {
-                ConsoleImpl *parent_impl = d->get_impl(parent);
-                return parent_impl->column_labels().size();
-            }
-        }();
-
-        for (int i = 0; i < column_count; i++) {
-            const auto item = new QStandardItem();
-            out.append(item);
-        }
+    return add_results_items(type, parent, 1)[0];
+}
 
-        return out;
-    }();
+QList<QList<QStandardItem *>> ConsoleWidget::add_scope_items(const int type, const QModelIndex &parent, const int count) {
+    const QList<QList<QStandardItem *>> row_list = d->add_items(type, parent, count, true);
 
-    row[0]->setData(false, ConsoleRole_IsScope);
-    row[0]->setData(type, ConsoleRole_Type);
+    if (!row_list.isEmpty()) {
+        d->scope_proxy_model->sort(0, Qt::AscendingOrder);
+    }
 
-    parent_item->appendRow(row);
+    return row_list;
+}
 
-    return row;
+QList<QList<QStandardItem *>> ConsoleWidget::add_results_items(const int type, const QModelIndex &parent, const int count) {
+    return d->add_items(type, parent, count, false);
 }
 
 void ConsoleWidget::delete_item(const QModelIndex &index) {
@@ -362,6 +349,10 @@ QModelIndex ConsoleWidget::get_selected_item(const int type) const {
 }
 
 QList<QModelIndex> ConsoleWidget::search_items(const QModelIndex &parent, int role, const QVariant &value, const QList<int> &type_list) const {
+    if (d->indexed_role_set.contains(role)) {
+        return d->search_role_index(parent, role, value, type_list);
+    }
+
     const QList<QModelIndex> all_matches = [&]() {
         QList<QModelIndex> out;
 
@@ -436,6 +427,20 @@ QList<QModelIndex> ConsoleWidget::search_items(const QModelIndex &parent, const
     return out;
 }
 
+void ConsoleWidget::add_indexed_role(const int role) {
+    if (d->indexed_role_set.contains(role)) {
+        return;
+    }
+
+    d->indexed_role_set.insert(role);
+
+    // Index items that were added before
+    QStandardItem *root = d->model->invisibleRootItem();
+    for (int row = 0; row < root->rowCount(); row++) {
+        d->index_item_recursive(root->child(row, 0));
+    }
+}
+
 QModelIndex ConsoleWidget::search_item(const QModelIndex &parent, int role, const QVariant &value, const QList<int> &type_list) const {
     const QList<QModelIndex> index_list = search_items(parent, role, value, type_list);
 
@@ -1124,6 +1129,264 @@ void ConsoleWidgetPrivate::on_scope_items_about_to_be_removed(const QModelIndex
     update_navigation_actions();
 }
 
+void ConsoleWidgetPrivate::on_items_data_changed(const QModelIndex &top_left, const QModelIndex &bottom_right, const QVector<int> &roles) {
+    if (top_left.column() != 0 || indexed_role_set.isEmpty()) {
+        return;
+    }
+
+    // NOTE: empty roles list means that all roles could've
+    // changed
+    const bool indexed_role_changed = [&]() {
+        if (roles.isEmpty()) {
+            return true;
+        }
+
+        for (const int role : roles) {
+            if (indexed_role_set.contains(role)) {
+                return true;
+            }
+        }
+
+        return false;
+    }();
+
+    if (!indexed_role_changed) {
+        return;
+    }
+
+    const QModelIndex parent = top_left.parent();
+
+    for (int row = top_left.row(); row <= bottom_right.row(); row++) {
+        const QModelIndex index = model->index(row, 0, parent);
+        QStandardItem *item = model->itemFromIndex(index);
+
+        index_item(item);
+    }
+}
+
+void ConsoleWidgetPrivate::on_items_inserted(const QModelIndex &parent, int first, int last) {
+    if (indexed_role_set.isEmpty()) {
+        return;
+    }
+
+    // NOTE: inserted rows may already have data and
+    // children, for example when items are moved
+    for (int row = first; row <= last; row++) {
+        const QModelIndex index = model->index(row, 0, parent);
+        QStandardItem *item = model->itemFromIndex(index);
+
+        index_item_recursive(item);
+    }
+}
+
+void ConsoleWidgetPrivate::on_items_about_to_be_removed(const QModelIndex &parent, int first, int last) {
+    if (item_indexed_value_map.isEmpty()) {
+        return;
+    }
+
+    for (int row = first; row <= last; row++) {
+        const QModelIndex index = model->index(row, 0, parent);
+        QStandardItem *item = model->itemFromIndex(index);
+
+        unindex_item_recursive(item);
+    }
+}
+
+void ConsoleWidgetPrivate::on_model_about_to_be_reset() {
+    role_index.clear();
+    item_indexed_value_map.clear();
+}
+
+QList<QList<QStandardItem *>> ConsoleWidgetPrivate::add_items(const int type, const QModelIndex &parent, const int count, const bool is_scope) {
+    QList<QList<QStandardItem *>> out;
+
+    if (count <= 0) {
+        return out;
+    }
+
+    QStandardItem *parent_item = [&]() {
+        if (parent.isValid()) {
+            return model->itemFromIndex(parent);
+        } else {
+            return model->invisibleRootItem();
+        }
+    }();
+
+    const int column_count = [&]() {
+        if (parent_item == model->invisibleRootItem()) {
+            return 1;
+        } else {
+            ConsoleImpl *parent_impl = get_impl(parent);
+            return parent_impl->column_labels().size();
+        }
+    }();
+
+    ConsoleImpl *impl = impl_map.value(type, default_impl);
+
+    // Make item rows
+    for (int row_i = 0; row_i < count; row_i++) {
+        QList<QStandardItem *> row;
+
+        for (int i = 0; i < column_count; i++) {
+            QStandardItem *item = [&]() {
+                if (i == 0) {
+                    return impl->create_main_item();
+                } else {
+                    return new QStandardItem();
+                }
+            }();
+
+            row.append(item);
+        }
+
+        // NOTE: set console roles before inserting, so that
+        // proxy models filter rows correctly right away
+        if (is_scope) {
+            row[0]->setData(false, ConsoleRole_WasFetched);
+        }
+        row[0]->setData(is_scope, ConsoleRole_IsScope);
+        row[0]->setData(type, ConsoleRole_Type);
+
+        out.append(row);
+    }
+
+    // NOTE: insert complete rows. Setting other columns
+    // of a row that is already in the model causes a layout
+    // change for every cell, which is much slower than
+    // inserting the row whole.
+    if (parent_item->columnCount() < column_count) {
+        parent_item->setColumnCount(column_count);
+    }
+
+    for (const QList<QStandardItem *> &row : out) {
+        parent_item->appendRow(row);
+    }
+
+    return out;
+}
+
+void ConsoleWidgetPrivate::index_item(QStandardItem *item) {
+    if (item == nullptr) {
+        return;
+    }
+
+    QHash<int, QString> indexed_values = item_indexed_value_map.value(item);
+
+    for (const int role : indexed_role_set) {
+        const QVariant value = item->data(role);
+        const bool has_value = value.isValid();
+        const QString new_value = value.toString();
+        const bool was_indexed = indexed_values.contains(role);
+
+        if (was_indexed && has_value && indexed_values[role] == new_value) {
+            continue;
+        }
+
+        if (was_indexed) {
+            role_index[role].remove(indexed_values[role], item);
+            indexed_values.remove(role);
+        }
+
+        if (has_value) {
+            role_index[role].insert(new_value, item);
+            indexed_values[role] = new_value;
+        }
+    }
+
+    if (indexed_values.isEmpty()) {
+        item_indexed_value_map.remove(item);
+    } else {
+        item_indexed_value_map[item] = indexed_values;
+    }
+}
+
+void ConsoleWidgetPrivate::index_item_recursive(QStandardItem *item) {
+    QStack<QStandardItem *> stack;
+    stack.push(item);
+
+    while (!stack.isEmpty()) {
+        QStandardItem *current = stack.pop();
+        if (current == nullptr) {
+            continue;
+        }
+
+        index_item(current);
+
+        for (int row = 0; row < current->rowCount(); row++) {
+            stack.push(current->child(row, 0));
+        }
+    }
+}
+
+void ConsoleWidgetPrivate::unindex_item_recursive(QStandardItem *item) {
+    QStack<QStandardItem *> stack;
+    stack.push(item);
+
+    while (!stack.isEmpty()) {
+        QStandardItem *current = stack.pop();
+        if (current == nullptr) {
+            continue;
+        }
+
+        const QHash<int, QString> indexed_values = item_indexed_value_map.take(current);
+
+        for (auto it = indexed_values.begin(); it != indexed_values.end(); it++) {
+            role_index[it.key()].remove(it.value(), current);
+        }
+
+        for (int row = 0; row < current->rowCount(); row++) {
+            stack.push(current->child(row, 0));
+        }
+    }
+}
+
+// NOTE: same semantics as search through model, parent
+// itself is included in search
+QList<QModelIndex> ConsoleWidgetPrivate::search_role_index(const QModelIndex &parent, const int role, const QVariant &value, const QList<int> &type_list) const {
+    QList<QModelIndex> out;
+
+    const QList<QStandardItem *> item_list = role_index.value(role).values(value.toString());
+
+    for (QStandardItem *item : item_list) {
+        const QModelIndex index = item->index();
+
+        const bool is_in_parent = [&]() {
+            if (!parent.isValid()) {
+                return true;
+            }
+
+            for (QModelIndex current = index; current.isValid(); current = current.parent()) {
+                if (current == parent) {
+                    return true;
+                }
+            }
+
+            return false;
+        }();
+
+        if (!is_in_parent) {
+            continue;
+        }
+
+        if (!type_list.isEmpty()) {
+            const QVariant type_variant = index.data(ConsoleRole_Type);
+            const bool type_match = (type_variant.isValid() && type_list.contains(type_variant.toInt()));
+
+            if (!type_match) {
+                continue;
+            }
+        }
+
+        if (index.data(role) != value) {
+            continue;
+        }
+
+        out.append(index);
+    }
+
+    return out;
+}
+
 void ConsoleWidgetPrivate::on_focus_changed(QWidget *old, QWidget *now) {
     UNUSED_ARG(old);
 
@@ -48,6 +48,12 @@ class ConsoleDragModel;
 #define UNUSED_ARG(x) (void) (x)
 
 enum ConsoleRolePublic {
+    // Set this role instead of display role to make display
+    // text be created only when item is displayed. Text is
+    // created by the impl of the item's type, see
+    // ConsoleImpl::get_display_value().
+    ConsoleRole_DisplayValueRaw = Qt::UserRole + 18,
+
     ConsoleRole_Type = Qt::UserRole + 19,
 
     // NOTE: when implementing custom roles, make sure they do
@@ -110,6 +116,14 @@ public:
     QList<QStandardItem *> add_scope_item(const int type, const QModelIndex &parent);
     QList<QStandardItem *> add_results_item(const int type, const QModelIndex &parent);
 
+    // Batch versions of add f-ns, which return a list of
+    // rows. Use these when adding many items at once, for
+    // example a page of search results. Each row is
+    // inserted with all of it's columns in one step, and
+    // scope is sorted once instead of after every item.
+    QList<QList<QStandardItem *>> add_scope_items(const int type, const QModelIndex &parent, const int count);
+    QList<QList<QStandardItem *>> add_results_items(const int type, const QModelIndex &parent, const int count);
+
     // Deletes an item and all of it's columns
     void delete_item(const QModelIndex &index);
 
@@ -141,6 +155,13 @@ public:
     QList<QModelIndex> search_items(const QModelIndex &parent, int role, const QVariant &value, const QList<int> &type = QList<int>()) const;
     QList<QModelIndex> search_items(const QModelIndex &parent, const QList<int> &type) const;
 
+    // Adds role to the index used by search_items(), so
+    // that searching by this role doesn't have to walk the
+    // whole model. Use for roles with string values that
+    // are mostly unique, like DN's. Only first column items
+    // are indexed.
+    void add_indexed_role(const int role);
+
     // Single index versions of search f-ns. Use when you
     // expect only one valid result or none. QModelIndex()
     // is returned if no items are found.
@@ -29,6 +29,8 @@
 #include "console_widget/results_view.h"
 
 #include <QCoreApplication>
+#include <QHash>
+#include <QMultiHash>
 #include <QSet>
 #include <QPersistentModelIndex>
 
@@ -37,6 +39,7 @@ class QStackedWidget;
 class ScopeProxyModel;
 class ConsoleDragModel;
 class QStandardItemModel;
+class QStandardItem;
 class ConsoleWidget;
 class QSplitter;
 class ConsoleImpl;
@@ -48,10 +51,17 @@ enum ConsoleRole {
 
     ConsoleRole_IsScope = Qt::UserRole + 3,
 
+    // Value used for sorting results. Returns raw value
+    // if item has one, so that sorting doesn't create
+    // display text of every row. Otherwise returns display
+    // text.
+    ConsoleRole_SortValue = Qt::UserRole + 4,
+
     // NOTE: don't go above ConsoleRole_Type and
     // ConsoleRole_LAST (defined in public header)
 
     // NOTE: these roles are "public" defined in public header
+    // ConsoleRole_DisplayValueRaw = Qt::UserRole + 18,
     // ConsoleRole_Type = Qt::UserRole + 19,
     // ConsoleRole_LAST = Qt::UserRole + 20
 };
@@ -90,6 +100,15 @@ public:
 
     QPersistentModelIndex domain_info_index;
 
+    // NOTE: index stores items instead of persistent
+    // indexes because model has to update all persistent
+    // indexes on every row insertion and removal. Items
+    // are removed from index right before they are
+    // deleted, so pointers are always valid.
+    QSet<int> indexed_role_set;
+    QHash<int, QMultiHash<QString, QStandardItem *>> role_index;
+    QHash<QStandardItem *, QHash<int, QString>> item_indexed_value_map;
+
 
     ConsoleWidgetPrivate(ConsoleWidget *q_arg);
 
@@ -108,10 +127,19 @@ public:
     void open_context_menu(const QPoint &global_pos);
     void add_actions(QMenu *menu);
     bool update_actions();
+    QList<QList<QStandardItem *>> add_items(const int type, const QModelIndex &parent, const int count, const bool is_scope);
+    void index_item(QStandardItem *item);
+    void index_item_recursive(QStandardItem *item);
+    void unindex_item_recursive(QStandardItem *item);
+    QList<QModelIndex> search_role_index(const QModelIndex &parent, const int role, const QVariant &value, const QList<int> &type_list) const;
 
 public slots:
     void on_current_scope_item_changed(const QModelIndex &current, const QModelIndex &);
     void on_scope_items_about_to_be_removed(const QModelIndex &parent, int first, int last);
+    void on_items_data_changed(const QModelIndex &top_left, const QModelIndex &bottom_right, const QVector<int> &roles);
+    void on_items_inserted(const QModelIndex &parent, int first, int last);
+    void on_items_about_to_be_removed(const QModelIndex &parent, int first, int last);
+    void on_model_about_to_be_reset();
     void on_focus_changed(QWidget *old, QWidget *now);
     void on_refresh();
     void on_customize_columns();
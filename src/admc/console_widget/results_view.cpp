@@ -20,6 +20,9 @@
 
 #include "console_widget/results_view.h"
 
+#include "console_widget/console_drag_model.h"
+#include "console_widget/console_widget_p.h"
+
 #include <QHeaderView>
 #include <QListView>
 #include <QSortFilterProxyModel>
@@ -98,6 +101,21 @@ ResultsView::ResultsView(QWidget *parent)
 
 void ResultsView::set_model(QAbstractItemModel *model) {
     proxy_model->setSourceModel(model);
+
+    // NOTE: console model creates display text lazily, so
+    // sort it by keys that impl's make from raw values.
+    // Sorting by display role would create text for every
+    // row.
+    const int sort_role = [&]() {
+        const bool is_console_model = (qobject_cast<ConsoleDragModel *>(model) != nullptr);
+
+        if (is_console_model) {
+            return (int) ConsoleRole_SortValue;
+        } else {
+            return (int) Qt::DisplayRole;
+        }
+    }();
+    proxy_model->setSortRole(sort_role);
 }
 
 void ResultsView::set_parent(const QModelIndex &source_index) {
@@ -275,13 +275,13 @@ void FindPolicyDialog::find() {
     search_thread->start();
 }
 
-void FindPolicyDialog::handle_search_thread_results(const QHash<QString, AdObject> &results) {
+void FindPolicyDialog::handle_search_thread_results(const QList<AdObject> &object_list) {
     const QModelIndex head_index = head_item->index();
 
-    for (const AdObject &object : results.values()) {
-        const QList<QStandardItem *> row = ui->console->add_results_item(ItemType_FoundPolicy, head_index);
+    const QList<QList<QStandardItem *>> row_list = ui->console->add_results_items(ItemType_FoundPolicy, head_index, object_list.size());
 
-        found_policy_impl_load(row, object);
+    for (int i = 0; i < object_list.size(); i++) {
+        found_policy_impl_load(row_list[i], object_list[i]);
     }
 }
 
@@ -49,7 +49,7 @@ private:
 
     void add_filter();
     void find();
-    void handle_search_thread_results(const QHash<QString, AdObject> &results);
+    void handle_search_thread_results(const QList<AdObject> &object_list);
     void clear_results();
 };
 
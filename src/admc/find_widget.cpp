@@ -199,13 +199,13 @@ void FindWidget::find() {
     find_thread->start();
 }
 
-void FindWidget::handle_find_thread_results(const QHash<QString, AdObject> &results) {
+void FindWidget::handle_find_thread_results(const QList<AdObject> &object_list) {
     const QModelIndex head_index = head_item->index();
 
-    for (const AdObject &object : results) {
-        const QList<QStandardItem *> row = ui->console->add_results_item(ItemType_Object, head_index);
+    const QList<QList<QStandardItem *>> row_list = ui->console->add_results_items(ItemType_Object, head_index, object_list.size());
 
-        console_object_load(row, object);
+    for (int i = 0; i < object_list.size(); i++) {
+        console_object_load(row_list[i], object_list[i]);
     }
 }
 
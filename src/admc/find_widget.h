@@ -68,7 +68,7 @@ public:
 
 private slots:
     void find();
-    void handle_find_thread_results(const QHash<QString, AdObject> &results);
+    void handle_find_thread_results(const QList<AdObject> &object_list);
 
 private:
     ObjectImpl *object_impl;
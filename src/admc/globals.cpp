@@ -25,6 +25,7 @@
 #include "status.h"
 #include "icon_manager/icon_manager.h"
 
+#include <QDebug>
 #include <QLocale>
 
 
@@ -36,4 +37,15 @@ void load_g_adconfig(AdInterface &ad) {
     const QLocale locale = settings_get_variant(SETTING_locale).toLocale();
     g_adconfig->load(ad, locale);
     AdInterface::set_config(g_adconfig);
+
+    // NOTE: timing report is only for finding out why
+    // startup is slow, so print it only in dev mode
+    const bool dev_mode = settings_get_variant(SETTING_feature_dev_mode).toBool();
+    if (dev_mode) {
+        const QList<AdConfigLoadTiming> timing_list = g_adconfig->get_load_timing_list();
+
+        for (const AdConfigLoadTiming &timing : timing_list) {
+            qInfo().noquote() << QString("AdConfig: %1 took %2ms").arg(timing.phase, QString::number(timing.elapsed));
+        }
+    }
 }
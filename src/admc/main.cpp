@@ -21,6 +21,7 @@
 #include "adldap.h"
 #include "config.h"
 #include "connection_options_dialog.h"
+#include "console_filter_dialog.h"
 #include "globals.h"
 #include "main_window.h"
 #include "main_window_connection_error.h"
@@ -34,6 +35,8 @@
 #include <QApplication>
 #include <QDebug>
 #include <QLibraryInfo>
+#include <QSet>
+#include <QStandardPaths>
 #include <QTranslator>
 
 int main(int argc, char **argv) {
@@ -44,6 +47,8 @@ int main(int argc, char **argv) {
     // passing this type from thread results in a runtime
     // error.
     qRegisterMetaType<QHash<QString, AdObject>>("QHash<QString, AdObject>");
+    qRegisterMetaType<QList<AdObject>>("QList<AdObject>");
+    qRegisterMetaType<QSet<QString>>("QSet<QString>");
 
     QApplication app(argc, argv);
     app.setApplicationDisplayName(ADMC_APPLICATION_DISPLAY_NAME);
@@ -96,6 +101,10 @@ int main(int argc, char **argv) {
     }
 
     load_connection_options();
+    load_search_options();
+
+    const QString cache_dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    AdConfig::set_cache_dir(cache_dir);
 
     // In case of failure to connect to AD and load
     // adconfig, we open a special alternative main window.
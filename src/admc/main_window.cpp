@@ -270,6 +270,7 @@ MainWindow::MainWindow(AdInterface &ad, QWidget *parent)
         {SETTING_show_login, ui->action_show_login},
         {SETTING_show_non_containers_in_console_tree, ui->action_show_noncontainers},
         {SETTING_advanced_features, ui->action_advanced_features},
+        {SETTING_live_updates, ui->action_live_updates},
     };
 
     const QList<QString> simple_setting_list = {
@@ -331,6 +332,15 @@ MainWindow::MainWindow(AdInterface &ad, QWidget *parent)
         ui->action_show_login, &QAction::triggered,
         this, &MainWindow::on_show_login_changed);
     on_show_login_changed();
+    connect(
+        ui->action_live_updates, &QAction::toggled,
+        this,
+        [object_impl](bool checked) {
+            settings_set_variant(SETTING_live_updates, checked);
+
+            object_impl->set_live_updates_enabled(checked);
+        });
+    object_impl->set_live_updates_enabled(ui->action_live_updates->isChecked());
 
     if (!current_dc_is_master_for_role(ad, FSMORole_PDCEmulation)) {
             g_status->add_message(tr("You are connected to DC without PDC-Emulator role"), StatusType_Success);
@@ -0,0 +1,162 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "multi_tabs/security_multi_tab.h"
+#include "multi_tabs/ui_security_multi_tab.h"
+
+#include "adldap.h"
+#include "globals.h"
+#include "select_object_dialog.h"
+#include "settings.h"
+#include "utils.h"
+
+enum SecurityMultiAction {
+    SecurityMultiAction_Allow,
+    SecurityMultiAction_Deny,
+    SecurityMultiAction_Remove,
+};
+
+SecurityMultiTab::SecurityMultiTab(QWidget *parent)
+: QWidget(parent) {
+    ui = new Ui::SecurityMultiTab();
+    ui->setupUi(this);
+
+    const QLocale::Language language = []() {
+        const QLocale saved_locale = settings_get_variant(SETTING_locale).toLocale();
+        const QLocale::Language out = saved_locale.language();
+
+        return out;
+    }();
+
+    for (const uint32_t &access_mask : common_rights_list) {
+        const QString right_name = ad_security_get_right_name(g_adconfig, access_mask, QByteArray(), language);
+
+        ui->right_combo->addItem(right_name, access_mask);
+    }
+
+    ui->action_combo->addItem(tr("Allow"), SecurityMultiAction_Allow);
+    ui->action_combo->addItem(tr("Deny"), SecurityMultiAction_Deny);
+    ui->action_combo->addItem(tr("Remove"), SecurityMultiAction_Remove);
+
+    update_enabled();
+
+    connect(
+        ui->apply_check, &QAbstractButton::toggled,
+        this, &SecurityMultiTab::update_enabled);
+    connect(
+        ui->apply_check, &QAbstractButton::toggled,
+        this, &SecurityMultiTab::edited);
+    connect(
+        ui->select_trustee_button, &QAbstractButton::clicked,
+        this, &SecurityMultiTab::on_select_trustee);
+    connect(
+        ui->right_combo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+        this, &SecurityMultiTab::edited);
+    connect(
+        ui->action_combo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+        this, &SecurityMultiTab::edited);
+}
+
+SecurityMultiTab::~SecurityMultiTab() {
+    delete ui;
+}
+
+QList<AdSecurityEdit> SecurityMultiTab::get_edit_list() const {
+    if (!ui->apply_check->isChecked() || trustee.isEmpty()) {
+        return QList<AdSecurityEdit>();
+    }
+
+    const uint32_t access_mask = ui->right_combo->currentData().toUInt();
+    const SecurityMultiAction action = (SecurityMultiAction) ui->action_combo->currentData().toInt();
+
+    auto make_edit = [&](const AdSecurityEditType type, const bool allow) {
+        AdSecurityEdit out;
+        out.type = type;
+        out.trustee = trustee;
+        out.access_mask = access_mask;
+        out.object_type = QByteArray();
+        out.allow = allow;
+
+        return out;
+    };
+
+    switch (action) {
+        case SecurityMultiAction_Allow: {
+            return {make_edit(AdSecurityEditType_AddRight, true)};
+        }
+        case SecurityMultiAction_Deny: {
+            return {make_edit(AdSecurityEditType_AddRight, false)};
+        }
+        case SecurityMultiAction_Remove: {
+            // NOTE: remove both allowed and denied
+            // states of the right
+            return {
+                make_edit(AdSecurityEditType_RemoveRight, true),
+                make_edit(AdSecurityEditType_RemoveRight, false),
+            };
+        }
+    }
+
+    return QList<AdSecurityEdit>();
+}
+
+void SecurityMultiTab::reset() {
+    ui->apply_check->setChecked(false);
+}
+
+void SecurityMultiTab::on_select_trustee() {
+    auto dialog = new SelectObjectDialog({CLASS_USER, CLASS_GROUP}, SelectObjectDialogMultiSelection_No, this);
+    dialog->setWindowTitle(tr("Select Trustee"));
+    dialog->open();
+
+    connect(
+        dialog, &SelectObjectDialog::accepted,
+        this,
+        [this, dialog]() {
+            const QList<QString> selected_list = dialog->get_selected();
+            if (selected_list.isEmpty()) {
+                return;
+            }
+
+            AdInterface ad;
+            if (ad_failed(ad, this)) {
+                return;
+            }
+
+            const QString dn = selected_list[0];
+            const AdObject object = ad.search_object(dn, {ATTRIBUTE_OBJECT_SID});
+
+            trustee = object.get_value(ATTRIBUTE_OBJECT_SID);
+
+            const QString trustee_name = AdSidResolver::get_name(ad, trustee);
+            ui->trustee_edit->setText(trustee_name);
+
+            emit edited();
+        });
+}
+
+void SecurityMultiTab::update_enabled() {
+    const bool enabled = ui->apply_check->isChecked();
+
+    ui->trustee_edit->setEnabled(enabled);
+    ui->select_trustee_button->setEnabled(enabled);
+    ui->right_combo->setEnabled(enabled);
+    ui->action_combo->setEnabled(enabled);
+}
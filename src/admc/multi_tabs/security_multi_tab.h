@@ -0,0 +1,67 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SECURITY_MULTI_TAB_H
+#define SECURITY_MULTI_TAB_H
+
+/**
+ * Security multi tab for changing one permission of one
+ * trustee on all selected objects. Unlike other multi
+ * tabs, it doesn't use attribute edits, because the
+ * change depends on each object's current descriptor.
+ * Changes are applied by PropertiesMultiDialog using
+ * AdSecurityBatch.
+ */
+
+#include <QWidget>
+
+class AdSecurityEdit;
+
+namespace Ui {
+class SecurityMultiTab;
+}
+
+class SecurityMultiTab final : public QWidget {
+    Q_OBJECT
+
+public:
+    Ui::SecurityMultiTab *ui;
+
+    SecurityMultiTab(QWidget *parent);
+    ~SecurityMultiTab();
+
+    // Returns empty list if changing permissions is not
+    // enabled or trustee wasn't selected
+    QList<AdSecurityEdit> get_edit_list() const;
+
+    // Call after changes were applied
+    void reset();
+
+signals:
+    void edited();
+
+private:
+    QByteArray trustee;
+
+    void on_select_trustee();
+    void update_enabled();
+};
+
+#endif /* SECURITY_MULTI_TAB_H */
@@ -25,6 +25,7 @@
 #include "console_impls/policy_impl.h"
 #include "console_widget/console_widget.h"
 #include "console_impls/item_type.h"
+#include "ad_gplink_index.h"
 #include "gplink.h"
 #include "icon_manager/icon_manager.h"
 #include "globals.h"
@@ -34,6 +35,21 @@
 //#include <QDebug>
 
 
+// NOTE: prefer links from the index, which is kept up to
+// date when links change, to links stored in the item
+// when it was fetched
+QString get_gplink_string(const QModelIndex &ou_index) {
+    const QString dn = ou_index.data(PolicyOURole_DN).toString();
+
+    QString out;
+    const bool got_from_index = AdGplinkIndex::get_loaded_gplink(dn, &out);
+    if (!got_from_index) {
+        out = ou_index.data(PolicyOURole_Gplink_String).toString();
+    }
+
+    return out;
+}
+
 InheritedPoliciesWidget::InheritedPoliciesWidget(QWidget *parent) :
     QWidget(parent),
     ui(new Ui::InheritedPoliciesWidget)
@@ -79,9 +95,7 @@ void InheritedPoliciesWidget::update(const QModelIndex &index, ConsoleWidget *co
 
 void InheritedPoliciesWidget::hide_not_enforced_inherited_links(bool hide)
 {
-    const Gplink gplink = Gplink(selected_scope_index.
-                                 data(PolicyOURole_Gplink_String).
-                                 toString());
+    const Gplink gplink = Gplink(get_gplink_string(selected_scope_index));
     const QStringList gplink_strings = gplink.get_gpo_list();
     for (int row = 0; row < model->rowCount(); ++row) {
         if (!gplink_strings.contains(model->item(row)->data(RowRole_DN).toString()) &&
@@ -96,8 +110,7 @@ void InheritedPoliciesWidget::add_enabled_policy_items(const QModelIndex &index,
     if (index.data(ConsoleRole_Type) != ItemType_PolicyOU)
         return;
 
-    QString gplink_string = index.data(PolicyOURole_Gplink_String).toString();
-    const Gplink gplink = Gplink(gplink_string);
+    const Gplink gplink = Gplink(get_gplink_string(index));
 
     const QStringList enforced_links = gplink.enforced_gpo_dn_list();
     const QStringList disabled_links = gplink.disabled_gpo_dn_list();
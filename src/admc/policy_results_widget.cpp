@@ -140,13 +140,12 @@ void PolicyResultsWidget::update(const QString &new_gpo) {
 
     model->removeRows(0, model->rowCount());
 
-    const QString base = g_adconfig->domain_dn();
-    const SearchScope scope = SearchScope_All;
-    const QList<QString> attributes = {ATTRIBUTE_NAME, ATTRIBUTE_GPLINK};
-    const QString filter = filter_CONDITION(Condition_Contains, ATTRIBUTE_GPLINK, gpo);
-    const QHash<QString, AdObject> results = ad.search(base, scope, filter, attributes);
+    // NOTE: use index instead of searching by gPLink,
+    // because substring filter requires server to go over
+    // the whole domain
+    const QList<AdObject> linked_list = AdGplinkIndex::get_links(ad, gpo);
 
-    for (const AdObject &object : results.values()) {
+    for (const AdObject &object : linked_list) {
         const QList<QStandardItem *> row = make_item_row(PolicyResultsColumn_COUNT);
 
         const QString dn = object.get_dn();
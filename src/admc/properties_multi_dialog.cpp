@@ -30,6 +30,8 @@
 #include "multi_tabs/general_user_multi_tab.h"
 #include "multi_tabs/organization_multi_tab.h"
 #include "multi_tabs/profile_multi_tab.h"
+#include "multi_tabs/security_multi_tab.h"
+#include "security_batch_thread.h"
 #include "settings.h"
 #include "status.h"
 #include "tab_widget.h"
@@ -38,6 +40,8 @@
 #include <QAction>
 #include <QCheckBox>
 #include <QDialogButtonBox>
+#include <QEventLoop>
+#include <QProgressDialog>
 #include <QPushButton>
 
 PropertiesMultiDialog::PropertiesMultiDialog(AdInterface &ad, const QList<QString> &target_list_arg, const QList<QString> &class_list)
@@ -69,6 +73,13 @@ PropertiesMultiDialog::PropertiesMultiDialog(AdInterface &ad, const QList<QStrin
         ui->tab_widget->add_tab(general_other_tab, tr("General"));
     }
 
+    security_tab = new SecurityMultiTab(this);
+    ui->tab_widget->add_tab(security_tab, tr("Security"));
+
+    connect(
+        security_tab, &SecurityMultiTab::edited,
+        this, &PropertiesMultiDialog::on_edited);
+
     for (AttributeEdit *edit : check_map.keys()) {
         QCheckBox *apply_check = check_map[edit];
 
@@ -115,7 +126,7 @@ bool PropertiesMultiDialog::apply() {
 
     show_busy_indicator();
 
-    const bool apply_success = [&]() {
+    const bool edits_success = [&]() {
         bool out = true;
 
         for (AttributeEdit *edit : edit_list) {
@@ -150,11 +161,65 @@ bool PropertiesMultiDialog::apply() {
 
     hide_busy_indicator();
 
+    const bool security_success = [&]() {
+        const QList<AdSecurityEdit> security_edit_list = security_tab->get_edit_list();
+
+        if (security_edit_list.isEmpty()) {
+            return true;
+        }
+
+        const bool out = apply_security(security_edit_list);
+
+        if (out) {
+            security_tab->reset();
+        }
+
+        return out;
+    }();
+
     emit applied();
 
+    const bool apply_success = (edits_success && security_success);
+
     return apply_success;
 }
 
+// NOTE: security changes are applied in parallel, with
+// progress, because changing each object requires
+// reading and writing its whole descriptor. Batch runs in
+// a separate thread and this f-n waits for it in a local
+// event loop, so that GUI stays responsive.
+bool PropertiesMultiDialog::apply_security(const QList<AdSecurityEdit> &security_edit_list) {
+    QProgressDialog progress_dialog(tr("Changing permissions..."), tr("Cancel"), 0, target_list.size(), this);
+    progress_dialog.setWindowModality(Qt::WindowModal);
+    progress_dialog.setMinimumDuration(0);
+
+    SecurityBatchThread thread(target_list, security_edit_list);
+    QEventLoop loop;
+
+    connect(
+        &thread, &SecurityBatchThread::progress_changed,
+        &progress_dialog, &QProgressDialog::setValue,
+        Qt::QueuedConnection);
+    connect(
+        &progress_dialog, &QProgressDialog::canceled,
+        &thread, &SecurityBatchThread::stop);
+    connect(
+        &thread, &SecurityBatchThread::finished,
+        &loop, &QEventLoop::quit,
+        Qt::QueuedConnection);
+
+    thread.start();
+    loop.exec();
+    thread.wait();
+
+    progress_dialog.setValue(target_list.size());
+
+    g_status->display_ad_messages(thread.get_message_list(), this);
+
+    return thread.success();
+}
+
 void PropertiesMultiDialog::on_edited() {
     apply_button->setEnabled(true);
 }
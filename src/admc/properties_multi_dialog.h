@@ -32,7 +32,9 @@
 
 class AttributeEdit;
 class AdInterface;
+class AdSecurityEdit;
 class QCheckBox;
+class SecurityMultiTab;
 
 namespace Ui {
 class PropertiesMultiDialog;
@@ -59,8 +61,10 @@ private:
     QList<AttributeEdit *> edit_list;
     QHash<AttributeEdit *, QCheckBox *> check_map;
     QPushButton *apply_button;
+    SecurityMultiTab *security_tab;
 
     bool apply();
+    bool apply_security(const QList<AdSecurityEdit> &security_edit_list);
 };
 
 #endif /* PROPERTIES_MULTI_DIALOG_H */
@@ -19,72 +19,518 @@
  */
 
 #include "search_thread.h"
+#include "search_thread_p.h"
 
 #include "adldap.h"
+#include "globals.h"
 #include "settings.h"
 #include "status.h"
 #include "utils.h"
 
+#include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QMutexLocker>
+#include <QThreadPool>
+
+// Max time in msecs that received results wait before
+// being sent to GUI
+#define RESULTS_PENDING_MAX 200
+
+// Max time in msecs between checks of stop flag while
+// waiting for results
+#define STOP_POLL_INTERVAL 100
+
+// Max amount of searches that run at the same time. Each
+// running search holds a connection, so this also limits
+// amount of connections opened for searching.
+#define SEARCH_THREAD_MAX 4
+
+// NOTE: threads add themselves here when created and
+// remove themselves when deleted. Only accessed from GUI
+// thread.
+QHash<int, SearchThread *> &thread_map() {
+    static QHash<int, SearchThread *> out;
+
+    return out;
+}
+
+// NOTE: jobs that new threads can still join, by key.
+// Only accessed from GUI thread.
+QHash<QString, SearchJob *> &job_map() {
+    static QHash<QString, SearchJob *> out;
+
+    return out;
+}
+
+QThreadPool *search_pool() {
+    static QThreadPool *out = []() {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(SEARCH_THREAD_MAX);
+
+        return pool;
+    }();
+
+    return out;
+}
+
+SearchJob::SearchJob(const QString &key_arg, const QString &base_arg, const SearchScope scope_arg, const QString &filter_arg, const QList<QString> &attributes_arg, const QList<QString> &sort_key_list_arg, const bool track_changes_arg, const int object_display_limit_arg)
+: QObject()
+, key(key_arg) {
+    setAutoDelete(false);
+
+    priority = SearchPriority_Background;
+    base = base_arg;
+    scope = scope_arg;
+    filter = filter_arg;
+    attributes = attributes_arg;
+    sort_key_list = sort_key_list_arg;
+    track_changes = track_changes_arg;
+    object_display_limit = object_display_limit_arg;
+    stop_flag = 0;
+    sent_results = false;
+    done = false;
+    subscriber_count = 0;
+    failed_to_connect = false;
+    hit_object_display_limit = false;
+    highest_usn = -1;
+    search_failed = false;
+    browse = false;
+    browse_offset = 0;
+    browse_window_size = 0;
+    browse_count = 0;
+    changed_since_usn = -1;
+}
+
+bool SearchJob::subscribe(SearchThread *thread) {
+    QMutexLocker locker(&mutex);
+
+    // NOTE: thread that joins late would miss results
+    // that were already sent, so it can only join if
+    // there were none
+    if (sent_results || done || stop_flag.loadAcquire()) {
+        return false;
+    }
+
+    // NOTE: connect while holding the mutex, so that job
+    // can't finish between the check above and connecting
+    connect(
+        this, &SearchJob::results_ready,
+        thread, &SearchThread::results_ready);
+    connect(
+        this, &SearchJob::finished,
+        thread, &SearchThread::on_job_finished);
+
+    subscriber_count++;
+
+    return true;
+}
+
+void SearchJob::unsubscribe(SearchThread *thread) {
+    disconnect(this, nullptr, thread, nullptr);
+
+    subscriber_count--;
+
+    if (subscriber_count > 0) {
+        return;
+    }
+
+    stop_flag.storeRelease(1);
+
+    if (job_map().value(key) == this) {
+        job_map().remove(key);
+    }
+
+    // NOTE: if job is still waiting in the queue, take it
+    // out, so it doesn't take a slot in the pool for
+    // nothing
+    const bool took_from_queue = search_pool()->tryTake(this);
+    if (took_from_queue) {
+        emit finished();
+    }
+}
+
+void SearchJob::run() {
+    if (!stop_flag.loadAcquire()) {
+        AdInterface ad;
+
+        if (ad.is_connected()) {
+            // NOTE: USN is read before searching, so that
+            // objects changed while search is in progress
+            // are not missed. They may be found again
+            // later, which is harmless.
+            if (track_changes) {
+                highest_usn = ad.get_highest_committed_usn();
+                if (highest_usn != -1) {
+                    dc = ad.get_dc();
+                }
+            }
+
+            if (browse) {
+                run_browse(ad);
+            } else if (changed_since_usn != -1) {
+                run_changes(ad);
+            } else {
+                run_search(ad);
+            }
+
+            ad_messages = ad.messages();
+        } else {
+            failed_to_connect = true;
+        }
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        done = true;
+    }
+
+    emit finished();
+}
+
+void SearchJob::run_search(AdInterface &ad) {
+    AdSearch search(ad, base, scope, filter, attributes);
+    search.set_sort_keys(sort_key_list);
+
+    int total_results_count = 0;
+
+    QList<AdObject> results;
+
+    // NOTE: results are sent when a page is done, but
+    // also when some entries have been waiting for too
+    // long, so that first rows show up without waiting
+    // for the whole first page
+    QElapsedTimer pending_timer;
+    pending_timer.start();
+
+    auto send_pending_results = [&]() {
+        send_results(ad, results);
+
+        results.clear();
+        pending_timer.restart();
+    };
+
+    // NOTE: wait for results in short intervals, so that
+    // stop() takes effect right away even if server is
+    // slow. When stopped, search is cancelled as it goes
+    // out of scope, which frees resources on the server
+    // too.
+    while (!stop_flag.loadAcquire()) {
+        AdObject object;
+        const AdSearchStatus status = search.next(&object, STOP_POLL_INTERVAL);
+
+        if (status == AdSearchStatus_Timeout) {
+            if (!results.isEmpty() && pending_timer.hasExpired(RESULTS_PENDING_MAX)) {
+                send_pending_results();
+            }
+        } else if (status == AdSearchStatus_Entry) {
+            total_results_count++;
+
+            if (total_results_count > object_display_limit) {
+                hit_object_display_limit = true;
+
+                send_pending_results();
+
+                break;
+            }
+
+            results.append(object);
+
+            if (changed_since_usn != -1) {
+                left_guid_set.remove(object.get_value(ATTRIBUTE_OBJECT_GUID));
+            }
+
+            if (pending_timer.hasExpired(RESULTS_PENDING_MAX)) {
+                send_pending_results();
+            }
+        } else {
+            send_pending_results();
+
+            if (status == AdSearchStatus_Error) {
+                search_failed = true;
+            }
+
+            if (status != AdSearchStatus_PageDone) {
+                break;
+            }
+        }
+    }
+}
+
+// NOTE: objects that changed and are still in results are
+// found by searching with the USN filter. Objects that
+// left results, for example deleted ones, can't be found
+// that way, so first all objects in the domain that
+// changed are found, including deleted ones. Those that
+// are not in results are the ones that left.
+void SearchJob::run_changes(AdInterface &ad) {
+    // NOTE: USN's of different DC's are unrelated
+    if (ad.get_dc() != changed_since_dc) {
+        search_failed = true;
+
+        return;
+    }
+
+    const QString usn_filter = QString("(%1>=%2)").arg(ATTRIBUTE_USN_CHANGED, QString::number(changed_since_usn + 1));
+
+    {
+        AdSearch search(ad, domain_dn, SearchScope_All, usn_filter, {ATTRIBUTE_OBJECT_GUID});
+        search.set_show_deleted(true);
+
+        while (!stop_flag.loadAcquire()) {
+            AdObject object;
+            const AdSearchStatus status = search.next(&object, STOP_POLL_INTERVAL);
+
+            if (status == AdSearchStatus_Entry) {
+                left_guid_set.insert(object.get_value(ATTRIBUTE_OBJECT_GUID));
+            } else if (status == AdSearchStatus_Finished) {
+                break;
+            } else if (status == AdSearchStatus_Error) {
+                search_failed = true;
+
+                return;
+            }
+        }
+    }
+
+    if (stop_flag.loadAcquire()) {
+        return;
+    }
+
+    filter = filter_AND({filter, usn_filter});
+    if (!attributes.isEmpty() && !attributes.contains(ATTRIBUTE_OBJECT_GUID)) {
+        attributes.append(ATTRIBUTE_OBJECT_GUID);
+    }
+
+    run_search(ad);
+
+    left_guid_list = left_guid_set.values();
+}
+
+void SearchJob::run_browse(AdInterface &ad) {
+    AdVlvSearch search(ad, base, scope, filter, attributes, browse_sort_attribute);
+
+    QList<AdObject> object_list;
+    const bool success = [&]() {
+        if (browse_seek_value.isEmpty()) {
+            return search.get_window(browse_offset, browse_window_size, &object_list);
+        } else {
+            return search.seek(browse_seek_value, browse_window_size, &object_list);
+        }
+    }();
+
+    if (!success) {
+        search_failed = true;
+
+        return;
+    }
+
+    browse_offset = search.offset();
+    browse_count = search.count();
+
+    // NOTE: send results even if window is empty, so
+    // that receivers know to replace previous window
+    send_results(ad, object_list);
+}
+
+void SearchJob::send_results(AdInterface &ad, const QList<AdObject> &results) {
+    QMutexLocker locker(&mutex);
+
+    sent_results = true;
+    ad_messages = ad.messages();
+
+    emit results_ready(results);
+}
 
 SearchThread::SearchThread(const QString base_arg, const SearchScope scope_arg, const QString &filter_arg, const QList<QString> attributes_arg) {
-    stop_flag = false;
     base = base_arg;
     scope = scope_arg;
     filter = filter_arg;
     attributes = attributes_arg;
+    track_changes = false;
+    browse = false;
+    browse_offset = 0;
+    browse_window_size = 0;
+    browse_count = 0;
+    changed_since_usn = -1;
+    job = nullptr;
+    is_finished = false;
+    highest_usn = -1;
     m_failed_to_connect = false;
     m_hit_object_display_limit = false;
+    m_search_failed = false;
 
     static int id_max = 0;
     id = id_max;
     id_max++;
+
+    thread_map().insert(id, this);
 }
 
-void SearchThread::stop() {
-    stop_flag = true;
+SearchThread::~SearchThread() {
+    if (job != nullptr) {
+        job->unsubscribe(this);
+    }
+
+    thread_map().remove(id);
 }
 
-void SearchThread::run() {
-    AdInterface ad;
-    if (!ad.is_connected()) {
-        m_failed_to_connect = true;
+void SearchThread::stop_by_id(const int id) {
+    SearchThread *thread = thread_map().value(id, nullptr);
+
+    if (thread != nullptr) {
+        thread->stop();
+    }
+}
 
+void SearchThread::set_priority_by_id(const int id, const SearchPriority priority) {
+    SearchThread *thread = thread_map().value(id, nullptr);
+    if (thread == nullptr || thread->job == nullptr) {
         return;
     }
 
-    AdCookie cookie;
+    SearchJob *job = thread->job;
 
-    const int object_display_limit = settings_get_variant(SETTING_object_display_limit).toInt();
+    if (priority <= job->priority) {
+        return;
+    }
 
-    int total_results_count = 0;
+    // NOTE: priority can only be changed by taking job
+    // out of the queue and putting it back. If job is
+    // already running, there's nothing to do.
+    const bool took_from_queue = search_pool()->tryTake(job);
+    if (took_from_queue) {
+        job->priority = priority;
+        search_pool()->start(job, priority);
+    }
+}
 
-    while (true) {
-        QHash<QString, AdObject> results;
+void SearchThread::set_sort_keys(const QList<QString> &key_list) {
+    sort_key_list = key_list;
+}
 
-        const bool success = ad.search_paged(base, scope, filter, attributes, &results, &cookie);
+void SearchThread::set_track_changes(const bool track_changes_arg) {
+    track_changes = track_changes_arg;
+}
 
-        total_results_count += results.count();
+void SearchThread::set_browse(const QString &sort_attribute, const int offset, const QString &seek_value, const int window_size) {
+    browse = true;
+    browse_sort_attribute = sort_attribute;
+    browse_offset = offset;
+    browse_seek_value = seek_value;
+    browse_window_size = window_size;
+}
 
-        if (total_results_count > object_display_limit) {
-            m_hit_object_display_limit = true;
+void SearchThread::set_changed_since(const qint64 usn, const QString &dc_arg) {
+    changed_since_usn = usn;
+    changed_since_dc = dc_arg;
 
-            break;
-        }
+    // NOTE: new USN is needed to find changes next time
+    track_changes = true;
+}
 
-        ad_messages = ad.messages();
+void SearchThread::start(const SearchPriority priority) {
+    if (job != nullptr || is_finished) {
+        return;
+    }
 
-        emit results_ready(results);
+    const QString key = [&]() {
+        const QList<QString> key_elements = {
+            base,
+            QString::number(scope),
+            filter,
+            attributes.join(","),
+            sort_key_list.join(","),
+            QString::number(track_changes),
+            QString::number(browse),
+            browse_sort_attribute,
+            QString::number(browse_offset),
+            browse_seek_value,
+            QString::number(browse_window_size),
+            QString::number(changed_since_usn),
+            changed_since_dc,
+        };
 
-        const bool search_interrupted = (!success || stop_flag);
-        if (search_interrupted) {
-            break;
-        }
+        return key_elements.join("|");
+    }();
 
-        if (!cookie.more_pages()) {
-            break;
-        }
+    // Join identical search if possible, otherwise start
+    // a new one
+    SearchJob *existing_job = job_map().value(key, nullptr);
+    if (existing_job != nullptr && existing_job->subscribe(this)) {
+        job = existing_job;
+
+        set_priority_by_id(id, priority);
+    } else {
+        const int object_display_limit = settings_get_variant(SETTING_object_display_limit).toInt();
+
+        job = new SearchJob(key, base, scope, filter, attributes, sort_key_list, track_changes, object_display_limit);
+        job->priority = priority;
+        job->browse = browse;
+        job->browse_sort_attribute = browse_sort_attribute;
+        job->browse_offset = browse_offset;
+        job->browse_seek_value = browse_seek_value;
+        job->browse_window_size = browse_window_size;
+        job->changed_since_usn = changed_since_usn;
+        job->changed_since_dc = changed_since_dc;
+        job->domain_dn = g_adconfig->domain_dn();
+
+        job_map().insert(key, job);
+
+        SearchJob *new_job = job;
+        connect(
+            new_job, &SearchJob::finished,
+            new_job,
+            [new_job]() {
+                if (job_map().value(new_job->key) == new_job) {
+                    job_map().remove(new_job->key);
+                }
+
+                new_job->deleteLater();
+            });
+
+        job->subscribe(this);
+
+        search_pool()->start(job, priority);
+    }
+}
+
+void SearchThread::stop() {
+    if (job == nullptr || is_finished) {
+        return;
+    }
+
+    disconnect(job, &SearchJob::finished, this, &SearchThread::on_job_finished);
+    job->unsubscribe(this);
+    job = nullptr;
+    is_finished = true;
+
+    // NOTE: emit finished() later, same as a stopped
+    // thread would, because callers may delete this
+    // thread in the finished() slot
+    QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+}
+
+void SearchThread::on_job_finished() {
+    if (job == nullptr) {
+        return;
     }
+
+    m_failed_to_connect = job->failed_to_connect;
+    m_hit_object_display_limit = job->hit_object_display_limit;
+    m_search_failed = job->search_failed;
+    browse_offset = job->browse_offset;
+    browse_count = job->browse_count;
+    left_guid_list = job->left_guid_list;
+    ad_messages = job->ad_messages;
+    highest_usn = job->highest_usn;
+    dc = job->dc;
+
+    disconnect(job, nullptr, this, nullptr);
+    job = nullptr;
+    is_finished = true;
+
+    emit finished();
 }
 
 int SearchThread::get_id() const {
@@ -103,9 +549,35 @@ QList<AdMessage> SearchThread::get_ad_messages() const {
     return ad_messages;
 }
 
+bool SearchThread::search_failed() const {
+    return m_search_failed;
+}
+
+int SearchThread::get_browse_offset() const {
+    return browse_offset;
+}
+
+int SearchThread::get_browse_count() const {
+    return browse_count;
+}
+
+QList<QByteArray> SearchThread::get_left_guid_list() const {
+    return left_guid_list;
+}
+
+qint64 SearchThread::get_highest_usn() const {
+    return highest_usn;
+}
+
+QString SearchThread::get_dc() const {
+    return dc;
+}
+
 void search_thread_display_errors(SearchThread *thread, QWidget *parent) {
     if (thread->failed_to_connect()) {
         error_log({QCoreApplication::translate("object_impl.cpp", "Failed to connect to server while searching for objects.")}, parent);
+    } else if (thread->search_failed()) {
+        error_log({QCoreApplication::translate("object_impl.cpp", "Search for objects failed, some objects may be missing.")}, parent);
     } else if (thread->hit_object_display_limit()) {
         error_log({QCoreApplication::translate("object_impl.cpp", "Could not load all objects. Increase object display limit in Filter Options or reduce number of objects by applying a filter. Filter Options is accessible from main window's menubar via the \"View\" menu.")}, parent);
     }
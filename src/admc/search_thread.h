@@ -22,52 +22,149 @@
 #define SEARCH_THREAD_H
 
 /**
- * A thread that performs an AD search operation. Useful for
- * searches that are expected to take a long time. For
- * regular small searches this is overkill. results_ready()
- * signal returns search results as they arrive. If search
- * has multiple pages, then results_ready() will be emitted
- * multiple times. Use stop() to stop search. Note that search is
- * not stopped immediately but when current results page is
- * done processing. Note that creator of thread should call
- * thread's deleteLater() in the finished() slot.
+ * Performs an AD search operation in the background.
+ * Useful for searches that are expected to take a long
+ * time. For regular small searches this is overkill.
+ * results_ready() signal returns search results as they
+ * arrive, in the order that server sent them, so results
+ * of sorted and VLV searches stay sorted. If search has
+ * multiple pages, then
+ * results_ready() will be emitted multiple times. Use
+ * stop() to stop search. Search stops shortly after, even
+ * if no results are arriving, and is abandoned on the
+ * server.
+ *
+ * Searches run on a shared pool with a limited amount of
+ * threads, so that loading many containers at once
+ * doesn't create a thread and a connection for each of
+ * them. Searches that wait in the queue are started in
+ * order of priority. If an identical search is already
+ * waiting or hasn't sent any results yet, new search
+ * joins it instead of running again.
+ *
+ * Note that creator of thread should call thread's
+ * deleteLater() in the finished() slot. finished() is
+ * emitted both when search completes and when it's
+ * stopped.
  */
 
-#include <QThread>
+#include <QObject>
 
 #include "ad_defines.h"
 
 class AdObject;
 class AdMessage;
+class SearchJob;
+
+enum SearchPriority {
+    // Prefetches, for example of expanded containers
+    SearchPriority_Background = 0,
+    // Results that user is looking at
+    SearchPriority_Visible = 1,
+};
 
-class SearchThread final : public QThread {
+class SearchThread final : public QObject {
     Q_OBJECT
 
+    friend SearchJob;
+
 public:
     SearchThread(const QString base, const SearchScope scope, const QString &filter, const QList<QString> attributes);
+    ~SearchThread();
+
+    // Stops thread with given id if it's still running.
+    // Use this when results of a search are not needed
+    // anymore, so that it doesn't keep the server busy.
+    // Must be called from the thread that created search
+    // threads.
+    static void stop_by_id(const int id);
+
+    // Moves search with given id ahead in the queue if
+    // it's still waiting to start
+    static void set_priority_by_id(const int id, const SearchPriority priority);
+
+    // Asks server to send results in this order, see
+    // AdSearch::set_sort_keys(). Call before starting.
+    void set_sort_keys(const QList<QString> &key_list);
 
+    // Reads highest committed USN of the DC before
+    // searching, so that objects changed after this search
+    // can be found later. Call before starting.
+    void set_track_changes(const bool track_changes);
+
+    // Loads only one window of results sorted by given
+    // attribute, see AdVlvSearch. Window starts at given
+    // offset or, if seek value is not empty, at first
+    // object whose sort attribute is greater or equal to
+    // it. Results are sent once, when the whole window is
+    // loaded. Call before starting.
+    void set_browse(const QString &sort_attribute, const int offset, const QString &seek_value, const int window_size);
+
+    // Searches only for objects that changed after given
+    // USN was read from given DC, see
+    // set_track_changes(). Objects which changed but are
+    // not in results, because they were deleted, moved
+    // away or don't match the filter anymore, are
+    // returned by get_left_guid_list(). Search fails if
+    // it connects to a different DC, because USN's of
+    // different DC's are unrelated. Call before starting.
+    void set_changed_since(const qint64 usn, const QString &dc);
+
+    void start(const SearchPriority priority = SearchPriority_Visible);
     void stop();
     int get_id() const;
     bool failed_to_connect() const;
     bool hit_object_display_limit() const;
     QList<AdMessage> get_ad_messages() const;
 
+    // Returns true if search failed after connecting
+    bool search_failed() const;
+
+    // Offset of the first object of loaded window and
+    // total amount of objects, for browsing searches
+    int get_browse_offset() const;
+    int get_browse_count() const;
+
+    // Returns objectGUID values of objects that left
+    // results, for searches of changes
+    QList<QByteArray> get_left_guid_list() const;
+
+    // Return -1 and empty string if changes weren't
+    // tracked or USN couldn't be read
+    qint64 get_highest_usn() const;
+    QString get_dc() const;
+
 signals:
-    void results_ready(const QHash<QString, AdObject> &results);
-    void over_object_display_limit();
+    void results_ready(const QList<AdObject> &results);
+    void finished();
 
 private:
-    bool stop_flag;
     QString base;
     SearchScope scope;
     QString filter;
     QList<QString> attributes;
+    QList<QString> sort_key_list;
+    bool track_changes;
+    bool browse;
+    QString browse_sort_attribute;
+    int browse_offset;
+    QString browse_seek_value;
+    int browse_window_size;
+    int browse_count;
+    qint64 changed_since_usn;
+    QString changed_since_dc;
+    QList<QByteArray> left_guid_list;
     int id;
+    SearchJob *job;
+    bool is_finished;
     bool m_failed_to_connect;
     bool m_hit_object_display_limit;
+    bool m_search_failed;
     QList<AdMessage> ad_messages;
+    qint64 highest_usn;
+    QString dc;
 
-    void run() override;
+    void on_job_finished();
 };
 
 // Call this in your finished() slot to display any
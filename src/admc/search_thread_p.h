@@ -0,0 +1,120 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEARCH_THREAD_P_H
+#define SEARCH_THREAD_P_H
+
+/**
+ * Search that is run by the shared pool. One job can
+ * serve multiple SearchThread's that requested the same
+ * search. Job lives in the GUI thread, but its run() is
+ * called from a pool thread.
+ */
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QObject>
+#include <QRunnable>
+#include <QSet>
+
+#include "ad_defines.h"
+#include "adldap.h"
+
+class SearchThread;
+
+class SearchJob final : public QObject, public QRunnable {
+    Q_OBJECT
+
+public:
+    SearchJob(const QString &key, const QString &base, const SearchScope scope, const QString &filter, const QList<QString> &attributes, const QList<QString> &sort_key_list, const bool track_changes, const int object_display_limit);
+
+    const QString key;
+    int priority;
+
+    // NOTE: set these before job is started, see
+    // SearchThread::set_browse()
+    bool browse;
+    QString browse_sort_attribute;
+    int browse_offset;
+    QString browse_seek_value;
+    int browse_window_size;
+
+    // NOTE: set these before job is started, see
+    // SearchThread::set_changed_since(). Usn is -1 if
+    // search is not for changes.
+    qint64 changed_since_usn;
+    QString changed_since_dc;
+    QString domain_dn;
+
+    // Connects search thread to this job. Returns false
+    // if job has already sent some results or finished,
+    // in which case thread needs a job of its own.
+    bool subscribe(SearchThread *thread);
+
+    // Disconnects search thread from this job. Job stops
+    // when there are no threads left.
+    void unsubscribe(SearchThread *thread);
+
+    void run() override;
+
+    // NOTE: these are only valid after finished() was
+    // emitted
+    bool failed_to_connect;
+    bool hit_object_display_limit;
+    bool search_failed;
+    int browse_count;
+    QList<QByteArray> left_guid_list;
+    QList<AdMessage> ad_messages;
+    qint64 highest_usn;
+    QString dc;
+
+signals:
+    void results_ready(const QList<AdObject> &results);
+    void finished();
+
+private:
+    QString base;
+    SearchScope scope;
+    QString filter;
+    QList<QString> attributes;
+    QList<QString> sort_key_list;
+    bool track_changes;
+    int object_display_limit;
+
+    QAtomicInt stop_flag;
+
+    // NOTE: mutex protects subscribing against results
+    // being sent at the same time
+    QMutex mutex;
+    bool sent_results;
+    bool done;
+    int subscriber_count;
+
+    // Objects that changed but weren't found in results
+    // yet, for searches of changes
+    QSet<QByteArray> left_guid_set;
+
+    void run_search(AdInterface &ad);
+    void run_browse(AdInterface &ad);
+    void run_changes(AdInterface &ad);
+    void send_results(AdInterface &ad, const QList<AdObject> &results);
+};
+
+#endif /* SEARCH_THREAD_P_H */
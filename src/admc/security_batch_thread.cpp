@@ -0,0 +1,55 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "security_batch_thread.h"
+
+#include "adldap.h"
+
+SecurityBatchThread::SecurityBatchThread(const QList<QString> &target_list, const QList<AdSecurityEdit> &edit_list) {
+    batch = new AdSecurityBatch(target_list, edit_list);
+    m_success = false;
+}
+
+SecurityBatchThread::~SecurityBatchThread() {
+    delete batch;
+}
+
+void SecurityBatchThread::stop() {
+    batch->stop();
+}
+
+bool SecurityBatchThread::success() const {
+    return m_success;
+}
+
+QList<AdMessage> SecurityBatchThread::get_message_list() const {
+    return message_list;
+}
+
+void SecurityBatchThread::run() {
+    m_success = batch->run(
+        [this](const AdSecurityBatchResult &result) {
+            message_list.append(result.message_list);
+
+            emit progress_changed(batch->done_count());
+
+            return true;
+        });
+}
@@ -0,0 +1,68 @@
+/*
+ * ADMC - AD Management Center
+ *
+ * Copyright (C) 2020-2022 BaseALT Ltd.
+ * Copyright (C) 2020-2022 Dmitry Degtyarev
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SECURITY_BATCH_THREAD_H
+#define SECURITY_BATCH_THREAD_H
+
+/**
+ * A thread that runs AdSecurityBatch, so that the GUI
+ * thread isn't blocked while permissions of many objects
+ * are changed. Progress is reported through a signal,
+ * which should be connected with a queued connection.
+ * Results can be read after the thread has finished.
+ */
+
+#include <QThread>
+
+#include <QList>
+#include <QString>
+
+class AdMessage;
+class AdSecurityBatch;
+class AdSecurityEdit;
+
+class SecurityBatchThread final : public QThread {
+    Q_OBJECT
+
+public:
+    SecurityBatchThread(const QList<QString> &target_list, const QList<AdSecurityEdit> &edit_list);
+    ~SecurityBatchThread();
+
+    // NOTE: targets that are being changed when this is
+    // called are finished, others are left unchanged
+    void stop();
+
+    // Returns true if changes were applied to all targets
+    bool success() const;
+
+    QList<AdMessage> get_message_list() const;
+
+signals:
+    void progress_changed(const int done_count);
+
+private:
+    AdSecurityBatch *batch;
+    bool m_success;
+    QList<AdMessage> message_list;
+
+    void run() override;
+};
+
+#endif /* SECURITY_BATCH_THREAD_H */
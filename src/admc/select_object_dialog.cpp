@@ -215,25 +215,37 @@ void SelectObjectDialog::add_objects_to_list(const QList<QString> &dn_list) {
 // NOTE: this is slightly inefficient because we search for
 // objects again, when they already were searched for by
 // callers of this f-n, in other words we don't reuse search
-// results. For majority of cases this is fine. For rare
-// cases where user is selecting truly huge amounts of
-// objects, they can wait. The alternative of caching
-// objects everywhere adds too much complexity.
+// results. Objects are searched for in one batch, so this
+// is fine even for large amounts of objects. The
+// alternative of caching objects everywhere adds too much
+// complexity.
 void SelectObjectDialog::add_objects_to_list(const QList<QString> &dn_list, AdInterface &ad) {
     const QList<QString> current_selected_list = get_selected();
 
     bool any_duplicates = false;
 
-    for (const QString &dn : dn_list) {
-        const bool is_duplicate = current_selected_list.contains(dn);
+    const QList<QString> new_dn_list = [&]() {
+        QList<QString> out;
 
-        if (is_duplicate) {
-            any_duplicates = true;
-        } else {
-            const AdObject object = ad.search_object(dn);
+        for (const QString &dn : dn_list) {
+            const bool is_duplicate = current_selected_list.contains(dn);
 
-            add_select_object_to_model(model, object);
+            if (is_duplicate) {
+                any_duplicates = true;
+            } else {
+                out.append(dn);
+            }
         }
+
+        return out;
+    }();
+
+    const QHash<QString, AdObject> object_map = ad.search_objects(new_dn_list);
+
+    for (const QString &dn : new_dn_list) {
+        const AdObject object = object_map.value(dn);
+
+        add_select_object_to_model(model, object);
     }
 
     if (any_duplicates) {
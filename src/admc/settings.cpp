@@ -46,11 +46,14 @@ const QHash<QString, QVariant> setting_default_map = {
     {SETTING_timestamp_log, true},
     {SETTING_sasl_nocanon, true},
     {SETTING_show_login, true},
+    {SETTING_live_updates, false},
     {SETTING_host, QString()},
     {SETTING_object_filter, QString()},
     {SETTING_object_filter_enabled, false},
     {SETTING_cert_strategy, CERT_STRATEGY_NEVER_define},
     {SETTING_object_display_limit, 1000},
+    {SETTING_page_size, 1000},
+    {SETTING_adaptive_page_size, true},
 
     {SETTING_feature_logon_computers, false},
     {SETTING_feature_profile_tab, false},
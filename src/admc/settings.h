@@ -119,6 +119,7 @@ DEFINE_SETTING(SETTING_log_searches);
 DEFINE_SETTING(SETTING_timestamp_log);
 DEFINE_SETTING(SETTING_sasl_nocanon);
 DEFINE_SETTING(SETTING_show_login);
+DEFINE_SETTING(SETTING_live_updates);
 DEFINE_SETTING(SETTING_show_password);
 DEFINE_SETTING(SETTING_domain_is_default);
 
@@ -133,6 +134,8 @@ DEFINE_SETTING(SETTING_last_opened_version);
 DEFINE_SETTING(SETTING_object_filter);
 DEFINE_SETTING(SETTING_object_filter_enabled);
 DEFINE_SETTING(SETTING_object_display_limit);
+DEFINE_SETTING(SETTING_page_size);
+DEFINE_SETTING(SETTING_adaptive_page_size);
 DEFINE_SETTING(SETTING_custom_domain)
 
 // Feature flags
@@ -134,12 +134,14 @@ void MembershipTabEdit::load(AdInterface &ad, const AdObject &object) {
             const QString base = g_adconfig->domain_dn();
             const SearchScope scope = SearchScope_All;
             const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_PRIMARY_GROUP_ID, group_rid);
-            const QList<QString> attributes = QList<QString>();
-            const QHash<QString, AdObject> results = ad.search(base, scope, filter, attributes);
+            const QList<QString> attributes = {ATTRIBUTE_DN};
 
-            for (const QString &user : results.keys()) {
-                original_primary_values.insert(user);
-            }
+            ad.search_iterate(base, scope, filter, attributes,
+                [&](const AdObject &user) {
+                    original_primary_values.insert(user.get_dn());
+
+                    return true;
+                });
 
             break;
         }
@@ -158,14 +160,10 @@ void MembershipTabEdit::load(AdInterface &ad, const AdObject &object) {
             const int cut_index = user_sid_string.lastIndexOf("-") + 1;
             const QString group_sid = user_sid_string.left(cut_index) + group_rid;
 
-            const QString base = g_adconfig->domain_dn();
-            const SearchScope scope = SearchScope_All;
-            const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_SID, group_sid);
-            const QList<QString> attributes = QList<QString>();
-            const QHash<QString, AdObject> results = ad.search(base, scope, filter, attributes);
-
-            if (!results.isEmpty()) {
-                const QString group_dn = results.values()[0].get_dn();
+            // NOTE: many users share the same primary
+            // group, so it's usually resolved from cache
+            const QString group_dn = AdSidResolver::get_dn(ad, sid_string_to_bytes(group_sid));
+            if (!group_dn.isEmpty()) {
                 original_primary_values.insert(group_dn);
             }
 
@@ -240,6 +240,8 @@ void SecurityTabEdit::load_current_sd(AdInterface &ad) {
         }
     }();
 
+    right_matrix = SecurityRightMatrix(sd);
+
     // Load trustee model
     trustee_model->removeRows(0, trustee_model->rowCount());
     const QList<QByteArray> trustee_list = security_descriptor_get_trustee_list(sd);
@@ -342,7 +344,7 @@ void SecurityTabEdit::load_rights_model() {
             const uint32_t access_mask = item->data(RightsItemRole_AccessMask).toUInt();
 
             const QByteArray object_type = item->data(RightsItemRole_ObjectType).toByteArray();
-            const SecurityRightState out = security_descriptor_get_right(sd, trustee, access_mask, object_type);
+            const SecurityRightState out = right_matrix.get(trustee, access_mask, object_type);
 
             return out;
         }();
@@ -438,6 +440,8 @@ void SecurityTabEdit::on_item_changed(QStandardItem *item) {
         security_descriptor_remove_right(sd, g_adconfig, target_class_list, trustee, access_mask, object_type, allow);
     }
 
+    right_matrix = SecurityRightMatrix(sd);
+
     load_rights_model();
 
     emit edited();
@@ -555,6 +559,10 @@ void SecurityTabEdit::add_trustees(const QList<QByteArray> &sid_list, AdInterfac
         return out;
     }();
 
+    // NOTE: resolve all names at once, instead of
+    // searching for each trustee separately
+    const QHash<QByteArray, QString> name_map = AdSidResolver::get_names(ad, sid_list);
+
     bool added_anything = false;
     bool failed_to_add_because_already_exists = false;
 
@@ -568,7 +576,7 @@ void SecurityTabEdit::add_trustees(const QList<QByteArray> &sid_list, AdInterfac
         }
 
         auto item = new QStandardItem();
-        const QString name = ad_security_get_trustee_name(ad, sid);
+        const QString name = name_map[sid];
         item->setText(name);
         item->setData(sid, TrusteeItemRole_Sid);
         trustee_model->appendRow(item);
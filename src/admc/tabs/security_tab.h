@@ -25,6 +25,7 @@
 #include <QWidget>
 
 #include "ad_defines.h"
+#include "ad_security.h"
 
 #include <QDialog>
 
@@ -88,6 +89,7 @@ private:
     bool is_policy;
     bool ignore_item_changed_signal;
     security_descriptor *sd;
+    SecurityRightMatrix right_matrix;
     QList<QString> target_class_list;
     bool read_only;
 
@@ -55,6 +55,7 @@
 
 void ADMCTest::initTestCase() {
     qRegisterMetaType<QHash<QString, AdObject>>("QHash<QString, AdObject>");
+    qRegisterMetaType<QList<AdObject>>("QList<AdObject>");
 
     QVERIFY2(ad.is_connected(), "Failed to connect to AD server");
 
@@ -23,7 +23,10 @@
 #include "globals.h"
 #include "samba/dom_sid.h"
 
+#include <QDir>
+#include <QTemporaryDir>
 #include <QTest>
+#include <algorithm>
 
 #define TEST_GPO "ADMCTestAdInterface_TEST_GPO"
 
@@ -88,6 +91,73 @@ void ADMCTestAdInterface::create_and_gpo_delete() {
     QCOMPARE(linked_after, false);
 }
 
+void ADMCTestAdInterface::gplink_index() {
+    QString gpo_dn;
+    const bool create_success = ad.gpo_add(TEST_GPO, gpo_dn);
+    QVERIFY(create_success);
+
+    const QString ou_dn = test_object_dn(TEST_OU, CLASS_OU);
+    ad.object_add(ou_dn, CLASS_OU);
+
+    auto index_contains_ou = [&]() {
+        const QList<AdObject> link_list = AdGplinkIndex::get_links(ad, gpo_dn);
+
+        for (const AdObject &object : link_list) {
+            if (object.get_dn().toLower() == ou_dn.toLower()) {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    // Checks that index wasn't dropped by a change and
+    // that it has the new gPLink of OU
+    auto index_has_gplink = [&](const QString &expected_gplink) {
+        QString loaded_gplink;
+        const bool index_loaded = AdGplinkIndex::get_loaded_gplink(ou_dn, &loaded_gplink);
+
+        return (index_loaded && loaded_gplink == expected_gplink);
+    };
+
+    Gplink gplink;
+    gplink.add(gpo_dn);
+    const QString gplink_string = gplink.to_string();
+
+    // Load index before linking. OU isn't in the index
+    // yet, so linking drops the index and it's loaded
+    // again.
+    QCOMPARE(index_contains_ou(), false);
+
+    ad.attribute_replace_string(ou_dn, ATTRIBUTE_GPLINK, gplink_string);
+    QCOMPARE(index_contains_ou(), true);
+
+    // Index should match a fresh load
+    AdGplinkIndex::clear();
+    QCOMPARE(index_contains_ou(), true);
+
+    // Now that OU is in the index, changes of its gPLink
+    // should update the index in place
+    ad.attribute_replace_string(ou_dn, ATTRIBUTE_GPLINK, QString());
+    QVERIFY(index_has_gplink(QString()));
+    QCOMPARE(index_contains_ou(), false);
+
+    ad.attribute_add_value(ou_dn, ATTRIBUTE_GPLINK, gplink_string.toUtf8());
+    QVERIFY(index_has_gplink(gplink_string));
+    QCOMPARE(index_contains_ou(), true);
+
+    ad.attribute_delete_value(ou_dn, ATTRIBUTE_GPLINK, gplink_string.toUtf8());
+    QVERIFY(index_has_gplink(QString()));
+    QCOMPARE(index_contains_ou(), false);
+
+    ad.attribute_replace_string(ou_dn, ATTRIBUTE_GPLINK, gplink_string);
+    QVERIFY(index_has_gplink(gplink_string));
+    QCOMPARE(index_contains_ou(), true);
+
+    bool deleted_object;
+    ad.gpo_delete(gpo_dn, &deleted_object);
+}
+
 void ADMCTestAdInterface::gpo_check_perms() {
     QString gpc_dn;
     const bool create_success = ad.gpo_add(TEST_GPO, gpc_dn);
@@ -128,6 +198,307 @@ void ADMCTestAdInterface::gpo_check_perms() {
     QVERIFY(delete_success);
 }
 
+void ADMCTestAdInterface::search_all_pages() {
+    // NOTE: create more objects than fit in one page to
+    // check that search goes through all pages
+    const int object_count = 150;
+    for (int i = 0; i < object_count; i++) {
+        const QString name = QString("%1-%2").arg(TEST_OU, QString::number(i));
+        const QString dn = test_object_dn(name, CLASS_OU);
+        const bool add_success = ad.object_add(dn, CLASS_OU);
+        QVERIFY(add_success);
+    }
+
+    const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_OU);
+    const QList<QString> attributes = {ATTRIBUTE_NAME};
+
+    const QHash<QString, AdObject> results = ad.search(test_arena_dn(), SearchScope_Children, filter, attributes);
+    QCOMPARE(results.size(), object_count);
+
+    AdSearch search(ad, test_arena_dn(), SearchScope_Children, filter, attributes);
+    int entry_count = 0;
+    int page_count = 0;
+    while (true) {
+        AdObject object;
+        const AdSearchStatus status = search.next(&object);
+        QVERIFY(status != AdSearchStatus_Error);
+
+        if (status == AdSearchStatus_Entry) {
+            QVERIFY(results.contains(object.get_dn()));
+            entry_count++;
+        } else {
+            page_count++;
+
+            if (status == AdSearchStatus_Finished) {
+                break;
+            }
+        }
+    }
+    QCOMPARE(entry_count, object_count);
+    QVERIFY(page_count > 1);
+}
+
+void ADMCTestAdInterface::search_cancel() {
+    // NOTE: create more objects than fit in one page, so
+    // that search is cancelled with next page in progress
+    const int object_count = 150;
+    for (int i = 0; i < object_count; i++) {
+        const QString name = QString("%1-%2").arg(TEST_OU, QString::number(i));
+        const QString dn = test_object_dn(name, CLASS_OU);
+        const bool add_success = ad.object_add(dn, CLASS_OU);
+        QVERIFY(add_success);
+    }
+
+    const QString filter = filter_CONDITION(Condition_Equals, ATTRIBUTE_OBJECT_CLASS, CLASS_OU);
+    const QList<QString> attributes = {ATTRIBUTE_NAME};
+
+    AdSearch search(ad, test_arena_dn(), SearchScope_Children, filter, attributes);
+    while (true) {
+        AdObject object;
+        const AdSearchStatus status = search.next(&object);
+        QVERIFY(status == AdSearchStatus_Entry || status == AdSearchStatus_PageDone);
+
+        if (status == AdSearchStatus_PageDone) {
+            break;
+        }
+    }
+
+    search.cancel();
+
+    AdObject object;
+    QCOMPARE(search.next(&object), AdSearchStatus_Finished);
+
+    // Connection should still be usable and no results of
+    // cancelled search should arrive
+    const QHash<QString, AdObject> results = ad.search(test_arena_dn(), SearchScope_Children, filter, attributes);
+    QCOMPARE(results.size(), object_count);
+}
+
+void ADMCTestAdInterface::object_load_values() {
+    const QHash<QString, QList<QByteArray>> data = {
+        {ATTRIBUTE_OBJECT_CLASS, {"top", "organizationalUnit"}},
+        {ATTRIBUTE_NAME, {"test"}},
+        {ATTRIBUTE_DESCRIPTION, {}},
+    };
+
+    AdObject object;
+    object.load("OU=test,DC=test", data);
+
+    QCOMPARE(object.get_dn(), QString("OU=test,DC=test"));
+    QCOMPARE(object.get_values(ATTRIBUTE_OBJECT_CLASS), data[ATTRIBUTE_OBJECT_CLASS]);
+    QCOMPARE(object.get_string(ATTRIBUTE_OBJECT_CLASS), QString("organizationalUnit"));
+    QCOMPARE(object.get_value(ATTRIBUTE_NAME), QByteArray("test"));
+    QVERIFY(object.contains(ATTRIBUTE_DESCRIPTION));
+    QVERIFY(object.get_values(ATTRIBUTE_DESCRIPTION).isEmpty());
+    QVERIFY(!object.contains(ATTRIBUTE_MAIL));
+    QVERIFY(object.get_value(ATTRIBUTE_MAIL).isNull());
+    QCOMPARE(object.get_attributes_data(), data);
+
+    // Objects loaded from search should give the same
+    // values as a full copy of their data
+    const AdObject domain_object = ad.search_object(g_adconfig->domain_dn());
+    AdObject domain_copy;
+    domain_copy.load(domain_object.get_dn(), domain_object.get_attributes_data());
+    for (const QString &attribute : domain_object.attributes()) {
+        QCOMPARE(domain_copy.get_values(attribute), domain_object.get_values(attribute));
+    }
+}
+
+void ADMCTestAdInterface::search_objects() {
+    QList<QString> dn_list;
+    for (int i = 0; i < 5; i++) {
+        const QString name = QString("%1-%2").arg(TEST_OU, QString::number(i));
+        const QString dn = test_object_dn(name, CLASS_OU);
+        const bool add_success = ad.object_add(dn, CLASS_OU);
+        QVERIFY(add_success);
+
+        dn_list.append(dn);
+    }
+
+    const QString missing_dn = test_object_dn(TEST_USER, CLASS_USER);
+
+    const QHash<QString, AdObject> results = ad.search_objects(dn_list + QList<QString>({missing_dn}), {ATTRIBUTE_NAME});
+    QCOMPARE(results.size(), dn_list.size());
+    QVERIFY(!results.contains(missing_dn));
+
+    for (const QString &dn : dn_list) {
+        QVERIFY(results.contains(dn));
+        QCOMPARE(results[dn].get_string(ATTRIBUTE_NAME), dn_get_name(dn));
+    }
+}
+
+void ADMCTestAdInterface::search_vlv() {
+    if (!g_adconfig->control_is_supported(LDAP_SERVER_SORT_OID) || !g_adconfig->control_is_supported(LDAP_SERVER_VLV_OID)) {
+        QSKIP("Server doesn't support sort and vlv controls");
+    }
+
+    const QList<QString> name_list = add_ous_in_reverse_order();
+    QVERIFY(!name_list.isEmpty());
+
+    AdVlvSearch search(ad, test_arena_dn(), SearchScope_Children, QString(), {ATTRIBUTE_NAME}, ATTRIBUTE_NAME);
+
+    auto get_names = [](const QList<AdObject> &object_list) {
+        QList<QString> out;
+
+        for (const AdObject &object : object_list) {
+            out.append(object.get_string(ATTRIBUTE_NAME));
+        }
+
+        return out;
+    };
+
+    QList<AdObject> window;
+    const bool window_success = search.get_window(1, 2, &window);
+    QVERIFY(window_success);
+    QCOMPARE(get_names(window), name_list.mid(1, 2));
+    QCOMPARE(search.offset(), 1);
+    QCOMPARE(search.count(), name_list.size());
+
+    QList<AdObject> seek_window;
+    const bool seek_success = search.seek(name_list[3], 2, &seek_window);
+    QVERIFY(seek_success);
+    QCOMPARE(get_names(seek_window), name_list.mid(3, 2));
+    QCOMPARE(search.offset(), 3);
+}
+
+void ADMCTestAdInterface::search_sorted() {
+    if (!g_adconfig->control_is_supported(LDAP_SERVER_SORT_OID)) {
+        QSKIP("Server doesn't support sort control");
+    }
+
+    QList<QString> name_list = add_ous_in_reverse_order();
+    QVERIFY(!name_list.isEmpty());
+
+    auto search_names = [&](const QList<QString> &sort_key_list) {
+        QList<QString> out;
+
+        const bool success = ad.search_iterate(test_arena_dn(), SearchScope_Children, QString(), {ATTRIBUTE_NAME},
+            [&](const AdObject &object) {
+                out.append(object.get_string(ATTRIBUTE_NAME));
+
+                return true;
+            },
+            false, sort_key_list);
+
+        if (!success) {
+            return QList<QString>();
+        }
+
+        return out;
+    };
+
+    QCOMPARE(search_names({ATTRIBUTE_NAME}), name_list);
+
+    std::reverse(name_list.begin(), name_list.end());
+    QCOMPARE(search_names({"-" + QString(ATTRIBUTE_NAME)}), name_list);
+}
+
+void ADMCTestAdInterface::search_changes() {
+    const qint64 old_usn = ad.get_highest_committed_usn();
+    QVERIFY(old_usn != -1);
+
+    const QString dn = test_object_dn(TEST_USER, CLASS_USER);
+    const bool add_success = ad.object_add(dn, CLASS_USER);
+    QVERIFY(add_success);
+
+    const QString usn_filter = QString("(%1>=%2)").arg(ATTRIBUTE_USN_CHANGED, QString::number(old_usn + 1));
+
+    const QHash<QString, AdObject> changed = ad.search(test_arena_dn(), SearchScope_Children, usn_filter, {ATTRIBUTE_DN});
+    QVERIFY(changed.contains(dn));
+
+    const bool delete_success = ad.object_delete(dn);
+    QVERIFY(delete_success);
+
+    // Deleted object should be found as a tombstone whose
+    // last known parent is the arena
+    const QString deleted_filter = filter_AND({
+        usn_filter,
+        filter_CONDITION(Condition_Equals, ATTRIBUTE_IS_DELETED, LDAP_BOOL_TRUE),
+        filter_CONDITION(Condition_Equals, ATTRIBUTE_LAST_KNOWN_PARENT, test_arena_dn()),
+    });
+
+    AdSearch search(ad, g_adconfig->domain_dn(), SearchScope_All, deleted_filter, {ATTRIBUTE_NAME});
+    search.set_show_deleted(true);
+
+    QList<QString> deleted_name_list;
+    while (true) {
+        AdObject object;
+        const AdSearchStatus status = search.next(&object);
+
+        if (status == AdSearchStatus_Entry) {
+            deleted_name_list.append(object.get_string(ATTRIBUTE_NAME).split('\n')[0]);
+        } else {
+            QVERIFY(status != AdSearchStatus_Error);
+
+            if (status == AdSearchStatus_Finished) {
+                break;
+            }
+        }
+    }
+
+    QVERIFY(deleted_name_list.contains(TEST_USER));
+}
+
+void ADMCTestAdInterface::adconfig_cache() {
+    QTemporaryDir cache_dir;
+    QVERIFY(cache_dir.isValid());
+
+    AdConfig::set_cache_dir(cache_dir.path());
+
+    // First load saves the cache, second one loads it
+    AdConfig fetched_config;
+    fetched_config.load(ad, QLocale(QLocale::English));
+    QVERIFY(!QDir(cache_dir.path()).entryList(QDir::Files).isEmpty());
+
+    AdConfig cached_config;
+    cached_config.load(ad, QLocale(QLocale::English));
+
+    AdConfig::set_cache_dir(QString());
+
+    // Fetch reports each fetch phase, cached load reports
+    // only loading the cache
+    auto get_phase_list = [](const AdConfig &config) {
+        QList<QString> out;
+
+        for (const AdConfigLoadTiming &timing : config.get_load_timing_list()) {
+            out.append(timing.phase);
+        }
+
+        return out;
+    };
+    const QList<QString> fetched_phase_list = get_phase_list(fetched_config);
+    const QList<QString> cached_phase_list = get_phase_list(cached_config);
+    QVERIFY(fetched_phase_list.contains("fetch"));
+    QVERIFY(fetched_phase_list.size() > 3);
+    QCOMPARE(cached_phase_list, QList<QString>({"cache", "process"}));
+
+    QCOMPARE(cached_config.get_columns(), fetched_config.get_columns());
+    QCOMPARE(cached_config.get_filter_containers(), fetched_config.get_filter_containers());
+    QCOMPARE(cached_config.get_class_display_name(CLASS_USER), fetched_config.get_class_display_name(CLASS_USER));
+    QCOMPARE(cached_config.get_attribute_type(ATTRIBUTE_OBJECT_SID), fetched_config.get_attribute_type(ATTRIBUTE_OBJECT_SID));
+    QCOMPARE(cached_config.get_possible_superiors({CLASS_USER}), fetched_config.get_possible_superiors({CLASS_USER}));
+    QCOMPARE(cached_config.get_extended_rights_list({CLASS_USER}), fetched_config.get_extended_rights_list({CLASS_USER}));
+    QCOMPARE(cached_config.get_filter_containers(), g_adconfig->get_filter_containers());
+}
+
+void ADMCTestAdInterface::adconfig_attribute_descriptors() {
+    QCOMPARE(g_adconfig->get_attribute_type(ATTRIBUTE_OBJECT_SID), AttributeType_Sid);
+    QCOMPARE(g_adconfig->get_attribute_type(ATTRIBUTE_ACCOUNT_EXPIRES), AttributeType_LargeInteger);
+    QCOMPARE(g_adconfig->get_attribute_large_integer_subtype(ATTRIBUTE_ACCOUNT_EXPIRES), LargeIntegerSubtype_Datetime);
+    QCOMPARE(g_adconfig->get_attribute_large_integer_subtype(ATTRIBUTE_MAX_PWD_AGE), LargeIntegerSubtype_Timespan);
+    QVERIFY(g_adconfig->get_attribute_is_number(ATTRIBUTE_USER_ACCOUNT_CONTROL));
+    QVERIFY(g_adconfig->get_attribute_is_single_valued(ATTRIBUTE_SAM_ACCOUNT_NAME));
+    QVERIFY(!g_adconfig->get_attribute_is_single_valued(ATTRIBUTE_MEMBER));
+    QVERIFY(g_adconfig->get_attribute_is_backlink(ATTRIBUTE_MEMBER_OF));
+    QVERIFY(!g_adconfig->get_attribute_is_backlink(ATTRIBUTE_MEMBER));
+
+    // Attributes that are not in schema get default values
+    const QString unknown_attribute = "admcUnknownAttribute";
+    QCOMPARE(g_adconfig->get_attribute_type(unknown_attribute), AttributeType_StringCase);
+    QVERIFY(!g_adconfig->get_attribute_is_single_valued(unknown_attribute));
+    QCOMPARE(g_adconfig->get_attribute_range_upper(unknown_attribute), 0);
+}
+
 void ADMCTestAdInterface::object_add() {
     const QString dn = test_object_dn(TEST_USER, CLASS_USER);
 
@@ -257,4 +628,21 @@ void ADMCTestAdInterface::user_set_account_option() {
     }
 }
 
+QList<QString> ADMCTestAdInterface::add_ous_in_reverse_order() {
+    QList<QString> name_list;
+
+    for (int i = 4; i >= 0; i--) {
+        const QString name = QString("%1-%2").arg(TEST_OU, QString::number(i));
+        const QString dn = test_object_dn(name, CLASS_OU);
+        const bool add_success = ad.object_add(dn, CLASS_OU);
+        if (!add_success) {
+            return QList<QString>();
+        }
+
+        name_list.prepend(name);
+    }
+
+    return name_list;
+}
+
 QTEST_MAIN(ADMCTestAdInterface)
@@ -31,6 +31,17 @@ private slots:
 
     void create_and_gpo_delete();
     void gpo_check_perms();
+    void gplink_index();
+
+    void search_all_pages();
+    void search_cancel();
+    void object_load_values();
+    void search_objects();
+    void search_vlv();
+    void search_sorted();
+    void search_changes();
+    void adconfig_cache();
+    void adconfig_attribute_descriptors();
 
     void object_add();
     void object_delete();
@@ -45,6 +56,11 @@ private slots:
     void user_set_account_option();
 
 private:
+    // Creates a few OU's in test arena, in reverse order of
+    // their names, so that search results can't be sorted
+    // by accident. Returns names in sorted order, or an
+    // empty list if creating failed.
+    QList<QString> add_ous_in_reverse_order();
 };
 
 #endif /* ADMC_TEST_AD_INTERFACE_H */
@@ -21,7 +21,13 @@
 #include "admc_test_ad_security.h"
 
 #include "ad_security.h"
+#include "samba/dom_sid.h"
 #include "samba/ndr_security.h"
+#include "samba/security_descriptor.h"
+
+#include <QSet>
+
+#include <cstring>
 
 // NOTE: using "int" instead of "uint32_t" for test
 // data because "uint32_t" is not supported by
@@ -357,6 +363,186 @@ void ADMCTestAdSecurity::add_to_unset_opposite_superior() {
     check_state(test_trustee, SEC_ADS_GENERIC_ALL, QByteArray(), expected_full_control);
 }
 
+void ADMCTestAdSecurity::resolve_sid_names() {
+    const AdObject user = ad.search_object(test_user_dn);
+    const QByteArray user_sid = user.get_value(ATTRIBUTE_OBJECT_SID);
+    const QByteArray world_sid = sid_string_to_bytes(SID_WORLD);
+    const QString unknown_sid_string = "S-1-5-21-1-2-3-4000000";
+    const QByteArray unknown_sid = sid_string_to_bytes(unknown_sid_string);
+
+    const QHash<QByteArray, QString> name_map = AdSidResolver::get_names(ad, {user_sid, world_sid, unknown_sid});
+    QCOMPARE(name_map.value(user_sid), user.get_string(ATTRIBUTE_SAM_ACCOUNT_NAME));
+    QCOMPARE(name_map.value(world_sid), ad_security_get_well_known_trustee_name(world_sid));
+    QCOMPARE(name_map.value(unknown_sid), unknown_sid_string);
+
+    QCOMPARE(AdSidResolver::get_dn(ad, user_sid), test_user_dn);
+    QCOMPARE(AdSidResolver::get_dn(ad, unknown_sid), QString());
+}
+
+// Matrix should give same states as getting each right
+// separately
+void ADMCTestAdSecurity::right_matrix() {
+    security_descriptor_add_right(sd, ad.adconfig(), class_list, test_trustee, SEC_ADS_GENERIC_READ, QByteArray(), true);
+    security_descriptor_add_right(sd, ad.adconfig(), class_list, test_trustee, SEC_ADS_CREATE_CHILD, QByteArray(), false);
+
+    const SecurityRightMatrix matrix = SecurityRightMatrix(sd);
+
+    const QList<SecurityRight> right_list = ad_security_get_right_list_for_class(ad.adconfig(), class_list);
+    const QList<QByteArray> trustee_list = security_descriptor_get_trustee_list(sd);
+    QVERIFY(!right_list.isEmpty());
+    QVERIFY(trustee_list.contains(test_trustee));
+
+    for (const QByteArray &trustee : trustee_list) {
+        for (const SecurityRight &right : right_list) {
+            const SecurityRightState expected = security_descriptor_get_right(sd, trustee, right.access_mask, right.object_type);
+            const SecurityRightState actual = matrix.get(trustee, right.access_mask, right.object_type);
+
+            for (int inherited_i = 0; inherited_i < SecurityRightStateInherited_COUNT; inherited_i++) {
+                for (int type_i = 0; type_i < SecurityRightStateType_COUNT; type_i++) {
+                    const SecurityRightStateInherited inherited = (SecurityRightStateInherited) inherited_i;
+                    const SecurityRightStateType type = (SecurityRightStateType) type_i;
+
+                    QCOMPARE(actual.get(inherited, type), expected.get(inherited, type));
+                }
+            }
+        }
+    }
+}
+
+// Effective matrix should skip inherit only ACE's and
+// ACE's scoped to classes that object doesn't have
+void ADMCTestAdSecurity::right_matrix_effective() {
+    const QByteArray user_guid = ad.adconfig()->class_to_guid(CLASS_USER);
+    const QByteArray group_guid = ad.adconfig()->class_to_guid(CLASS_GROUP);
+    QVERIFY(!user_guid.isEmpty());
+    QVERIFY(!group_guid.isEmpty());
+
+    add_allow_ace(sd, SEC_ADS_CREATE_CHILD, SEC_ACE_FLAG_INHERITED_ACE, user_guid);
+    add_allow_ace(sd, SEC_ADS_DELETE_CHILD, SEC_ACE_FLAG_INHERITED_ACE, group_guid);
+    add_allow_ace(sd, SEC_ADS_LIST, SEC_ACE_FLAG_CONTAINER_INHERIT | SEC_ACE_FLAG_INHERIT_ONLY, QByteArray());
+
+    const SecurityRightMatrix full_matrix = SecurityRightMatrix(sd);
+    const SecurityRightMatrix user_matrix = SecurityRightMatrix(sd, {user_guid});
+    const SecurityRightMatrix group_matrix = SecurityRightMatrix(sd, {group_guid});
+
+    auto allowed = [&](const SecurityRightMatrix &matrix, const uint32_t access_mask) {
+        const SecurityRightState state = matrix.get(test_trustee, access_mask, QByteArray());
+
+        return state.get(SecurityRightStateInherited_Yes, SecurityRightStateType_Allow);
+    };
+
+    QVERIFY(allowed(full_matrix, SEC_ADS_CREATE_CHILD));
+    QVERIFY(allowed(full_matrix, SEC_ADS_DELETE_CHILD));
+
+    QVERIFY(allowed(user_matrix, SEC_ADS_CREATE_CHILD));
+    QVERIFY(!allowed(user_matrix, SEC_ADS_DELETE_CHILD));
+
+    QVERIFY(!allowed(group_matrix, SEC_ADS_CREATE_CHILD));
+    QVERIFY(allowed(group_matrix, SEC_ADS_DELETE_CHILD));
+
+    const SecurityRightState list_state = user_matrix.get(test_trustee, SEC_ADS_LIST, QByteArray());
+    QVERIFY(!list_state.get(SecurityRightStateInherited_No, SecurityRightStateType_Allow));
+}
+
+void ADMCTestAdSecurity::acl_audit() {
+    security_descriptor_add_right(sd, ad.adconfig(), class_list, test_trustee, SEC_ADS_CREATE_CHILD, QByteArray(), true);
+    const bool apply_success = ad_security_replace_security_descriptor(ad, test_user_dn, sd);
+    QVERIFY(apply_success);
+
+    QList<QString> found_list;
+    AdAclAudit audit(ad, test_arena_dn(), test_trustee, SEC_ADS_CREATE_CHILD, QByteArray());
+    const bool audit_success = audit.run(
+        [&](const AdAclAuditResult &result) {
+            found_list.append(result.dn);
+
+            return true;
+        });
+
+    QVERIFY(audit_success);
+    QVERIFY(found_list.contains(test_user_dn));
+    QVERIFY(!found_list.contains(test_trustee_dn));
+    QVERIFY(audit.checked_count() >= 2);
+}
+
+// Right delegated on an OU to descendant users should be
+// found on users inside the OU, but not on the OU itself
+// or on descendants of other classes
+void ADMCTestAdSecurity::acl_audit_class_scoped() {
+    const QString ou_dn = test_object_dn("test-delegation-ou", CLASS_OU);
+    const bool create_ou_success = ad.object_add(ou_dn, CLASS_OU);
+    QVERIFY(create_ou_success);
+
+    const QString user_dn = dn_from_name_and_parent("test-delegation-user", ou_dn, CLASS_USER);
+    const bool create_user_success = ad.object_add(user_dn, CLASS_USER);
+    QVERIFY(create_user_success);
+
+    const QString group_dn = dn_from_name_and_parent("test-delegation-group", ou_dn, CLASS_GROUP);
+    const bool create_group_success = ad.object_add(group_dn, CLASS_GROUP);
+    QVERIFY(create_group_success);
+
+    const QByteArray user_guid = ad.adconfig()->class_to_guid(CLASS_USER);
+    QVERIFY(!user_guid.isEmpty());
+
+    const bool apply_success = [&]() {
+        const AdObject ou = ad.search_object(ou_dn);
+        security_descriptor *ou_sd = ou.get_security_descriptor();
+
+        add_allow_ace(ou_sd, SEC_ADS_CREATE_CHILD, SEC_ACE_FLAG_CONTAINER_INHERIT | SEC_ACE_FLAG_INHERIT_ONLY, user_guid);
+        security_descriptor_sort_dacl(ou_sd);
+
+        const bool out = ad_security_replace_security_descriptor(ad, ou_dn, ou_sd);
+
+        security_descriptor_free(ou_sd);
+
+        return out;
+    }();
+    QVERIFY(apply_success);
+
+    QHash<QString, AdAclAuditResult> found_map;
+    AdAclAudit audit(ad, ou_dn, test_trustee, SEC_ADS_CREATE_CHILD, QByteArray());
+    const bool audit_success = audit.run(
+        [&](const AdAclAuditResult &result) {
+            found_map[result.dn] = result;
+
+            return true;
+        });
+
+    QVERIFY(audit_success);
+    QVERIFY(found_map.contains(user_dn));
+    QVERIFY(found_map[user_dn].inherited);
+    QVERIFY(!found_map.contains(ou_dn));
+    QVERIFY(!found_map.contains(group_dn));
+}
+
+void ADMCTestAdSecurity::security_batch() {
+    AdSecurityEdit edit;
+    edit.type = AdSecurityEditType_AddRight;
+    edit.trustee = test_trustee;
+    edit.access_mask = SEC_ADS_CREATE_CHILD;
+    edit.object_type = QByteArray();
+    edit.allow = true;
+
+    const QList<QString> target_list = {test_user_dn, test_trustee_dn};
+
+    QList<QString> success_list;
+    AdSecurityBatch batch(target_list, {edit});
+    const bool batch_success = batch.run(
+        [&](const AdSecurityBatchResult &result) {
+            if (result.success) {
+                success_list.append(result.dn);
+            }
+
+            return true;
+        });
+
+    QVERIFY(batch_success);
+    QCOMPARE(batch.done_count(), target_list.size());
+    QCOMPARE(QSet<QString>(success_list.begin(), success_list.end()), QSet<QString>(target_list.begin(), target_list.end()));
+
+    load_sd();
+    check_state(test_trustee, SEC_ADS_CREATE_CHILD, QByteArray(), TestAdSecurityType_Allow);
+}
+
 void ADMCTestAdSecurity::check_state(const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const TestAdSecurityType type) const {
     const SecurityRightState state = security_descriptor_get_right(sd, trustee, access_mask, object_type);
 
@@ -401,4 +587,23 @@ void ADMCTestAdSecurity::load_sd() {
     }();
 }
 
+void ADMCTestAdSecurity::add_allow_ace(security_descriptor *target_sd, const uint32_t access_mask, const uint8_t flags, const QByteArray &inherited_object_type) const {
+    security_ace ace;
+    memset(&ace, 0, sizeof(security_ace));
+
+    ace.flags = flags;
+    ace.access_mask = access_mask;
+    dom_sid_parse(cstr(object_sid_display_value(test_trustee)), &ace.trustee);
+
+    if (inherited_object_type.isEmpty()) {
+        ace.type = SEC_ACE_TYPE_ACCESS_ALLOWED;
+    } else {
+        ace.type = SEC_ACE_TYPE_ACCESS_ALLOWED_OBJECT;
+        ace.object.object.flags = SEC_ACE_INHERITED_OBJECT_TYPE_PRESENT;
+        memcpy(&ace.object.object.inherited_type.inherited_type, inherited_object_type.data(), sizeof(GUID));
+    }
+
+    security_descriptor_dacl_add(target_sd, &ace);
+}
+
 QTEST_MAIN(ADMCTestAdSecurity)
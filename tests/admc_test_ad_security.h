@@ -56,6 +56,12 @@ private slots:
     void remove_to_unset_superior();
     void add_to_unset_opposite_superior_data();
     void add_to_unset_opposite_superior();
+    void resolve_sid_names();
+    void right_matrix();
+    void right_matrix_effective();
+    void acl_audit();
+    void acl_audit_class_scoped();
+    void security_batch();
 
 private:
     QString test_user_dn;
@@ -66,6 +72,7 @@ private:
 
     void check_state(const QByteArray &trustee, const uint32_t access_mask, const QByteArray &object_type, const TestAdSecurityType type) const;
     void load_sd();
+    void add_allow_ace(security_descriptor *target_sd, const uint32_t access_mask, const uint8_t flags, const QByteArray &inherited_object_type) const;
 };
 
 #endif /* ADMC_TEST_AD_SECURITY_H */